@@ -3,6 +3,7 @@ CONFIG += qt
 CONFIG += warn_on
 CONFIG += release
 CONFIG += nostrip 
+CONFIG += c++11
 
 #  Widgets needed for QT5, 
 QT += widgets
@@ -18,30 +19,34 @@ TARGET = cmst
 target.path = /usr/bin
 INSTALLS += target
 
+# the widget free core: connman state, signal ingestion, counter and proxies
+INCLUDEPATH += ../cmstcore
+INCLUDEPATH += $$OUT_PWD/../cmstcore
+LIBS += -L$$OUT_PWD/../cmstcore -lcmstcore
+PRE_TARGETDEPS += $$OUT_PWD/../cmstcore/libcmstcore.a
+
 # dbus
 DBUS_ADAPTORS 	+= ./code/agent/org.monkey_business_enterprises.agent.xml
 DBUS_INTERFACES	+= ./code/agent/org.monkey_business_enterprises.agent.xml
-DBUS_ADAPTORS 	+= ./code/counter/org.monkey_business_enterprises.counter.xml
-DBUS_INTERFACES	+= ./code/counter/org.monkey_business_enterprises.counter.xml
 
 #	header files
 HEADERS		+= ../resource.h
 HEADERS 	+= ./code/control_box/controlbox.h
 HEADERS		+= ./code/agent/agent.h
 HEADERS		+= ./code/agent/agent_dialog.h
-HEADERS		+= ./code/counter/counter.h
 HEADERS		+= ./code/scrollbox/scrollbox.h
 HEADERS		+= ./code/notify/notify.h
 HEADERS		+= ./code/peditor/peditor.h
 HEADERS   += ./code/provisioning/prov_ed.h
 HEADERS   += ./code/vpn_prov_ed/vpn_ed.h
-HEADERS		+= ./code/trstring/tr_strings.h
 HEADERS		+= ./code/iconman/iconman.h
+HEADERS		+= ./code/iconman/iconindex.h
 HEADERS		+= ./code/vpn_agent/vpnagent.h
 HEADERS		+= ./code/vpn_agent/vpnagent_dialog.h
 HEADERS		+= ./code/vpn_agent/vpnagent_adaptor.h
 HEADERS		+= ./code/vpn_agent/vpnagent_interface.h
 HEADERS		+= ./code/shared/shared.h
+HEADERS		+= ./code/svcmodel/svcmodel.h
 
 #	forms
 FORMS		+= ./code/control_box/ui/controlbox.ui
@@ -57,19 +62,19 @@ SOURCES	+= ./code/main.cpp
 SOURCES	+= ./code/control_box/controlbox.cpp
 SOURCES += ./code/agent/agent.cpp
 SOURCES += ./code/agent/agent_dialog.cpp
-SOURCES += ./code/counter/counter.cpp
 SOURCES += ./code/scrollbox/scrollbox.cpp
 SOURCES += ./code/notify/notify.cpp
 SOURCES	+= ./code/peditor/peditor.cpp
 SOURCES += ./code/provisioning/prov_ed.cpp
 SOURCES += ./code/vpn_prov_ed/vpn_ed.cpp
-SOURCES	+= ./code/trstring/tr_strings.cpp
 SOURCES	+= ./code/iconman/iconman.cpp
+SOURCES	+= ./code/iconman/iconindex.cpp
 SOURCES += ./code/vpn_agent/vpnagent.cpp
 SOURCES += ./code/vpn_agent/vpnagent_dialog.cpp
 SOURCES	+= ./code/vpn_agent/vpnagent_adaptor.cpp
 SOURCES	+= ./code/vpn_agent/vpnagent_interface.cpp
 SOURCES += ./code/shared/shared.cpp
+SOURCES += ./code/svcmodel/svcmodel.cpp
 
 #	resource files
 RESOURCES 	+= ../../cmst.qrc
@@ -37,6 +37,8 @@ DEALINGS IN THE SOFTWARE.
 #	include "./agent.h"
 # include "../resource.h"	
 # include "./code/trstring/tr_strings.h"
+# include "./code/shared/shared.h"
+# include "./code/trace/trace.h"
 
 //	header files generated by qmake from the xml file created by qdbuscpp2xml
 # include "agent_adaptor.h"
@@ -58,7 +60,7 @@ ConnmanAgent::ConnmanAgent(QObject* parent)
 	
 	//	Create Adaptor and register this Agent on the system bus.  
 	new AgentAdaptor(this);
-	QDBusConnection::systemBus().registerObject(AGENT_OBJECT, this);
+	shared::connmanBus().registerObject(AGENT_OBJECT, this);
 	
 }
 
@@ -106,6 +108,7 @@ void ConnmanAgent::RequestBrowser(QDBusObjectPath path, QString url)
 // A dialog is displayed with the required fields enabled (non-required fields are disabled).
 QVariantMap ConnmanAgent::RequestInput(QDBusObjectPath path, QMap<QString,QVariant> dict)
 {
+	CMST_TRACE("ConnmanAgent::RequestInput", "agent");
 	(void) path;
 	
 	// Take the dict returned by DBus and extract the information we are interested in and place in input_map.
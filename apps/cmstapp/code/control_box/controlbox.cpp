@@ -41,6 +41,7 @@ DEALINGS IN THE SOFTWARE.
 
 # include <QTableWidget>
 # include <QTableWidgetItem>
+# include <QTableView>
 # include <QFileInfo>
 # include <QFile>
 # include <QWhatsThis>
@@ -50,16 +51,19 @@ DEALINGS IN THE SOFTWARE.
 # include <QCloseEvent>
 # include <QKeyEvent>
 # include <QToolTip>
+# include <QHelpEvent>
 # include <QTableWidgetSelectionRange>
 # include <QProcess>
 # include <QProcessEnvironment>
 # include <QCryptographicHash>
 # include <QLocale>
+# include <QLocalSocket>
 # include <QColorDialog>
 # include <QPainter>
 # include <QImage>
 # include <QDesktopWidget>
 # include <QInputDialog>
+# include <QDateTime>
 
 # include "../resource.h"
 # include "./controlbox.h"
@@ -69,6 +73,8 @@ DEALINGS IN THE SOFTWARE.
 # include "./code/vpn_prov_ed/vpn_ed.h"
 # include "./code/trstring/tr_strings.h"
 # include "./code/shared/shared.h"
+# include "./code/trace/trace.h"
+# include "./code/stats/busstats.h"
 
 //  headers for system logging
 # include <stdio.h>
@@ -133,17 +139,21 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
   // set the window title
   setWindowTitle(TranslateStrings::cmtr("connman system tray"));
 
+  // let QtDBus know about our types before the first call
+  ObjectStore::registerMetaTypes();
+
   // data members
   q16_errors = CMST::No_Errors;
+  q16_dirty = CMST::Widget_All;
   properties_map.clear();
   services_list.clear();
   technologies_list.clear();
-  wifi_list.clear();
   peer_list.clear();
-  vpn_list.clear();
+  qint64 trace_ts = Trace::now();
   agent = new ConnmanAgent(this);
   vpnagent = new ConnmanVPNAgent(this);
   counter = new ConnmanCounter(this);
+  Trace::complete("register agent objects", "startup", trace_ts);
   trayiconmenu = new QMenu(this);
   tech_submenu = new QMenu(tr("Technologies"), this);
   info_submenu = new QMenu(tr("Service Details"), this);
@@ -158,8 +168,15 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
   socketserver->listen(SOCKET_NAME);
   trayiconbackground = QColor();
   trayicon = new QSystemTrayIcon(this);
+  trayicon_cache.clear();
+  max_cached_icons = 128;
+  trayicon_key.clear();
+  details_path.clear();
+  details_gen = 0;
   
+  trace_ts = Trace::now();
   iconman = new IconManager(this);
+  Trace::complete("IconManager", "startup", trace_ts);
 
   // Read saved settings which will set the ui controls in the preferences tab.
   this->readSettings();
@@ -167,6 +184,17 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
   // Set the iconmanager color
   iconman->setIconColor(QColor(ui.lineEdit_colorize->text()) );
 
+  // Models for the wifi and vpn tables
+  proxies = new ProxyPool(shared::connmanBus(), this);
+  wifi_model = new ServiceModel("wifi", iconman, this);
+  vpn_model = new ServiceModel("vpn", iconman, this);
+  svc_delegate = new ServiceDelegate(this);
+  svc_delegate->setHighlight(QColor(ui.lineEdit_colorize->text()) );
+  ui.tableWidget_wifi->setModel(wifi_model);
+  ui.tableWidget_wifi->setItemDelegate(svc_delegate);
+  ui.tableWidget_vpn->setModel(vpn_model);
+  ui.tableWidget_vpn->setItemDelegate(svc_delegate);
+
   // Constructor scope bool, set to true if we are using start options
   bool b_so = (! parser.isSet("bypass-start-options") && ui.checkBox_usestartoptions->isChecked() );
 
@@ -218,6 +246,7 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
     } // if
     else QIcon::setThemeName(INTERNAL_THEME);
   } // else
+  iconman->loadIndex();
   
   // Set the window icon.  If an icon was installed to /usr/share/icons/hicolor/48x48/apps
   // use that, otherwise use a freedesktop.org named one
@@ -276,6 +305,49 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
   }
   counter_period = setval > minval ? setval : minval; // number of seconds for counter updates
 
+  // limits on the icon caches and on the icon files kept for notifications,
+  // 0 means no limit
+  bool ok;
+  setval = parser.value("max-cached-icons").toUInt(&ok, 10);
+  max_cached_icons = ok ? int(setval) : 128;
+  iconman->setMaxCached(max_cached_icons);
+
+  // set the display update interval.  Signals that arrive within the
+  // interval are combined into a single rebuild of the display widgets.
+  update_timer = new QTimer(this);
+  update_timer->setSingleShot(true);
+  setval = parser.value("update-interval").toUInt(&ok, 10);
+  if (! ok) setval = 50;
+  update_timer->setInterval(setval < 1000 ? setval : 1000);
+  connect(update_timer, SIGNAL(timeout()), this, SLOT(flushDisplayWidgets()));
+
+  // the stores tell us what changed, see propertyChanged() and listChanged()
+  services_list.subscribe(this);
+  technologies_list.subscribe(this);
+
+  // thread to serve the connectivity metrics, started first so the
+  // metrics see the objects from the first rescan
+  metrics = NULL;
+  metrics_thread = NULL;
+  if (! parser.value("metrics-socket").isEmpty() ) {
+    metrics_thread = new QThread(this);
+    metrics = new MetricsServer(parser.value("metrics-socket") );
+    metrics->moveToThread(metrics_thread);
+    connect(metrics_thread, SIGNAL(finished()), metrics, SLOT(deleteLater()));
+    metrics_thread->start();
+    QMetaObject::invokeMethod(metrics, "start", Qt::BlockingQueuedConnection);
+  } // if metrics
+
+  // thread to read the connman objects off the bus
+  services_changed = 0;
+  b_flush_now = false;
+  ingest_thread = new QThread(this);
+  ingest = new Ingest();
+  ingest->moveToThread(ingest_thread);
+  connect(ingest_thread, SIGNAL(finished()), ingest, SLOT(deleteLater()));
+  connect(ingest, SIGNAL(snapshotReady()), this, SLOT(adoptSnapshot()));
+  ingest_thread->start();
+
 	// Hide the minimize button requested 
 	if (parser.isSet("disable-minimize") ? true : (b_so && ui.checkBox_disableminimized->isChecked()) )
 		ui.pushButton_minimize->hide();
@@ -284,48 +356,52 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
   ui.pushButton_provisioning_editor->setVisible(ui.checkBox_advanced->isChecked() );
   ui.pushButton_vpn_editor->setVisible(ui.checkBox_advanced->isChecked() );
   ui.groupBox_process->setVisible(ui.checkBox_advanced->isChecked() );
+  enableStatsTab(ui.checkBox_advanced->isChecked() );
   enableRunOnStartup(ui.checkBox_runonstartup->isChecked() );
 
   // Create the notifyclient, make four tries; first immediately in constructor, then
   // at 1/2 second, 2 seconds and finally at 8 seconds
   notifyclient = new NotifyClient(this);
+  setval = parser.value("max-notify-files").toUInt(&ok, 10);
+  notifyclient->setMaxFiles(ok ? int(setval) : 8);
   this->connectNotifyClient();
   QTimer::singleShot(500, this, SLOT(connectNotifyClient()));
   QTimer::singleShot(2 * 1000, this, SLOT(connectNotifyClient()));
   QTimer::singleShot(8 * 1000, this, SLOT(connectNotifyClient()));
 
   // setup the dbus interface to connman.manager
-  if (! QDBusConnection::systemBus().isConnected() ) logErrors(CMST::Err_No_DBus);
+  if (! shared::connmanBus().isConnected() ) logErrors(CMST::Err_No_DBus);
   else {
-    con_manager = new QDBusInterface(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, QDBusConnection::systemBus(), this);
+    con_manager = new NetConnmanManagerInterface(DBUS_CON_SERVICE, DBUS_PATH, shared::connmanBus(), this);
     if (! con_manager->isValid() ) logErrors(CMST::Err_Invalid_Con_Iface);
     else {
+      // The manager, service, technology and peer signals are read in the
+      // ingest thread on its own bus connection.  Start it (it subscribes to the signals)
+      // before reading the lists so no change can slip in between.
+      bool b_ingest = false;
+      QMetaObject::invokeMethod(ingest, "start", Qt::BlockingQueuedConnection, Q_RETURN_ARG(bool, b_ingest) );
+      if (! b_ingest) logErrors(CMST::Err_No_DBus);
+
       // Access connman.manager to retrieve the data
       this->managerRescan(CMST::Manager_All);
 
       // register the agent
-      shared::processReply(con_manager->call(QDBus::AutoDetect, "RegisterAgent", QVariant::fromValue(QDBusObjectPath(AGENT_OBJECT))) );
+      trace_ts = Trace::now();
+      shared::processReply(con_manager->RegisterAgent(QDBusObjectPath(AGENT_OBJECT)) );
+      Trace::complete("RegisterAgent", "startup", trace_ts);
 
       // if counters are enabled connect signal to slot and register the counter
 			if (parser.isSet("enable-counters") ? true : (b_so && ui.checkBox_enablecounters->isChecked()) ) { 	
-        QList<QVariant> vlist_counter;
-        vlist_counter.clear();
-        vlist_counter << QVariant::fromValue(QDBusObjectPath(CNTR_OBJECT)) << counter_accuracy << counter_period;
-        QDBusMessage reply = con_manager->callWithArgumentList(QDBus::AutoDetect, "RegisterCounter", vlist_counter);
-        if (shared::processReply(reply) == QDBusMessage::ReplyMessage)
+        trace_ts = Trace::now();
+        const QDBusMessage::MessageType mt = shared::processReply(con_manager->RegisterCounter(QDBusObjectPath(CNTR_OBJECT), counter_accuracy, counter_period));
+        Trace::complete("RegisterCounter", "startup", trace_ts);
+        if (mt == QDBusMessage::ReplyMessage)
           connect(counter, SIGNAL(usageUpdated(QDBusObjectPath, QString, QString)), this, SLOT(counterUpdated(QDBusObjectPath, QString, QString)));
       }	// enable counters
       else {
 				ui.tabWidget->setTabEnabled(ui.tabWidget->indexOf(ui.Counters), false);
 			}
 
-      // connect some dbus signals to our slots
-      QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "PropertyChanged", this, SLOT(dbsPropertyChanged(QString, QDBusVariant)));
-      QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "ServicesChanged", this, SLOT(dbsServicesChanged(QList<QVariant>, QList<QDBusObjectPath>, QDBusMessage)));
-      QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "PeersChanged", this, SLOT(dbsPeersChanged(QList<QVariant>, QList<QDBusObjectPath>, QDBusMessage)));
-      QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "TechnologyAdded", this, SLOT(dbsTechnologyAdded(QDBusObjectPath, QVariantMap)));
-      QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "TechnologyRemoved", this, SLOT(dbsTechnologyRemoved(QDBusObjectPath)));
-
       // clear the counters if selected
       this->clearCounters();
 
@@ -336,7 +412,7 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
         ui.pushButton_vpn_editor->setDisabled(true);
       } // if parser set
       else {
-				vpn_manager = new QDBusInterface(DBUS_VPN_SERVICE, DBUS_PATH, DBUS_VPN_MANAGER, QDBusConnection::systemBus(), this);
+				vpn_manager = new NetConnmanVpnManagerInterface(DBUS_VPN_SERVICE, DBUS_PATH, shared::connmanBus(), this);
         if (! vpn_manager->isValid() ) {
 					ui.tabWidget->setTabEnabled(ui.tabWidget->indexOf(ui.VPN), false);
 					ui.pushButton_vpn_editor->setDisabled(true);
@@ -345,7 +421,7 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
         else {
 					ui.tabWidget->setTabEnabled(ui.tabWidget->indexOf(ui.VPN), true);
 					ui.pushButton_vpn_editor->setEnabled(true);
-          shared::processReply(vpn_manager->call(QDBus::AutoDetect, "RegisterAgent", QVariant::fromValue(QDBusObjectPath(VPN_AGENT_OBJECT))) );
+          shared::processReply(vpn_manager->RegisterAgent(QDBusObjectPath(VPN_AGENT_OBJECT)) );
         } // else register agent
       } // else normal vpn manager  
     } // else have valid connection
@@ -369,6 +445,18 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
   connect(info_submenu, SIGNAL(triggered(QAction*)), this, SLOT(infoSubmenuTriggered(QAction*)));
   connect(wifi_submenu, SIGNAL(triggered(QAction*)), this, SLOT(wifiSubmenuTriggered(QAction*)));
   connect(vpn_submenu, SIGNAL(triggered(QAction*)), this, SLOT(vpnSubmenuTriggered(QAction*)));
+  connect(tech_submenu, SIGNAL(aboutToShow()), this, SLOT(assembleTechSubmenu()));
+  connect(info_submenu, SIGNAL(aboutToShow()), this, SLOT(assembleInfoSubmenu()));
+  connect(wifi_submenu, SIGNAL(aboutToShow()), this, SLOT(assembleWifiSubmenu()));
+  connect(vpn_submenu, SIGNAL(aboutToShow()), this, SLOT(assembleVPNSubmenu()));
+  // some system trays only announce the top level menu
+  connect(trayiconmenu, SIGNAL(aboutToShow()), this, SLOT(assembleTechSubmenu()));
+  connect(trayiconmenu, SIGNAL(aboutToShow()), this, SLOT(assembleInfoSubmenu()));
+  connect(trayiconmenu, SIGNAL(aboutToShow()), this, SLOT(assembleWifiSubmenu()));
+  connect(trayiconmenu, SIGNAL(aboutToShow()), this, SLOT(assembleVPNSubmenu()));
+  tech_submenu->installEventFilter(this);
+  wifi_submenu->installEventFilter(this);
+  vpn_submenu->installEventFilter(this);
   connect(exitAction, SIGNAL(triggered()), qApp, SLOT(quit()));
   connect(moveGroup, SIGNAL(triggered(QAction*)), this, SLOT(moveButtonPressed(QAction*)));
   connect(mvsrv_menu, SIGNAL(triggered(QAction*)), this, SLOT(moveService(QAction*)));
@@ -408,6 +496,25 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
   connect(ui.lineEdit_colorize, SIGNAL(textChanged(const QString&)), this, SLOT(iconColorChanged(const QString&)));
   connect(ui.checkBox_enablesystemtraytooltips, SIGNAL(clicked()), this, SLOT(updateDisplayWidgets()));
   connect(ui.pushButton_IDPass, SIGNAL(clicked()), this, SLOT(wifiIDPass()));
+  connect(ui.tabWidget, SIGNAL(currentChanged(int)), this, SLOT(flushDisplayWidgets()));
+  connect(ui.tabWidget, SIGNAL(currentChanged(int)), this, SLOT(assembleTabStats()));
+  connect(ui.checkBox_advanced, SIGNAL(clicked(bool)), this, SLOT(enableStatsTab(bool)));
+
+  // the statistics page is redrawn every second while it is showing
+  stats_timer = new QTimer(this);
+  stats_timer->setInterval(1000);
+  connect(stats_timer, SIGNAL(timeout()), this, SLOT(assembleTabStats()));
+  stats_timer->start();
+
+  // watch for the GUI thread getting stuck, 0 disables the watchdog
+  watchdog = NULL;
+  setval = parser.value("stall-threshold").toUInt(&ok, 10);
+  if (! ok) setval = 1000;
+  if (setval > 0) {
+    watchdog = new Watchdog(int(setval), this);
+    connect(watchdog, SIGNAL(stalled(const QString&, int)), this, SLOT(stallDetected(const QString&, int)));
+    watchdog->start();
+  } // if watchdog
 
   // Install an event filter on all child widgets. Used to control
   // tooltip visibility
@@ -496,48 +603,123 @@ void ControlBox::showChangeLog()
 
 ////////////////////////////////////////////Private Slots ////////////////////////////////////////////
 //
-//  Slot to update all of our display widgets
+//  Slot to update all of our display widgets.  Called when a setting that
+//  affects the display changes, everything gets marked as needing a rebuild.
 void ControlBox::updateDisplayWidgets()
 {
+  details_path.clear();
+  this->refreshDisplayWidgets(CMST::Widget_All, true);
+
+  return;
+}
+
+//
+//  Slot to rebuild the display widgets marked dirty in q16_dirty.  Only
+//  widgets the user can see are rebuilt, the rest keep their dirty flag
+//  and are rebuilt when they are shown (tab change, window shown or
+//  restored).  The tray icon is always rebuilt if it exists.
+void ControlBox::flushDisplayWidgets()
+{
+  CMST_TRACE("flushDisplayWidgets", "display");
+
   // each assemble function will check q16_errors to make sure it can
   // get the information it needs.  Only check for major errors since we
   // can't run the assemble functions if there are.
+  update_timer->stop();
+  if ( ((q16_errors & CMST::Err_No_DBus) | (q16_errors & CMST::Err_Invalid_Con_Iface)) != 0x00 ) return;
+  if (q16_dirty == CMST::Widget_None) return;
 
-  if ( ((q16_errors & CMST::Err_No_DBus) | (q16_errors & CMST::Err_Invalid_Con_Iface)) == 0x00 ) {
-    //  rebuild our pages
+  // The rescan action lives in the tray menu as well as on the wireless
+  // tab so keep it in sync even if the wireless tab is not showing.
+  if (q16_dirty & CMST::Widget_Wireless) {
+    bool b_enable = false;
+    for (int i = 0; i < services_list.count(); ++i) {
+      if (services_list.at(i).rec.type == Conn::TypeWifi) {
+        b_enable = true;
+        break;
+      } // if
+    } // for
+    setStateRescan(b_enable);
+  } // if wireless changed
+
+  //  rebuild our pages
+  if ( (q16_dirty & CMST::Widget_Status) && isShowing(ui.Status) ) {
     this->assembleTabStatus();
+    ui.pushButton_movebefore->setEnabled(false);
+    ui.pushButton_moveafter->setEnabled(false);
+    q16_dirty &= ~CMST::Widget_Status;
+  } // if status
+
+  if ( (q16_dirty & CMST::Widget_Details) && isShowing(ui.Details) ) {
     this->assembleTabDetails();
+    q16_dirty &= ~CMST::Widget_Details;
+  } // if details
+
+  if ( (q16_dirty & CMST::Widget_Wireless) && isShowing(ui.Wireless) ) {
     this->assembleTabWireless();
+    q16_dirty &= ~CMST::Widget_Wireless;
+  } // if wireless
+
+  if ( (q16_dirty & CMST::Widget_VPN) && isShowing(ui.VPN) ) {
     this->assembleTabVPN();
+    q16_dirty &= ~CMST::Widget_VPN;
+  } // if vpn
+
+  if ( (q16_dirty & CMST::Widget_Counters) && isShowing(ui.Counters) ) {
     this->assembleTabCounters();
+    q16_dirty &= ~CMST::Widget_Counters;
+  } // if counters
+
+  if (q16_dirty & CMST::Widget_TrayIcon) {
     if (trayicon != NULL ) this->assembleTrayIcon();
-    
-    ui.pushButton_movebefore->setEnabled(false);
-    ui.pushButton_moveafter->setEnabled(false);
-  } // if there were no major errors
-  
+    q16_dirty &= ~CMST::Widget_TrayIcon;
+  } // if tray icon
+
+  return;
+}
+
+//
+//  Slot called when the reply to a call made with asyncCall() arrives
+//  (or the call times out).  Errors go through shared::processReply()
+//  the same as the old blocking calls did, except for a Connect that was
+//  cancelled or that is still waiting on our agent when it times out, and
+//  a SetProperty that a later call for the same property replaced.
+void ControlBox::asyncCallFinished(QDBusPendingCallWatcher* watcher)
+{
+  const QString path = watcher->property("objpath").toString();
+  const QString method = watcher->property("method").toString();
+  BusStats::call(method, Trace::now() - watcher->property("sent").toLongLong() );
+  pending_calls.removeAll(watcher);
+  watcher->deleteLater();
+
+  if (watcher->isError() ) {
+    bool b_report = true;
+    if (watcher->property("cancelled").toBool() ) b_report = false;
+    if (watcher->property("superseded").toBool() ) b_report = false;
+    if (method == "Connect" && watcher->error().name() == "org.freedesktop.DBus.Error.NoReply") b_report = false;
+    if (method == "Scan") b_report = false;   // scan errors were never reported
+    if (b_report) shared::processReply(watcher->reply() );
+    if (b_report && method == "Connect") Metrics::connectError(watcher->error().name() );
+  } // if error
+
+  if (method == "Scan") refreshDisplayWidgets(CMST::Widget_Wireless);
+  showPending(path);
+
   return;
 }
+
 //
 // Slot to move the selected service before or after another service.
 // Called when an item in mvsrv_menu is selected.  QAction act is the
 // action selected.
 void ControlBox::moveService(QAction* act)
 {
-  // See if act belongs to a service
-  QString ss;
-  QDBusObjectPath targetobj;
-  for (int i = 0; i < services_list.size(); ++i) {
-    ss = getNickName(services_list.at(i).objpath);
-    // the items in mvsrv_menu are in the same order as services_list
-    if (ss == act->text() ) {
-      targetobj = QDBusObjectPath(services_list.at(i).objpath.path());
-      break;
-    } // if
-  } // for
+  // See if act belongs to a service. The items in mvsrv_menu carry the
+  // object path of their service as the action data.
+  QDBusObjectPath targetobj = QDBusObjectPath(act->data().toString() );
 
   // make sure we got a targetobject, if not most likely cancel pressed
-  if (targetobj.path().isEmpty()) return;
+  if (targetobj.path().isEmpty() || ! services_list.contains(targetobj) ) return;
 
   // get enough information from tableWidget_services to identify the source object
   QList<QTableWidgetItem*> list;
@@ -546,18 +728,13 @@ void ControlBox::moveService(QAction* act)
   if (list.isEmpty() ) return;
 
   // apply the movebefore or moveafter message to the source object
-  QDBusInterface* iface_serv = new QDBusInterface(DBUS_CON_SERVICE, services_list.at(list.at(0)->row()).objpath.path(), "net.connman.Service", QDBusConnection::systemBus(), this);
-  if (iface_serv->isValid() ) {
-    if (mvsrv_menu->title() == ui.actionMove_Before->text()) {
-      shared::processReply(iface_serv->call(QDBus::AutoDetect, "MoveBefore", QVariant::fromValue(targetobj)) );
-    }
-    else {
-      shared::processReply(iface_serv->call(QDBus::AutoDetect, "MoveAfter", QVariant::fromValue(targetobj)) );
-    } // else
-  } // iface_srv is valid
+  QList<QVariant> vlist;
+  vlist << QVariant::fromValue(targetobj);
+  if (mvsrv_menu->title() == ui.actionMove_Before->text())
+    asyncCall(proxies->service(services_list.at(list.at(0)->row()).objpath.path()), "MoveBefore", vlist);
+  else
+    asyncCall(proxies->service(services_list.at(list.at(0)->row()).objpath.path()), "MoveAfter", vlist);
 
-  // clean up
-  iface_serv->deleteLater();
   return;
 }
 
@@ -586,11 +763,12 @@ void ControlBox::enableMoveButtons(int row, int col)
   mvsrv_menu->clear();
   for (int i = 0; i < services_list.size(); ++i) {
     QAction* act = mvsrv_menu->addAction(getNickName(services_list.at(i).objpath) );
+    act->setData(services_list.at(i).objpath.path() );
 
     // inspect the service, can only move if service is favorite, ready or online, and not vpn
-    if (services_list.at(i).objmap.value("Favorite").toBool() &&
-       (services_list.at(i).objmap.value("State").toString() == "online" || services_list.at(i).objmap.value("State").toString() == "ready") &&
-       services_list.at(i).objmap.value("Type").toString() != "vpn") {
+    if (services_list.at(i).rec.is(Conn::Favorite) &&
+       services_list.at(i).rec.isConnected() &&
+       services_list.at(i).rec.type != Conn::TypeVpn) {
 
       if (i == row) {
         act->setDisabled(true); // can't move onto itself
@@ -626,13 +804,6 @@ void ControlBox::counterUpdated(const QDBusObjectPath& qdb_objpath, const QStrin
 
   // Set the labels in page 4
   if (! qdb_objpath.path().isEmpty() ) {
-    QMap<QString,QVariant> map;
-    for (int i =0; i < services_list.size(); ++i) {
-      if (services_list.at(i).objpath == qdb_objpath) {
-        map = services_list.at(i).objmap;
-        break;
-      } // if
-    } // for
     ui.label_counter_service_name->setText(tr("<b>Service:</b> %1").arg(getNickName(qdb_objpath)) );
     ui.label_home_counter->setText(home_label);
     ui.label_roam_counter->setText(roam_label);
@@ -654,43 +825,33 @@ void ControlBox::counterUpdated(const QDBusObjectPath& qdb_objpath, const QStrin
 void ControlBox::connectPressed()
 {
   // Process wifi or vpn depending on who sent the signal
-  QTableWidget* qtw = NULL;
-  if (sender() == ui.pushButton_connect) qtw = ui.tableWidget_wifi;
-    else if (sender() == ui.pushButton_vpn_connect) qtw = ui.tableWidget_vpn;
+  QTableView* qtv = NULL;
+  ServiceModel* model = NULL;
+  if (sender() == ui.pushButton_connect) {
+    qtv = ui.tableWidget_wifi;
+    model = wifi_model;
+  }
+    else if (sender() == ui.pushButton_vpn_connect) {
+      qtv = ui.tableWidget_vpn;
+      model = vpn_model;
+    }
       else  return;
 
   // If there is only one row select it
-  if (qtw->rowCount() == 1 ) {
-    QTableWidgetSelectionRange qtwsr = QTableWidgetSelectionRange(0, 0, 0, qtw->columnCount() - 1);
-    qtw->setRangeSelected(qtwsr, true);
-  }
+  if (model->rowCount() == 1 ) qtv->selectRow(0);
 
-  // If no row is selected then return(
-  QList<QTableWidgetItem*> list;
-  list.clear();
-  list = qtw->selectedItems();
-  if (list.isEmpty() ) {
+  // If no row is selected then return
+  int row = selectedRow(qtv);
+  if (row < 0) {
     QMessageBox::information(this, tr("No Services Selected"),
       tr("You need to select a service before pressing the connect button.") );
     return;
   }
 
-  //  send the connect message to the service.  TableWidget only allows single selection so list can only have 0 or 1 elments
-  QDBusInterface* iface_serv = NULL;
-
-  if (qtw == ui.tableWidget_wifi) {
-    iface_serv = new QDBusInterface(DBUS_CON_SERVICE, wifi_list.at(list.at(0)->row()).objpath.path(), "net.connman.Service", QDBusConnection::systemBus(), this);
-    iface_serv->setTimeout(5);
-  }
-  else if (qtw == ui.tableWidget_vpn) {
-    iface_serv = new QDBusInterface(DBUS_CON_SERVICE, vpn_list.at(list.at(0)->row()).objpath.path(), "net.connman.Service", QDBusConnection::systemBus(), this);
-  }
-  else return;  // really not needed
+  //  send the connect message to the service.  The table only allows single selection.
+  //  The call does not block so our agent is free to answer connman.
+  asyncCall(proxies->service(model->at(row).objpath.path()), "Connect");
 
-  iface_serv->setTimeout(5);  // need a short timeout to get the Agent
-  QDBusMessage reply = iface_serv->call(QDBus::AutoDetect, "Connect");
-  if (reply.errorName() != "org.freedesktop.DBus.Error.NoReply") shared::processReply(reply);
-  iface_serv->deleteLater();
   return;
 }
 
@@ -700,29 +861,27 @@ void ControlBox::connectPressed()
 void ControlBox::disconnectPressed()
 {
   // Process wifi or vpn depending on who sent the signal
-  QTableWidget* qtw = NULL;
-  if (sender() == ui.pushButton_disconnect) qtw = ui.tableWidget_wifi;
-    else if (sender() == ui.pushButton_vpn_disconnect) qtw = ui.tableWidget_vpn;
+  QTableView* qtv = NULL;
+  ServiceModel* model = NULL;
+  if (sender() == ui.pushButton_disconnect) {
+    qtv = ui.tableWidget_wifi;
+    model = wifi_model;
+  }
+    else if (sender() == ui.pushButton_vpn_disconnect) {
+      qtv = ui.tableWidget_vpn;
+      model = vpn_model;
+    }
       else  return;
 
   // If there is no item is selected run through the list looking for
-  // services in "online" or "ready" state. If more than one is found
-  // break as we will have to use the one currently selected.
+  // services in "online" or "ready" state, or with a connect in progress.
+  // If more than one is found break as we will have to use the one
+  // currently selected.
   int cntr_connected = 0;
   int row_connected = -1;
-  if (qtw->selectedItems().isEmpty() ) {
-    int itemcount = 0;
-    QMap<QString,QVariant> map;
-    if (qtw == ui.tableWidget_wifi) itemcount = wifi_list.size();
-      else if (qtw == ui.tableWidget_vpn)  itemcount = vpn_list.size();
-        else return;  // line is not really needed
-
-    for (int row = 0; row < itemcount; ++row) {
-      if (qtw == ui.tableWidget_wifi) map = wifi_list.at(row).objmap;
-        else if (qtw == ui.tableWidget_vpn)  map = vpn_list.at(row).objmap;
-          else return; // line is not really needed
-
-      if (map.value("State").toString() == "online" || map.value("State").toString() == "ready" ) {
+  if (selectedRow(qtv) < 0 ) {
+    for (int row = 0; row < model->rowCount(); ++row) {
+      if (model->at(row).rec.isConnected() || pendingCall(model->at(row).objpath.path()) == "Connect" ) {
          ++cntr_connected;
          row_connected = row;
        }
@@ -733,32 +892,21 @@ void ControlBox::disconnectPressed()
     if (cntr_connected == 0) return;
 
     // If only one entry is connected or online, select it
-    if (cntr_connected == 1 ) {
-      QTableWidgetSelectionRange qtwsr = QTableWidgetSelectionRange(row_connected, 0, row_connected, qtw->columnCount() - 1);
-      qtw->setRangeSelected(qtwsr, true);
-    } // cntr_connected == 1
+    if (cntr_connected == 1 ) qtv->selectRow(row_connected);
   } // if there are no currently selected items
 
   // If no row selected return
-  QList<QTableWidgetItem*> list;
-  list.clear();
-  list = qtw->selectedItems();
-  if (list.isEmpty() ) {
+  int row = selectedRow(qtv);
+  if (row < 0) {
     QMessageBox::information(this, tr("No Services Selected"),
       tr("You need to select a service before pressing the disconnect button.") );
     return;
   }
 
-  // Send the disconnect message to the service.  TableWidget only allows single selection so list can only have 0 or 1 elments
-  QDBusInterface* iface_serv = NULL;
-  if (qtw == ui.tableWidget_wifi)
-    iface_serv = new QDBusInterface(DBUS_CON_SERVICE, wifi_list.at(list.at(0)->row()).objpath.path(), "net.connman.Service", QDBusConnection::systemBus(), this);
-  else if (qtw == ui.tableWidget_vpn)
-    iface_serv = new QDBusInterface(DBUS_CON_SERVICE, vpn_list.at(list.at(0)->row()).objpath.path(), "net.connman.Service", QDBusConnection::systemBus(), this);
-  else return;  // this line really not needed
+  // Send the disconnect message to the service.  The table only allows single
+  // selection.  This also cancels a connect still in progress.
+  asyncCall(proxies->service(model->at(row).objpath.path()), "Disconnect");
 
-  shared::processReply(iface_serv->call(QDBus::AutoDetect, "Disconnect") );
-  iface_serv->deleteLater();
   return;
 }
 
@@ -768,40 +916,36 @@ void ControlBox::disconnectPressed()
 void ControlBox::removePressed()
 {
   // if no row selected return
-  QList<QTableWidgetItem*> list;
-  list.clear();
-  list = ui.tableWidget_wifi->selectedItems();
-  if (list.isEmpty() ) {
+  int row = selectedRow(ui.tableWidget_wifi);
+  if (row < 0) {
     QMessageBox::information(this, tr("No Services Selected"),
       tr("You need to select a Wifi service before pressing the remove button.") );
     return;
   }
 
   //  send the Remove message to the service
-  QDBusInterface* iface_serv = new QDBusInterface(DBUS_CON_SERVICE, wifi_list.at(list.at(0)->row()).objpath.path(), "net.connman.Service", QDBusConnection::systemBus(), this);
-  QDBusMessage reply = iface_serv->call(QDBus::AutoDetect, "Remove");
-  shared::processReply(reply);
-  iface_serv->deleteLater();
+  asyncCall(proxies->service(wifi_model->at(row).objpath.path()), "Remove");
 
   return;
 }
 
-//  dbs slots are slots to receive DBus Signals
 //
-//  Slot called whenever DBUS issues a PropertyChanged signal
-void ControlBox::dbsPropertyChanged(QString prop, QDBusVariant dbvalue)
+//  Function called from adoptSnapshot() for each connman.Manager property
+//  that changed.  properties_map already holds the new value.
+void ControlBox::managerPropertyChanged(const QString& prop, const QVariant& oldval, const QVariant& newval)
 {
-  // save current state and update propertiesMap
-  QString oldstate = properties_map.value(prop).toString();
-  properties_map.insert(prop, dbvalue.variant() );
+  QString oldstate = oldval.toString();
 
-  // refresh display widgets
-  updateDisplayWidgets();
+  // refresh display widgets, manager properties only show on the
+  // status tab and the tray icon.  Going online or offline is shown
+  // right away.
+  refreshDisplayWidgets(CMST::Widget_Status | CMST::Widget_TrayIcon);
+  if (prop == "State" || prop == "OfflineMode") b_flush_now = true;
 
   // offlinemode property
   if (prop == "OfflineMode") {
     notifyclient->init();
-    if (dbvalue.variant().toBool()) {
+    if (newval.toBool()) {
       notifyclient->setSummary(tr("Offline Mode Engaged"));
       notifyclient->setIcon(iconman->getIconName("offline_mode_engaged") );
       notifyclient->setBody(tr("All network devices are powered off, now in Airplane mode.") );
@@ -817,7 +961,7 @@ void ControlBox::dbsPropertyChanged(QString prop, QDBusVariant dbvalue)
 	// state property 
   if (prop == "State") {
     // local variables
-    QString state = dbvalue.variant().toString();
+    QString state = newval.toString();
         
     // send notification if state is not ready or online
     notifyclient->init();
@@ -855,275 +999,44 @@ void ControlBox::dbsPropertyChanged(QString prop, QDBusVariant dbvalue)
 }
 
 //
-// Slot called whenever DBUS issues a ServicesChanged signal.  When a
-// Scan method is called on a technology the results of that scan are
-// signaled through this slot.  This is also called when the sort order
-// of the services list changes.  It will not be called when a property
-// of a service object changes.
-void ControlBox::dbsServicesChanged(QList<QVariant> vlist, QList<QDBusObjectPath> removed, QDBusMessage msg)
-{
-  // process removed services
-  if (! removed.isEmpty() ) {
-    for (int i = 0; i < services_list.count(); ++i) {
-      if (removed.contains(services_list.at(i).objpath) ) {
-        QDBusConnection::systemBus().disconnect(DBUS_CON_SERVICE, services_list.at(i).objpath.path(), "net.connman.Service", "PropertyChanged", this, SLOT(dbsServicePropertyChanged(QString, QDBusVariant, QDBusMessage)));
-        services_list.removeAt(i);
-      } // if
-     } // for
-   } // if we needed to remove something
-
-  // process added or changed servcies
-  // Demarshall the raw QDBusMessage instead of vlist as it is easier..
-  if (! vlist.isEmpty() ) {
-    QList<arrayElement> revised_list;
-    if (! getArray(revised_list, msg)) return;
-
-    // merge the existing services_list into the revised_list
-    // first find the original element that matches the revised
-    for (int i = 0; i < revised_list.size(); ++i) {
-      arrayElement revised_element = revised_list.at(i);
-      arrayElement original_element = {QDBusObjectPath(), QMap<QString,QVariant>()};
-      for (int j = 0; j < services_list.size(); ++j) {
-        if (revised_element.objpath == services_list.at(j).objpath) {
-          original_element = services_list.at(j);
-          break;
-        } // if
-      } // j for
-
-      // merge the new elementArray into the existing
-      if (! original_element.objpath.path().isEmpty()) {
-        QMapIterator<QString, QVariant> itr(revised_element.objmap);
-        while (itr.hasNext()) {
-          itr.next();
-          original_element.objmap.insert(itr.key(), itr.value() );
-        } // while
-
-        // now insert the element into the revised list
-        QDBusConnection::systemBus().disconnect(DBUS_CON_SERVICE, original_element.objpath.path(), "net.connman.Service", "PropertyChanged", this, SLOT(dbsServicePropertyChanged(QString, QDBusVariant, QDBusMessage)));
-        revised_list.replace(i, original_element);
-        QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, revised_element.objpath.path(), "net.connman.Service", "PropertyChanged", this, SLOT(dbsServicePropertyChanged(QString, QDBusVariant, QDBusMessage)));
-
-      } // if original element is not empty
-    } // i for
-
-    // now copy the revised list to services_list
-    services_list.clear();
-    services_list = revised_list;
-  } // revised_list not empty
-
-  // clear the counters (if selected) and update the widgets
-  clearCounters();
-  
-  // update the widgets  
-  updateDisplayWidgets();
-
-  return;
-}
-
-//
-// Slot called whenever DBUS issues a Peerschanged signal.  See note above about
-// scan results being signaled here.
-void ControlBox::dbsPeersChanged(QList<QVariant> vlist, QList<QDBusObjectPath> removed, QDBusMessage msg)
-{
-  // Set the update flag
-  bool b_needupdate = false;
-
-  // Process changed peers. Demarshal the raw QDBusMessage instead of vlist as it is easier.
-  if (! vlist.isEmpty() ) {
-    QList<arrayElement> revised_list;
-    if (! getArray(revised_list, msg)) return;
-
-    // if revised_list is not the same size as the existing peer_list
-    // then we definetely need an update
-    if (revised_list.count() != peer_list.count() ) b_needupdate = true;
-
-    // merge the existing peers_list into the revised_list
-    // first find the original element that matches the revised
-    for (int i = 0; i < revised_list.size(); ++i) {
-      arrayElement revised_element = revised_list.at(i);
-      arrayElement original_element = {QDBusObjectPath(), QMap<QString,QVariant>()};
-      for (int j = 0; j < peer_list.size(); ++j) {
-        if (revised_element.objpath == peer_list.at(j).objpath) {
-          original_element = peer_list.at(j);
-          break;
-        } // if
-      } // j for
-
-      // merge the new elementArray into the existing
-      if (! original_element.objpath.path().isEmpty()) {
-        QMapIterator<QString, QVariant> itr(revised_element.objmap);
-        while (itr.hasNext()) {
-          itr.next();
-          b_needupdate = true;
-          original_element.objmap.insert(itr.key(), itr.value() );
-        } // while
-
-        // now insert the element into the revised list
-        revised_list.replace(i, original_element);
-      } // if original element exists
-    } // i for
-
-    // now copy the revised list to peer_list
-    peer_list.clear();
-    peer_list = revised_list;
-  } // vlist not empty
-
-  // process removed peers
-  if (! removed.isEmpty() ) {
-    for (int i = 0; i < peer_list.count(); ++i) {
-      if (removed.contains(peer_list.at(i).objpath) )
-        peer_list.removeAt(i);
+// Slot called when the ingest thread has published a new snapshot of the
+// connman manager and objects.  The stores take on the snapshot,
+// propertyChanged() and listChanged() mark the display widgets that need
+// a rebuild, and managerPropertyChanged() handles the manager properties
+// that changed.  b_rescan is true for the snapshot read at startup, its
+// manager properties are taken as they are with no notifications.
+void ControlBox::adoptSnapshot(bool b_rescan)
+{
+  CMST_TRACE("adoptSnapshot", "signal");
+
+  std::shared_ptr<const StateSnapshot> snap = ingest->take();
+
+  b_flush_now = false;
+  proxies->remove(technologies_list.adopt(snap->technologies) );
+  proxies->remove(services_list.adopt(snap->services) );
+  peer_list.adopt(snap->peers);
+
+  // manager properties, after the stores so anything they trigger sees
+  // the services that go with them
+  if (snap->properties != properties_map) {
+    const QMap<QString,QVariant> old = properties_map;
+    properties_map = snap->properties;
+    if (! b_rescan) {
+      QMap<QString,QVariant>::const_iterator itr;
+      for (itr = properties_map.constBegin(); itr != properties_map.constEnd(); ++itr) {
+        if (old.value(itr.key()) != itr.value() ) this->managerPropertyChanged(itr.key(), old.value(itr.key()), itr.value() );
       } // for
-    } // if we needed to remove something
-
-  // update the widgets
-  if (b_needupdate) updateDisplayWidgets();
-
-  return;
-}
-
-//
-// Slot called whenever DBUS issues a TechonlogyAdded signal
-// There must be an internal counter for technologies, first time a
-// technology is changed we get a signal even if we've already run
-// getTechnologies.  After that first time we never get this signal.
-// Use this this to catch real additions, which we defined as something
-// we don't already have from getTechnologies.
-void ControlBox::dbsTechnologyAdded(QDBusObjectPath path, QVariantMap properties)
-{
-  // iterate over the properties map and replace connman text with translated text
-  QMapIterator<QString, QVariant> itr(properties);
-  while (itr.hasNext()) {
-    itr.next();
-    properties.insert(itr.key(), itr.value() );
-  } // map iterator
-
-  // construct an arrayElement
-  arrayElement ae = {path, properties};
-  bool newelem = true;
-
-  // first see if the element exists, if so replace it
-  for (int i = 0; i < technologies_list.count(); ++i) {
-    if (path == technologies_list.at(i).objpath) {
-      technologies_list.replace(i, ae);
-      newelem = false;
-      break;
-    } // if
-  } // for
-
-  // if it is a new element add it
-  if (newelem) {
-    technologies_list.append(ae);
-  }
-
-  updateDisplayWidgets();
-
-  return;
-}
-
-//
-//  Slot called whenever DBUS issues a TechonlogyAdded signal
-void ControlBox::dbsTechnologyRemoved(QDBusObjectPath removed)
-{
-  for (int i = 0; i < technologies_list.count(); ++i) {
-    if ( removed == technologies_list.at(i).objpath ) {
-      technologies_list.removeAt(i);
-      break;
-    } // if
-  } // for
-
-  updateDisplayWidgets();
-
-  return;
-}
-
-//
-//  Slots called from objects.  The previous slots were called from Manager
-//
-//  Slot called whenever a service object issues a PropertyChanged signal on DBUS
-void ControlBox::dbsServicePropertyChanged(QString property, QDBusVariant dbvalue, QDBusMessage msg)
-{
-  QString s_path = msg.path();
-  QVariant value = dbvalue.variant();
-  QString s_state;
-
-  // replace the old values with the changed ones.
-  for (int i = 0; i < services_list.count(); ++i) {
-    if (s_path == services_list.at(i).objpath.path() ) {
-      QMap<QString,QVariant> map = services_list.at(i).objmap;
-      map.remove(property);
-      map.insert(property, value );
-      arrayElement ae = {services_list.at(i).objpath, map};
-      services_list.replace(i, ae);
-      s_state = map.value("State").toString();
-      break;
-    } // if
-  } // for
-
-  // process errrors  - errors only valid when service is in the failure state
-  if (property =="Error" && s_state == "failure") {
-    notifyclient->init();
-    notifyclient->setSummary(QString(tr("Service Error: %1")).arg(value.toString()) );
-    notifyclient->setBody(QString(tr("Object Path: %1")).arg(s_path) );
-    notifyclient->setIcon(iconman->getIconName("state_error") );
-    notifyclient->setUrgency(Nc::UrgencyCritical);
-    this->sendNotifications();
-  }
-
-  // if state property changed sync the online data members.  
-  if (property == "State") {
-    if (value.toString() == "online") {
-      onlineobjectpath = s_path;    
-    } //
-    else if (s_path == onlineobjectpath) {
-      onlineobjectpath.clear();
-    } // else if object went offline
-    
-    // Send notification if vpn changed
-    for (int i = 0; i < vpn_list.count(); ++i) {
-      if (s_path == vpn_list.at(i).objpath.path() ) {
-        notifyclient->init();
-        if (value.toString() == "ready") {
-          notifyclient->setSummary(QString(tr("VPN Engaged")) );
-          notifyclient->setIcon(iconman->getIconName("connection_vpn") );
-        }
-        else {
-          notifyclient->setSummary(QString(tr("VPN Disengaged")) );
-          notifyclient->setIcon(iconman->getIconName("onnection_not_ready") );
-        }
-        notifyclient->setBody(QString(tr("Object Path: %1")).arg(s_path) );
-        notifyclient->setUrgency(Nc::UrgencyNormal);
-        this->sendNotifications();
-        break;
-      } // if
-    } // for
-  } // if property contains State
-  
-  // update the widgets
-  updateDisplayWidgets();
+    } // if not a rescan
+  } // if properties changed
 
-  return;
-}
-
-//
-//  Slot called whenever a technology object issues a PropertyChanged signal on DBUS
-void ControlBox::dbsTechnologyPropertyChanged(QString name, QDBusVariant dbvalue, QDBusMessage msg)
-{
-  QString s_path = msg.path();
-
-  // replace the old values with the changed ones.
-  for (int i = 0; i < technologies_list.count(); ++i) {
-    if (s_path == technologies_list.at(i).objpath.path() ) {
-      QMap<QString,QVariant> map = technologies_list.at(i).objmap;
-      map.remove(name);
-      map.insert(name, dbvalue.variant() );
-      arrayElement ae = {technologies_list.at(i).objpath, map};
-      technologies_list.replace(i, ae);
-      break;
-    } // if
-  } // for
+  // clear the counters (if selected) if services changed
+  if (snap->services_changed != services_changed) {
+    services_changed = snap->services_changed;
+    clearCounters();
+  } // if
 
-  updateDisplayWidgets();
+  // show a state change right away
+  if (b_flush_now) this->flushDisplayWidgets();
 
   return;
 }
@@ -1140,15 +1053,11 @@ void ControlBox::scanWiFi()
 
   // Run through each technology and do a scan for any wifi
   for (int row = 0; row < technologies_list.size(); ++row) {
-    if (technologies_list.at(row).objmap.value("Type").toString() == "wifi") {
-      if (technologies_list.at(row).objmap.value("Powered").toBool() ) {
+    if (technologies_list.at(row).rec.type == Conn::TypeWifi) {
+      if (technologies_list.at(row).rec.is(Conn::Powered) ) {
 				setStateRescan(false);
         ui.tableWidget_services->setCurrentIndex(QModelIndex()); // first cell becomes selected once pushbutton is disabled
-        qApp->processEvents();  // needed to promply disable the button
-        QDBusInterface* iface_tech = new QDBusInterface(DBUS_CON_SERVICE, technologies_list.at(row).objpath.path(), "net.connman.Technology", QDBusConnection::systemBus(), this);
-        iface_tech->setTimeout( 8 * 1000);  // full 25 second timeout is a bit much when there is a problem
-        QDBusMessage reply = iface_tech->call(QDBus::AutoDetect, "Scan");
-        iface_tech->deleteLater();
+        asyncCall(proxies->technology(technologies_list.at(row).objpath.path()), "Scan");
       } // if the wifi was powered
     } // if the list item is wifi
   } // for
@@ -1166,9 +1075,10 @@ void ControlBox::wifiIDPass(const QString& obj_path)
 
   // Run through each technology looking for Wifi
   for (int row = 0; row < technologies_list.size(); ++row) {
-    if (technologies_list.at(row).objmap.value("Type").toString() == "wifi") {
+    if (technologies_list.at(row).rec.type == Conn::TypeWifi) {
         if (technologies_list.at(row).objpath.path() == obj_path || obj_path.isEmpty() ) {
-          QDBusInterface* iface_tech = new QDBusInterface(DBUS_CON_SERVICE, technologies_list.at(row).objpath.path(), "net.connman.Technology", QDBusConnection::systemBus(), this);
+          const QString path = technologies_list.at(row).objpath.path();
+          QList<QVariant> vlist;
 
           shared::ValidatingDialog* vd01 = new shared::ValidatingDialog(this);
           vd01->setLabel(tr("<b>Technology: %1</b><p>Please enter the WiFi AP SSID that clients will<br>have to join in order to gain internet connectivity.").arg(technologies_list.at(row).objpath.path()) ),
@@ -1176,7 +1086,9 @@ void ControlBox::wifiIDPass(const QString& obj_path)
           vd01->setText(technologies_list.at(row).objmap.value("TetheringIdentifier").toString() );
           if (vd01->exec() == QDialog::Accepted) {
             if (vd01->getText() !=  technologies_list.at(row).objmap.value("TetheringIdentifier").toString()) {
-              shared::processReply(iface_tech->call(QDBus::AutoDetect, "SetProperty", "TetheringIdentifier", QVariant::fromValue(QDBusVariant(vd01->getText()))) );
+              vlist.clear();
+              vlist << QVariant("TetheringIdentifier") << QVariant::fromValue(QDBusVariant(vd01->getText()));
+              asyncCall(proxies->technology(path), "SetProperty", vlist);
             }
           } // if accepted
           vd01->deleteLater();
@@ -1186,14 +1098,15 @@ void ControlBox::wifiIDPass(const QString& obj_path)
             vd02->setLabel(tr("<b>Technology: %1</b><p>Please enter the WPA pre-shared key clients will<br>have to use in order to establish a connection.<p>PSK length: minimum of 8 characters.").arg(technologies_list.at(row).objpath.path()) );
             vd02->setValidator(CMST::ValDialog_min8ch);
             vd02->setText(technologies_list.at(row).objmap.value("TetheringPassphrase").toString() );
-            if (vd02->exec() == QDialog::Accepted)
-              if (vd02->getText() != technologies_list.at(row).objmap.value("TetheringPassphrase").toString() )
-                shared::processReply(iface_tech->call(QDBus::AutoDetect, "SetProperty", "TetheringPassphrase", QVariant::fromValue(QDBusVariant(vd02->getText()))) );
+            if (vd02->exec() == QDialog::Accepted) {
+              if (vd02->getText() != technologies_list.at(row).objmap.value("TetheringPassphrase").toString() ) {
+                vlist.clear();
+                vlist << QVariant("TetheringPassphrase") << QVariant::fromValue(QDBusVariant(vd02->getText()));
+                asyncCall(proxies->technology(path), "SetProperty", vlist);
+              }
+            } // if accepted
             vd02->deleteLater();
           } // if
-
-          // cleanup
-          iface_tech->deleteLater();
         } // if wifi match
       } // if tech is wifi
     } // for
@@ -1208,7 +1121,9 @@ void ControlBox::toggleOfflineMode(bool checked)
 {
   if ( ((q16_errors & CMST::Err_No_DBus) | (q16_errors & CMST::Err_Invalid_Con_Iface)) != 0x00 ) return;
 
-  shared::processReply(con_manager->call(QDBus::AutoDetect, "SetProperty", "OfflineMode", QVariant::fromValue(QDBusVariant(checked ? true : false))) );
+  QList<QVariant> vlist;
+  vlist << QVariant("OfflineMode") << QVariant::fromValue(QDBusVariant(checked ? true : false));
+  asyncCall(con_manager, "SetProperty", vlist);
 	
 	return;
 }
@@ -1237,11 +1152,10 @@ void ControlBox::toggleTrayIcon(bool b_checked)
 //  Called when our custom idButton in the powered cell in the page 1 technology tableWidget is clicked
 void ControlBox::togglePowered(QString object_id, bool checkstate)
 {
-  QDBusInterface* iface_tech = new QDBusInterface(DBUS_CON_SERVICE, object_id, "net.connman.Technology", QDBusConnection::systemBus(), this);
-  shared::processReply(iface_tech->call(QDBus::AutoDetect, "SetProperty", "Powered", QVariant::fromValue(QDBusVariant(checkstate))) );
+  QList<QVariant> vlist;
+  vlist << QVariant("Powered") << QVariant::fromValue(QDBusVariant(checkstate));
+  asyncCall(proxies->technology(object_id), "SetProperty", vlist);
 
-  // cleanup
-  iface_tech->deleteLater();
   return;
 }
 
@@ -1250,27 +1164,25 @@ void ControlBox::togglePowered(QString object_id, bool checkstate)
 //  Called when our custom idButton in the tethered cell in the page 1 technology tableWidget is clicked
 void ControlBox::toggleTethered(QString object_id, bool checkstate)
 {
-  QDBusInterface* iface_tech = new QDBusInterface(DBUS_CON_SERVICE, object_id, "net.connman.Technology", QDBusConnection::systemBus(), this);
-
   // See if this is a wifi technology, get the ID and Pass if necessary
   bool ok = true;
-  for (int row = 0; row < technologies_list.size(); ++row) {
-    if (technologies_list.at(row).objpath.path() == object_id) {
-      if(technologies_list.at(row).objmap.value("Type").toString() == "wifi") {
-        QString sid = technologies_list.at(row).objmap.value("TetheringIdentifier").toString();
-        QString spw = technologies_list.at(row).objmap.value("TetheringPassphrase").toString();
-        if (sid.isEmpty() || spw.isEmpty() ) wifiIDPass(object_id);
-      } // if technology is wifi
-    } // if object_id
-  } // for
-
-  // Send message if everything is ok
+  const arrayElement* tech = technologies_list.find(object_id);
+  if (tech != 0) {
+    if(tech->rec.type == Conn::TypeWifi) {
+      QString sid = tech->objmap.value("TetheringIdentifier").toString();
+      QString spw = tech->objmap.value("TetheringPassphrase").toString();
+      if (sid.isEmpty() || spw.isEmpty() ) wifiIDPass(object_id);
+    } // if technology is wifi
+  } // if object_id
+
+  // Send message if everything is ok.  Calls on the bus are delivered in
+  // order so this arrives after any ID and Pass set in wifiIDPass().
   if (ok) {
-    shared::processReply(iface_tech->call(QDBus::AutoDetect, "SetProperty", "Tethering", QVariant::fromValue(QDBusVariant(checkstate))) );
+    QList<QVariant> vlist;
+    vlist << QVariant("Tethering") << QVariant::fromValue(QDBusVariant(checkstate));
+    asyncCall(proxies->technology(object_id), "SetProperty", vlist);
   }
 
-  // cleanup
-  iface_tech->deleteLater();
   return;
 }
 
@@ -1312,12 +1224,8 @@ void ControlBox::minMaxWindow(QAction* act)
 void ControlBox::techSubmenuTriggered(QAction* act)
 {
   // find the techology associated with the action and toggle its powered state
-  for (int i = 0; i < technologies_list.count(); ++i) {
-    if (technologies_list.at(i).objmap.value("Name").toString() == act->text() ) {
-      togglePowered(technologies_list.at(i).objpath.path(), act->isChecked() );
-      break;
-    } // if
-  } // for
+  if (technologies_list.contains(act->data().toString()) )
+    togglePowered(act->data().toString(), act->isChecked() );
 
   return;
 }
@@ -1329,9 +1237,11 @@ void ControlBox::techSubmenuTriggered(QAction* act)
 // information on the service.
 void ControlBox::infoSubmenuTriggered(QAction* act)
 {
+  // show the dialog first so the details tab is up to date before we
+  // look for the service in the combo box
+  this->showNormal();
   ui.tabWidget->setCurrentIndex(1);
   ui.comboBox_service->setCurrentIndex(ui.comboBox_service->findText(act->text()) );
-  this->showNormal();
 
   return;
 }
@@ -1343,22 +1253,14 @@ void ControlBox::infoSubmenuTriggered(QAction* act)
 void ControlBox::wifiSubmenuTriggered(QAction* act)
 {
   // find the wifi service associated with the action.
-  for (int i = 0; i < wifi_list.count(); ++i) {
-    if (getNickName(wifi_list.at(i).objpath) == act->text() ) {
-      QDBusInterface* iface_serv = new QDBusInterface(DBUS_CON_SERVICE, wifi_list.at(i).objpath.path(), "net.connman.Service", QDBusConnection::systemBus(), this);
-      QString state = wifi_list.at(i).objmap.value("State").toString();
-      if (state == "online" || state == "ready") {
-        shared::processReply(iface_serv->call(QDBus::AutoDetect, "Disconnect") );
-      }
-      else {
-        iface_serv->setTimeout(5);
-        QDBusMessage reply = iface_serv->call(QDBus::AutoDetect, "Connect");
-        if (reply.errorName() != "org.freedesktop.DBus.Error.NoReply") shared::processReply(reply);
-      }
-      iface_serv->deleteLater();
-      break;
-    } // if
-  }   // for
+  // Selecting a service with a connect in progress cancels the connect.
+  const arrayElement* ae = services_list.find(act->data().toString() );
+  if (ae != 0) {
+    if (ae->rec.isConnected() || pendingCall(ae->objpath.path()) == "Connect")
+      asyncCall(proxies->service(ae->objpath.path()), "Disconnect");
+    else
+      asyncCall(proxies->service(ae->objpath.path()), "Connect");
+  } // if
 
   return;
 }
@@ -1370,22 +1272,14 @@ void ControlBox::wifiSubmenuTriggered(QAction* act)
 void ControlBox::vpnSubmenuTriggered(QAction* act)
 {
   // find the VPN service associated with the action
-  for (int i = 0; i < vpn_list.count(); ++i) {
-    if (getNickName(vpn_list.at(i).objpath) == act->text() ) {
-      QDBusInterface* iface_serv = new QDBusInterface(DBUS_CON_SERVICE, vpn_list.at(i).objpath.path(), "net.connman.Service", QDBusConnection::systemBus(), this);
-      iface_serv->setTimeout(5);
-      QString state = vpn_list.at(i).objmap.value("State").toString();
-      QDBusMessage reply;
-      if (state == "ready")
-        reply = iface_serv->call(QDBus::AutoDetect, "Disconnect");
-      else
-        reply = iface_serv->call(QDBus::AutoDetect, "Connect" );
-        
-      if (reply.errorName() != "org.freedesktop.DBus.Error.NoReply") shared::processReply(reply);  
-      iface_serv->deleteLater();
-      break;
-    } // if
-  }   // for
+  // Selecting a service with a connect in progress cancels the connect.
+  const arrayElement* ae = services_list.find(act->data().toString() );
+  if (ae != 0) {
+    if (ae->rec.state == Conn::StateReady || pendingCall(ae->objpath.path()) == "Connect")
+      asyncCall(proxies->service(ae->objpath.path()), "Disconnect");
+    else
+      asyncCall(proxies->service(ae->objpath.path()), "Connect");
+  } // if
   
   return;
 }
@@ -1397,13 +1291,18 @@ void ControlBox::getServiceDetails(int index)
 {
   //  Make sure we were sent a valid index, can happen if the comboBox is
   //  cleared and for whatever reason could not be reseeded with entries.
-  if (index < 0 ) return;
+  if (index < 0 || index >= services_list.size() ) return;
+
+  // Nothing to do if we are already showing this generation of the service
+  if (services_list.at(index).objpath.path() == details_path && services_list.at(index).gen == details_gen) return;
+  details_path = services_list.at(index).objpath.path();
+  details_gen = services_list.at(index).gen;
 
   // variables
   bool b_editable = services_list.size() > 0 ? true : false;
 
   //  Get the QMap associated with the index stored in an arrayElement
-  QMap<QString,QVariant> map = services_list.at(index).objmap;
+  const QMap<QString,QVariant>& map = services_list.at(index).objmap;
 
   //  Some of the QVariants in the map are QMaps themselves, create a data structure for them
   QMap<QString,QVariant> submap;
@@ -1423,14 +1322,14 @@ void ControlBox::getServiceDetails(int index)
   rs.append(tr("Auto Connect: %1<br>").arg(map.value("AutoConnect").toBool() ? tr("On", "autoconnect") : tr("No", "autoconnect")) );
 
   rs.append(tr("<br><b>IPv4</b><br>"));
-  shared::extractMapData(submap, services_list.at(index).objmap.value("IPv4") );
+  submap = services_list.at(index).objmap.value("IPv4").toMap();
   rs.append(tr("IP Address Acquisition: %1<br>").arg(TranslateStrings::cmtr(submap.value("Method").toString(), "connman ipv4 method string")) );
   rs.append(tr("IP Address: %1<br>").arg(submap.value("Address").toString()));
   rs.append(tr("IP Netmask: %1<br>").arg(submap.value("Netmask").toString()));
   rs.append(tr("IP Gateway: %1<br>").arg(submap.value("Gateway").toString()));
 
   rs.append(tr("<br><b>IPv6</b><br>"));
-  shared::extractMapData(submap, services_list.at(index).objmap.value("IPv6") );
+  submap = services_list.at(index).objmap.value("IPv6").toMap();
   rs.append(tr("Address Acquisition: %1<br>").arg(TranslateStrings::cmtr(submap.value("Method").toString(), "connman ipv6 method string")) );
   rs.append(tr("IP Address: %1<br>").arg(submap.value("Address").toString()));
   QString s_ipv6prefix = submap.value("PrefixLength").toString();
@@ -1442,7 +1341,7 @@ void ControlBox::getServiceDetails(int index)
   rs.append(tr("Privacy: %1<br>").arg(TranslateStrings::cmtr(submap.value("Privacy").toString())) );
 
   rs.append(tr("<br><b>Proxy</b><br>"));
-  shared::extractMapData(submap, services_list.at(index).objmap.value("Proxy") );
+  submap = services_list.at(index).objmap.value("Proxy").toMap();
   QString s_proxymethod = TranslateStrings::cmtr(submap.value("Method").toString(), "connman proxy string" );
   rs.append(tr("Address Acquisition: %1<br>").arg(s_proxymethod) );
   if (s_proxymethod == "auto" ) {
@@ -1467,7 +1366,7 @@ void ControlBox::getServiceDetails(int index)
   rs.append(map.value("Domains").toStringList().join("<br>") );
 
   rs.append(tr("<br><br><b>Ethernet</b><br>"));
-  shared::extractMapData(submap, services_list.at(index).objmap.value("Ethernet") );
+  submap = services_list.at(index).objmap.value("Ethernet").toMap();
   rs.append(tr("Connection Method: %1<br>").arg(TranslateStrings::cmtr(submap.value("Method").toString(), "connman ethernet connection method")) );
   rs.append(tr("Interface: %1<br>").arg(submap.value("Interface").toString()) );
   rs.append(tr("Device Address: %1<br>").arg(submap.value("Address").toString()) );
@@ -1483,7 +1382,7 @@ void ControlBox::getServiceDetails(int index)
   rs.append(tr("Roaming: %1<br>").arg(map.value("Roaming").toBool() ? tr("Yes", "roaming") : tr("No", "roaming")) );
 
   rs.append(tr("<br><b>VPN Provider</b><br>"));
-  shared::extractMapData(submap, services_list.at(index).objmap.value("Provider") );
+  submap = services_list.at(index).objmap.value("Provider").toMap();
   rs.append(tr("Host: %1<br>").arg(submap.value("Host").toString()) );
   rs.append(tr("Domain: %1<br>").arg(submap.value("Domain").toString()) );
   rs.append(tr("Name: %1<br>").arg(submap.value("Name").toString()) );
@@ -1539,14 +1438,48 @@ void ControlBox::keyPressEvent(QKeyEvent* e)
         QDialog::keyPressEvent(e);
 }
 
+//
+// Show event for this dialog.  Tabs are not rebuilt while the dialog is
+// hidden so bring the visible tab up to date now.
+void ControlBox::showEvent(QShowEvent* e)
+{
+  QDialog::showEvent(e);
+  this->flushDisplayWidgets();
+
+  return;
+}
+
+//
+// Change event for this dialog.  Same as the show event, but for the
+// dialog being restored after it was minimized.
+void ControlBox::changeEvent(QEvent* e)
+{
+  QDialog::changeEvent(e);
+  if (e->type() == QEvent::WindowStateChange && ! this->isMinimized() )
+    this->flushDisplayWidgets();
+
+  return;
+}
+
 //
 // Event filter used to filter out tooltip events if we don't want to see them
 // in eventFilters return true eats the event, false passes on it.
 bool ControlBox::eventFilter(QObject* obj, QEvent* evn)
 {
-  (void) obj;
-
   if (evn->type() == QEvent::ToolTip) {
+    // tray submenus, tooltips are built when they are asked for
+    if (obj == tech_submenu || obj == wifi_submenu || obj == vpn_submenu) {
+      QMenu* menu = static_cast<QMenu*>(obj);
+      QHelpEvent* he = static_cast<QHelpEvent*>(evn);
+      QAction* act = menu->actionAt(he->pos() );
+      QString ttstr = (act == 0 ? QString() : menuToolTip(menu, act->data().toString()) );
+      if (ttstr.isEmpty() )
+        QToolTip::hideText();
+      else
+        QToolTip::showText(he->globalPos(), ttstr, menu, menu->actionGeometry(act) );
+      return true;
+    } // if a tray submenu
+
     if (ui.checkBox_enableinterfacetooltips->isChecked())
       return false;
     else
@@ -1565,6 +1498,8 @@ bool ControlBox::eventFilter(QObject* obj, QEvent* evn)
 // as an initial scan.
 int ControlBox::managerRescan(const int& srv)
 {
+  CMST_TRACE("managerRescan", "startup");
+
   if ( ((q16_errors & CMST::Err_No_DBus) | (q16_errors & CMST::Err_Invalid_Con_Iface)) == 0x00 ) {
 
     // Reset the getXX errors, always a chance we could read them after
@@ -1574,35 +1509,20 @@ int ControlBox::managerRescan(const int& srv)
     q16_errors &= ~CMST::Err_Services;
 
     // Access connman.manager to retrieve the data
-    if (srv & CMST::Manager_Technologies) {
-      if (! getTechnologies() ) {
-        logErrors(CMST::Err_Technologies);
-      } // if
-      else {
-        // connect technology signals to slots
-        for (int i = 0; i < technologies_list.size(); ++i) {
-          QDBusConnection::systemBus().disconnect(DBUS_CON_SERVICE, technologies_list.at(i).objpath.path(), "net.connman.Technology", "PropertyChanged", this, SLOT(dbsTechnologyPropertyChanged(QString, QDBusVariant, QDBusMessage)));
-          QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, technologies_list.at(i).objpath.path(), "net.connman.Technology", "PropertyChanged", this, SLOT(dbsTechnologyPropertyChanged(QString, QDBusVariant, QDBusMessage)));
-        } // for
-      } //else
-    } // if technolgies
-
-    if (srv & CMST::Manager_Services) {
-      if (! getServices() ) {
-        logErrors(CMST::Err_Services);
-      } // if
-      // connect service signals to slots
-      else {
-        for (int i = 0; i < services_list.size(); ++i) {
-          QDBusConnection::systemBus().disconnect(DBUS_CON_SERVICE, services_list.at(i).objpath.path(), "net.connman.Service", "PropertyChanged", this, SLOT(dbsServicePropertyChanged(QString, QDBusVariant, QDBusMessage)));
-          QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, services_list.at(i).objpath.path(), "net.connman.Service", "PropertyChanged", this, SLOT(dbsServicePropertyChanged(QString, QDBusVariant, QDBusMessage)));
-        } // for
-      } // else
-    } // if services
-
-    if (srv & CMST::Manager_Properties) {
-      if (! getProperties() ) logErrors(CMST::Err_Properties);
-    }
+    // The properties, technologies and services are read by the ingest
+    // thread, wait for it here and take on the snapshot it published.
+    if (srv & CMST::Manager_All) {
+      int errs = 0;
+      QMetaObject::invokeMethod(ingest, "rescan", Qt::BlockingQueuedConnection, Q_RETURN_ARG(int, errs), Q_ARG(int, srv) );
+      const QList<QDBusMessage> replies = ingest->rescanErrors();
+      for (int i = 0; i < replies.size(); ++i) {
+        shared::processReply(replies.at(i) );
+      } // for
+      if (errs & CMST::Err_Properties) logErrors(CMST::Err_Properties);
+      if (errs & CMST::Err_Technologies) logErrors(CMST::Err_Technologies);
+      if (errs & CMST::Err_Services) logErrors(CMST::Err_Services);
+      this->adoptSnapshot(true);
+    } // if anything to read
 
   } // if
 
@@ -1613,6 +1533,8 @@ int ControlBox::managerRescan(const int& srv)
 //  Function to assemble status tab of the dialog
 void ControlBox::assembleTabStatus()
 {
+  CMST_TRACE("assembleTabStatus", "display");
+
   // Global Properties
   if ( (q16_errors & CMST::Err_Properties) == 0x00 ) {
     QString s1 = properties_map.value("State").toString();
@@ -1681,7 +1603,7 @@ void ControlBox::assembleTabStatus()
 
       idButton* qpb02 = new idButton(this, technologies_list.at(row).objpath);
       connect (qpb02, SIGNAL(clickedID(QString, bool)), this, SLOT(togglePowered(QString, bool)));
-      if (technologies_list.at(row).objmap.value("Powered").toBool()) {
+      if (technologies_list.at(row).rec.is(Conn::Powered) ) {
         qpb02->setText(tr("On", "powered") );
         qpb02->setIcon(QPixmap(":/icons/images/interface/golfball_green.png"));
         qpb02->setChecked(true);
@@ -1691,17 +1613,18 @@ void ControlBox::assembleTabStatus()
         qpb02->setIcon(QPixmap(":/icons/images/interface/golfball_red.png"));
         qpb02->setChecked(false);
       }
+      if (pendingCall(technologies_list.at(row).objpath.path()) == "SetProperty") qpb02->setDisabled(true);
       ui.tableWidget_technologies->setCellWidget(row, 2, qpb02);
 
       QTableWidgetItem* qtwi03 = new QTableWidgetItem();
-      bt = technologies_list.at(row).objmap.value("Connected").toBool();
+      bt = technologies_list.at(row).rec.is(Conn::Connected);
       qtwi03->setText( bt ? tr("Yes", "connected") : tr("No", "connected") );
       qtwi03->setTextAlignment(Qt::AlignCenter);
       ui.tableWidget_technologies->setItem(row, 3, qtwi03);
 
       idButton* qpb04 = new idButton(this, technologies_list.at(row).objpath);
       connect (qpb04, SIGNAL(clickedID(QString, bool)), this, SLOT(toggleTethered(QString, bool)));
-      if (technologies_list.at(row).objmap.value("Tethering").toBool()) {
+      if (technologies_list.at(row).rec.is(Conn::Tethering) ) {
         qpb04->setText(tr("On", "tethering") );
         qpb04->setIcon(QPixmap(":/icons/images/interface/golfball_green.png"));
         qpb04->setChecked(true);
@@ -1710,11 +1633,12 @@ void ControlBox::assembleTabStatus()
         qpb04->setText(tr("Off", "tethering") );
         qpb04->setIcon(QPixmap(":/icons/images/interface/golfball_red.png"));
         qpb04->setChecked(false);
-        if (technologies_list.at(row).objmap.value("Type").toString() == "ethernet")
+        if (technologies_list.at(row).rec.type == Conn::TypeEthernet)
           qpb04->setDisabled(true);
         else
-          qpb04->setEnabled(technologies_list.at(row).objmap.value("Powered").toBool() );
+          qpb04->setEnabled(technologies_list.at(row).rec.is(Conn::Powered) );
       }
+      if (pendingCall(technologies_list.at(row).objpath.path()) == "SetProperty") qpb04->setDisabled(true);
       ui.tableWidget_technologies->setCellWidget(row, 4, qpb04);
 
       QTableWidgetItem* qtwi05 = new QTableWidgetItem();
@@ -1737,42 +1661,71 @@ void ControlBox::assembleTabStatus()
 
   // Services
   if ( (q16_errors & CMST::Err_Services) == 0x00 ) {
+    QTableWidget* qtw = ui.tableWidget_services;
     QString ss = QString();
-    ui.tableWidget_services->clearContents();
-    ui.tableWidget_services->setRowCount(services_list.size() );
 
      if (ui.checkBox_hidecnxn->isChecked() ) {
-      ui.tableWidget_services->hideColumn(3);
+      qtw->hideColumn(3);
     }
     else {
-      ui.tableWidget_services->showColumn(3);
-      ui.tableWidget_services->horizontalHeader()->resizeSection(1, ui.tableWidget_services->horizontalHeader()->defaultSectionSize());
+      qtw->showColumn(3);
+      qtw->horizontalHeader()->resizeSection(1, qtw->horizontalHeader()->defaultSectionSize());
     }
-    for (int row = 0; row < services_list.size(); ++row) {
-      QTableWidgetItem* qtwi00 = new QTableWidgetItem();
-      ss = getNickName(services_list.at(row).objpath);
-      qtwi00->setText(TranslateStrings::cmtr(ss) );
-      qtwi00->setTextAlignment(Qt::AlignCenter);
-      ui.tableWidget_services->setItem(row, 0, qtwi00);
-
-      QTableWidgetItem* qtwi01 = new QTableWidgetItem();
-      ss = services_list.at(row).objmap.value("Type").toString();
-      qtwi01->setText(TranslateStrings::cmtr(ss) );
-      qtwi01->setTextAlignment(Qt::AlignCenter);
-      ui.tableWidget_services->setItem(row, 1, qtwi01);
-
-      QTableWidgetItem* qtwi02 = new QTableWidgetItem();
-      ss = services_list.at(row).objmap.value("State").toString();
-      qtwi02->setText(TranslateStrings::cmtr(ss) );
-      qtwi02->setTextAlignment(Qt::AlignCenter);
-      ui.tableWidget_services->setItem(row, 2, qtwi02);
 
-      QTableWidgetItem* qtwi03 = new QTableWidgetItem();
-      QFileInfo fi = services_list.at(row).objpath.path();
-      qtwi03->setText(fi.baseName() );
-      qtwi03->setTextAlignment(Qt::AlignVCenter|Qt::AlignLeft);
-      ui.tableWidget_services->setItem(row, 3, qtwi03);
+    // Put the rows in the order of services_list.  Each row carries the
+    // object path in the data of its first item.
+    QStringList before;
+    for (int row = 0; row < qtw->rowCount(); ++row) {
+      before.append(qtw->item(row, 0) != 0 ? qtw->item(row, 0)->data(Qt::UserRole).toString() : QString() );
+    } // for
+    QStringList after;
+    for (int row = 0; row < services_list.size(); ++row) {
+      after.append(services_list.at(row).objpath.path() );
+    } // for
+    const QList<storeEdit> script = ObjectStore::editScript(before, after);
+    for (int i = 0; i < script.size(); ++i) {
+      const storeEdit& edit = script.at(i);
+      switch (edit.op) {
+        case storeEdit::Remove:
+          qtw->removeRow(edit.from);
+          break;
+        case storeEdit::Insert:
+          qtw->insertRow(edit.to);
+          break;
+        case storeEdit::Move: {
+          QList<QTableWidgetItem*> items;
+          for (int col = 0; col < qtw->columnCount(); ++col) {
+            items.append(qtw->takeItem(edit.from, col) );
+          } // for
+          qtw->removeRow(edit.from);
+          qtw->insertRow(edit.to);
+          for (int col = 0; col < items.size(); ++col) {
+            qtw->setItem(edit.to, col, items.at(col) );
+          } // for
+          } break;
+        default:
+          break;
+      } // switch
+    } // for
 
+    // refresh the text, items are only created for new rows
+    for (int row = 0; row < services_list.size(); ++row) {
+      if (qtw->item(row, 0) == 0) {
+        for (int col = 0; col < qtw->columnCount(); ++col) {
+          QTableWidgetItem* qtwi = new QTableWidgetItem();
+          qtwi->setTextAlignment(col == 3 ? int(Qt::AlignVCenter|Qt::AlignLeft) : int(Qt::AlignCenter) );
+          qtw->setItem(row, col, qtwi);
+        } // for
+        qtw->item(row, 0)->setData(Qt::UserRole, services_list.at(row).objpath.path() );
+        qtw->item(row, 3)->setText(QFileInfo(services_list.at(row).objpath.path()).baseName() );
+      } // if new row
+
+      ss = TranslateStrings::cmtr(getNickName(services_list.at(row).objpath) );
+      if (qtw->item(row, 0)->text() != ss) qtw->item(row, 0)->setText(ss);
+      ss = TranslateStrings::cmtr(services_list.at(row).objmap.value("Type").toString() );
+      if (qtw->item(row, 1)->text() != ss) qtw->item(row, 1)->setText(ss);
+      ss = TranslateStrings::cmtr(Conn::stateName(services_list.at(row).rec.state) );
+      if (qtw->item(row, 2)->text() != ss) qtw->item(row, 2)->setText(ss);
     } // services for loop
 
     // resize the services columns to contents
@@ -1786,25 +1739,48 @@ void ControlBox::assembleTabStatus()
 }
 
 //
-//  Function to assemble details tab of the dialog.  Only fill in the
-//  ui.comboBox_service widget.  The detail portion will be filled in
-//  by the getServiceDetails() slot whenever the comboBox index changes.
+//  Function to assemble details tab of the dialog.  Bring the
+//  ui.comboBox_service widget in line with services_list, keeping the
+//  service that is selected if we still have it.  The detail portion is
+//  filled in by getServiceDetails(), which only redraws if the service
+//  changed since it was last shown.
 void ControlBox::assembleTabDetails()
 {
-  // initilize the page2 display widgets
-  ui.comboBox_service->clear();
-  ui.label_details_left->clear();
-  ui.label_details_right->clear();
+  CMST_TRACE("assembleTabDetails", "display");
 
   //  services details
-  if ( (q16_errors & CMST::Err_Services) == 0x00 ) {
-    // populate the combobox
-    for (int row = 0; row < services_list.size(); ++row) {
-      QString ss = getNickName(services_list.at(row).objpath);
-        ui.comboBox_service->addItem(TranslateStrings::cmtr(ss) );
-    } // services for loop
-     ui.comboBox_service->setCurrentIndex(0);
-  } // services if no error
+  if ( (q16_errors & CMST::Err_Services) != 0x00 ) {
+    ui.comboBox_service->clear();
+    ui.label_details_left->clear();
+    ui.label_details_right->clear();
+    details_path.clear();
+    return;
+  } // if services error
+
+  // update the combobox in place, signals are blocked so getServiceDetails()
+  // is called once at the end rather than for every change
+  const int selected = qMax(0, services_list.indexOf(details_path) );
+  ui.comboBox_service->blockSignals(true);
+  while (ui.comboBox_service->count() > services_list.size() ) {
+    ui.comboBox_service->removeItem(ui.comboBox_service->count() - 1);
+  } // while
+  for (int row = 0; row < services_list.size(); ++row) {
+    QString ss = TranslateStrings::cmtr(getNickName(services_list.at(row).objpath) );
+    if (row >= ui.comboBox_service->count() )
+      ui.comboBox_service->addItem(ss);
+    else if (ui.comboBox_service->itemText(row) != ss)
+      ui.comboBox_service->setItemText(row, ss);
+  } // services for loop
+  ui.comboBox_service->setCurrentIndex(selected);
+  ui.comboBox_service->blockSignals(false);
+
+  if (services_list.isEmpty() ) {
+    ui.label_details_left->clear();
+    ui.label_details_right->clear();
+    details_path.clear();
+  } // if no services
+  else
+    this->getServiceDetails(ui.comboBox_service->currentIndex() );
 
   return;
 }
@@ -1813,10 +1789,7 @@ void ControlBox::assembleTabDetails()
 //  Function to assemble the wireless tab of the dialog.
 void ControlBox::assembleTabWireless()
 {
-  //  initilize the table
-  ui.tableWidget_wifi->clearContents();
-  ui.tableWidget_wifi->setRowCount(0);
-  int rowcount = 0;
+  CMST_TRACE("assembleTabWireless", "display");
 
   // Make sure we got the services_list before we try to work with it.
   if ( (q16_errors & CMST::Err_Services) != 0x00 ) return;
@@ -1826,83 +1799,16 @@ void ControlBox::assembleTabWireless()
     int i_wifidevices= 0;
     int i_wifipowered = 0;
     for (int row = 0; row < technologies_list.size(); ++row) {
-      if (technologies_list.at(row).objmap.value("Type").toString() == "wifi" ) {
+      if (technologies_list.at(row).rec.type == Conn::TypeWifi) {
         ++i_wifidevices;
-        if (technologies_list.at(row).objmap.value("Powered").toBool() ) ++i_wifipowered;
+        if (technologies_list.at(row).rec.is(Conn::Powered) ) ++i_wifipowered;
       } // if census
     } // for loop
     ui.label_wifi_state->setText(tr("  WiFi Technologies:<br>  %1 Found, %2 Powered").arg(i_wifidevices).arg(i_wifipowered) );
   } // technologis if no errors
 
-  // Run through each service_list looking for wifi services
-  wifi_list.clear();
-
-  for (int row = 0; row < services_list.size(); ++row) {
-    QMap<QString,QVariant> map = services_list.at(row).objmap;
-    if (map.value("Type").toString() == "wifi") {
-      wifi_list.append(services_list.at(row));
-      ui.tableWidget_wifi->setRowCount(rowcount + 1);
-
-      QTableWidgetItem* qtwi00 = new QTableWidgetItem();
-      qtwi00->setText(getNickName(services_list.at(row).objpath) );
-      qtwi00->setTextAlignment(Qt::AlignCenter);
-      ui.tableWidget_wifi->setItem(rowcount, 0, qtwi00);
-
-      QLabel* ql01 = new QLabel(ui.tableWidget_wifi);
-      if (map.value("Favorite").toBool() ) {
-        ql01->setPixmap(iconman->getIcon("favorite").pixmap(QSize(16,16)) );
-      }
-      ql01->setAlignment(Qt::AlignCenter);
-      ui.tableWidget_wifi->setCellWidget(rowcount, 1, ql01);
-
-      QLabel* ql02 = new QLabel(ui.tableWidget_wifi);
-      if (map.value("State").toString() == "online") {
-        ql02->setPixmap(iconman->getIcon("state_online").pixmap(QSize(16,16)) );
-      } // if online
-      else {
-        if (map.value("State").toString() == "ready") {
-          ql02->setPixmap(iconman->getIcon("state_ready").pixmap(QSize(16,16)) );
-        } // if ready
-        else {
-          ql02->setPixmap(iconman->getIcon("wifi_tab_state_not_ready").pixmap(QSize(16,16)) );
-        } // else any other state
-      } // else ready or any other state
-      ql02->setAlignment(Qt::AlignCenter);
-      ql02->setToolTip(TranslateStrings::cmtr(map.value("State").toString()) );
-      ql02->installEventFilter(this);
-      ui.tableWidget_wifi->setCellWidget(rowcount, 2, ql02);
-
-      QTableWidgetItem* qtwi03 = new QTableWidgetItem();
-      QStringList sl_tr;
-      for (int i = 0; i < map.value("Security").toStringList().size(); ++i) {
-        sl_tr << TranslateStrings::cmtr(map.value("Security").toStringList().at(i) );
-      } // for
-      qtwi03->setText(sl_tr.join(',') );
-      qtwi03->setTextAlignment(Qt::AlignCenter);
-      ui.tableWidget_wifi->setItem(rowcount, 3, qtwi03);
-
-      QProgressBar* pb04 = new QProgressBar(ui.tableWidget_wifi);
-      pb04->setMinimum(0);
-      pb04->setMaximum(100);
-      pb04->setOrientation( Qt::Horizontal);
-      pb04->setValue(map.value("Strength").value<quint8>() );
-			if (QColor(ui.lineEdit_colorize->text()).isValid() ) {
-				QPalette pl = pb04->palette();
-				pl.setColor(QPalette::Active, QPalette::Highlight, QColor(ui.lineEdit_colorize->text()) );
-				pb04->setPalette(pl);
-			}
-    
-      QWidget* w04 = new QWidget(ui.tableWidget_wifi);
-			QHBoxLayout* l04 = new QHBoxLayout(w04);
-			l04->addWidget(pb04);
-			w04->setLayout(l04);
-			l04->setAlignment(Qt::AlignCenter);
-      l04->setContentsMargins(7, 5, 11, 5);
-      ui.tableWidget_wifi->setCellWidget(rowcount, 4, w04);
-      
-      ++rowcount;
-    } //  if wifi cnxn
-  } // services for loop
+  // Bring the model up to date, only rows that changed are repainted
+  wifi_model->sync(services_list);
 
   // resize the services column 0 to 4 to contents
   ui.tableWidget_wifi->resizeColumnToContents(0);
@@ -1912,11 +1818,10 @@ void ControlBox::assembleTabWireless()
 
   // enable the control buttons if there is at least on line in the table
   bool b_enable = false;
-  if ( wifi_list.count() > 0 ) b_enable = true;
+  if ( wifi_model->rowCount() > 0 ) b_enable = true;
   ui.pushButton_connect->setEnabled(b_enable);
   ui.pushButton_disconnect->setEnabled(b_enable);
   ui.pushButton_remove->setEnabled(b_enable);
-  setStateRescan(b_enable);	
 
   return;
 }
@@ -1925,10 +1830,7 @@ void ControlBox::assembleTabWireless()
 // FUnction to assemble the VPN tab of the dialog
 void ControlBox::assembleTabVPN()
 {
-  //  initilize the table
-  ui.tableWidget_vpn->clearContents();
-  ui.tableWidget_vpn->setRowCount(0);
-  int rowcount = 0;
+  CMST_TRACE("assembleTabVPN", "display");
 
   // Make sure we've been able to communicate with the connman-vpn daemon
   if ( ((q16_errors & CMST::Err_Invalid_VPN_Iface) != 0x00) | (vpn_manager == NULL) ) {
@@ -1939,75 +1841,8 @@ void ControlBox::assembleTabVPN()
   // Make sure we got the services_list before we try to work with it.
   if ( (q16_errors & CMST::Err_Services ) != 0x00 ) return;
 
-// Run through each service_list looking for vpn services
-  vpn_list.clear();
-  for (int row = 0; row < services_list.size(); ++row) {
-    QMap<QString,QVariant> map = services_list.at(row).objmap;
-    if (map.value("Type").toString() == "vpn") {
-      vpn_list.append(services_list.at(row));
-      ui.tableWidget_vpn->setRowCount(rowcount + 1);
-      QMap<QString,QVariant> providermap;
-      shared::extractMapData(providermap, services_list.at(row).objmap.value("Provider") );
-
-      QTableWidgetItem* qtwi00 = new QTableWidgetItem();
-      qtwi00->setText(getNickName(services_list.at(row).objpath) );
-      qtwi00->setTextAlignment(Qt::AlignCenter);
-      ui.tableWidget_vpn->setItem(rowcount, 0, qtwi00);
-
-      QLabel* ql01 = new QLabel(ui.tableWidget_vpn);
-      ql01->setText(TranslateStrings::cmtr(providermap.value("Type").toString()) );
-      ql01->setAlignment(Qt::AlignCenter);
-      ui.tableWidget_vpn->setCellWidget(rowcount, 1, ql01);
-
-      if (map.value("State").toString() == "association") {
-        QProgressBar* pb02 = new QProgressBar(ui.tableWidget_vpn);
-        pb02->setMinimum(0);
-        pb02->setMaximum(0);
-        pb02->setOrientation( Qt::Horizontal);
-        pb02->setFormat("Connecting");
-        // set the stylesheet on pb02
-        QFile f0(":/stylesheets/stylesheets/vpn_connecting.qss");
-        if (f0.open(QIODevice::ReadOnly | QIODevice::Text)) {
-          QString qss = QString(f0.readAll());
-          if (QColor(ui.lineEdit_colorize->text()).isValid() ) {
-            qss = qss.left(qss.lastIndexOf('}') );
-            qss.append(QString("background-color: %1;").arg(ui.lineEdit_colorize->text()) );
-            qss.append('}');
-          }
-          f0.close();
-          pb02->setStyleSheet(qss);
-        }
-
-        ui.tableWidget_vpn->setCellWidget(rowcount, 2, pb02);
-      } // if association
-      else {
-        QLabel* ql02 = new QLabel(ui.tableWidget_vpn);
-        if (map.value("State").toString() == "ready") {
-        ql02->setPixmap(iconman->getIcon("state_vpn_connected").pixmap(QSize(16,16)) );
-        } // if ready
-        else {
-          ql02->setPixmap(iconman->getIcon("state_not_ready").pixmap(QSize(16,16)) );
-        } // else any other state
-        ql02->setAlignment(Qt::AlignCenter);
-        ql02->setToolTip(TranslateStrings::cmtr(map.value("State").toString()) );
-        ql02->installEventFilter(this);
-        ui.tableWidget_vpn->setCellWidget(rowcount, 2, ql02);
-      } // else not association
-
-      QLabel* ql03 = new QLabel(ui.tableWidget_vpn);
-      ql03->setText(providermap.value("Host").toString() );
-      ql03->setAlignment(Qt::AlignCenter);
-      ui.tableWidget_vpn->setCellWidget(rowcount, 3, ql03);
-
-      QLabel* ql04 = new QLabel(ui.tableWidget_vpn);
-      QFileInfo fi = services_list.at(row).objpath.path();
-      ql04->setText(fi.baseName() );
-      ql04->setAlignment(Qt:: AlignCenter);
-      ui.tableWidget_vpn->setCellWidget(rowcount, 4, ql04);
-
-      ++rowcount;
-    } //  if vpn cnxn
-  } // services for loop
+  // Bring the model up to date, only rows that changed are repainted
+  vpn_model->sync(services_list);
 
   // resize the services column 0 to 3 to contents
   ui.tableWidget_vpn->resizeColumnToContents(0);
@@ -2017,7 +1852,7 @@ void ControlBox::assembleTabVPN()
 
   // enable the control buttons if there is at least on line in the table
   bool b_enable = false;
-  if ( vpn_list.count() > 0 ) b_enable = true;
+  if ( vpn_model->rowCount() > 0 ) b_enable = true;
   ui.pushButton_vpn_connect->setEnabled(b_enable);
   ui.pushButton_vpn_disconnect->setEnabled(b_enable);
 
@@ -2028,6 +1863,8 @@ void ControlBox::assembleTabVPN()
 //  Function to assemble the counters tab of the dialog.
 void ControlBox::assembleTabCounters()
 {
+  CMST_TRACE("assembleTabCounters", "display");
+
   // Text for the counter settings label
   ui.label_counter_settings->setText(tr("Update resolution of the counters is based on a threshold of %L1 KB of data and %L2 seconds of time.")   \
       .arg(counter_accuracy)  \
@@ -2038,63 +1875,66 @@ void ControlBox::assembleTabCounters()
 
 //
 //  Function to assemble the tray icon tooltip text and picture.  Called
-//  mainly from updateDisplayWidgets(), also from createSystemTrayIcon()
+//  mainly from flushDisplayWidgets(), also from createSystemTrayIcon()
 void ControlBox::assembleTrayIcon()
 {
+  CMST_TRACE("assembleTrayIcon", "display");
+
   QString stt = QString();
   int readycount = 0;
-  QIcon prelimicon;
+  QString iconname;
 
   if ( (q16_errors & CMST::Err_Properties & CMST::Err_Services) == 0x00 ) {
     // count how many services are in the ready state
     for (int i = 0; i < services_list.count(); ++i) {
-      if (services_list.at(i).objmap.value("State").toString() == "ready")  ++readycount;
+      if (services_list.at(i).rec.state == Conn::StateReady)  ++readycount;
     } // readycount for loop
     if ((properties_map.value("State").toString() == "online") ||
         (properties_map.value("State").toString() == "ready" && readycount == 1) ) {
-      if ( (q16_errors & CMST::Err_Services) == 0x00 ) {
+      if ( (q16_errors & CMST::Err_Services) == 0x00 && ! services_list.isEmpty() ) {
         QMap<QString,QVariant> submap;
-        if (services_list.at(0).objmap.value("Type").toString() == "ethernet") {
-          shared::extractMapData(submap, services_list.at(0).objmap.value("Ethernet") );
+        const objectRecord& rec = services_list.at(0).rec;
+        if (rec.type == Conn::TypeEthernet) {
+          submap = services_list.at(0).objmap.value("Ethernet").toMap();
           stt.prepend(tr("Ethernet Connection<br>","icon_tool_tip"));
           stt.append(tr("Service: %1<br>").arg(getNickName(services_list.at(0).objpath)) );
           stt.append(tr("Interface: %1").arg(TranslateStrings::cmtr(submap.value("Interface").toString())) );
-          prelimicon = iconman->getIcon("connection_wired");
+          iconname = "connection_wired";
         } //  if wired connection
 
-        else if (services_list.at(0).objmap.value("Type").toString() == "wifi") {
+        else if (rec.type == Conn::TypeWifi) {
           stt.prepend(tr("WiFi Connection<br>","icon_tool_tip"));
-          shared::extractMapData(submap, services_list.at(0).objmap.value("Ethernet") );
+          submap = services_list.at(0).objmap.value("Ethernet").toMap();
           stt.append(tr("SSID: %1<br>").arg(getNickName(services_list.at(0).objpath)) );
           QStringList sl_tr;
           for (int i = 0; i < services_list.at(0).objmap.value("Security").toStringList().size(); ++i) {
             sl_tr << TranslateStrings::cmtr(services_list.at(0).objmap.value("Security").toStringList().at(i) );
           } // for
           stt.append(tr("Security: %1<br>").arg(sl_tr.join(',')) );
-          stt.append(tr("Strength: %1%<br>").arg(services_list.at(0).objmap.value("Strength").value<quint8>()) );
+          stt.append(tr("Strength: %1%<br>").arg(rec.strength) );
           stt.append(tr("Interface: %1").arg(TranslateStrings::cmtr(submap.value("Interface").toString())) );
-          quint8 str = services_list.at(0).objmap.value("Strength").value<quint8>();
-          if (str > 80 ) prelimicon = iconman->getIcon("connection_wifi_100");
-          else if (str > 60 ) prelimicon = iconman->getIcon("connection_wifi_075");
-            else if (str > 40 )   prelimicon = iconman->getIcon("connection_wifi_050");
-              else if (str > 20 )   prelimicon = iconman->getIcon("connection_wifi_025");
-                else prelimicon = iconman->getIcon("connection_wifi_000");
+          quint8 str = rec.strength;
+          if (str > 80 ) iconname = "connection_wifi_100";
+          else if (str > 60 ) iconname = "connection_wifi_075";
+            else if (str > 40 )   iconname = "connection_wifi_050";
+              else if (str > 20 )   iconname = "connection_wifi_025";
+                else iconname = "connection_wifi_000";
         } // else if wifi connection
 
-        else if (services_list.at(0).objmap.value("Type").toString() == "vpn") {
-          shared::extractMapData(submap, services_list.at(0).objmap.value("Provider") );
+        else if (rec.type == Conn::TypeVpn) {
+          submap = services_list.at(0).objmap.value("Provider").toMap();
           stt.prepend(tr("VPN Connection<br>","icon_tool_tip"));
           stt.append(tr("Type: %1<br>").arg(TranslateStrings::cmtr(submap.value("Type").toString())) );
           stt.append(tr("Service: %1<br>").arg(services_list.at(0).objmap.value("Name").toString()) );
           stt.append(tr("Host: %1<br>").arg(TranslateStrings::cmtr(submap.value("Host").toString())) );
-          prelimicon = iconman->getIcon("connection_vpn");
+          iconname = "connection_vpn";
         } // else if vpn connection
       } //  services if no error
     } //  if the state is online
 
     // else if state is ready
     else if (properties_map.value("State").toString() == "ready") {
-        prelimicon = iconman->getIcon("connection_ready");
+        iconname = "connection_ready";
       stt.append(tr("Connection is in the Ready State.", "icon_tool_tip"));
     } // else if if ready
 
@@ -2102,167 +1942,211 @@ void ControlBox::assembleTrayIcon()
     else if (properties_map.value("State").toString() == "failure") {
       // try to reconnect if service is wifi and Favorite and if reconnect is specified
       if (ui.checkBox_retryfailed->isChecked() ) {
-        if (services_list.at(0).objmap.value("Type").toString() =="wifi"  && services_list.at(0).objmap.value("Favorite").toBool() ) {
-          QDBusInterface* iface_serv = new QDBusInterface(DBUS_CON_SERVICE, services_list.at(0).objpath.path(), "net.connman.Service", QDBusConnection::systemBus(), this);
-          shared::processReply(iface_serv->call(QDBus::AutoDetect, "Connect") );
-          iface_serv->deleteLater();
+        if (! services_list.isEmpty() && services_list.at(0).rec.type == Conn::TypeWifi && services_list.at(0).rec.is(Conn::Favorite) ) {
+          asyncCall(proxies->service(services_list.at(0).objpath.path()), "Connect");
           stt.append(tr("Connection is in the Failure State, attempting to reestablish the connection", "icon_tool_tip") );
         } // if wifi and favorite
       } // if retry checked
-      prelimicon = iconman->getIcon("state_online");
+      iconname = "state_online";
       stt.append(tr("Connection is in the Failure State.", "icon_tool_tip"));
     } // else if failure state
 
     // else anything else, states in this case should be "idle", "association", "configuration", or "disconnect"
     else {
-			prelimicon = iconman->getIcon("connection_not_ready");
+			iconname = "connection_not_ready";
       stt.append(tr("Not Connected", "icon_tool_tip"));
     } // else any other connection state
   } // properties if no error
 
   // could not get any properties
   else {
-    prelimicon = iconman->getIcon("connection_error");
+    iconname = "connection_error";
     stt.append(tr("Error retrieving properties via Dbus"));
     stt.append(tr("Connection status is unknown"));
   }
 
-  // Set the tray icon.  If the trayiconbackground color is valid and
-  // there is a valid alpha channel convert the alpha to the background
-  // color to get our fake transparency.  Fake transparency can be set as a command
-  // line option so trayiconbackground is set up in the constructor.
-  // Otherwise just convert the image to ARGB32 which seems to be required
-  // for the icons to display in Plasma5.
-  // First convert from a QIcon through QPixmap to QImage
-  QPixmap pxm = prelimicon.pixmap(prelimicon.actualSize(QSize(22,22)) );
-  QImage src = pxm.toImage();
-  QImage dest = QImage(src.width(), src.height(), QImage::Format_ARGB32);
-  QPainter painter(&dest);
-  if (trayiconbackground.isValid() && src.hasAlphaChannel() ) {
-    painter.setCompositionMode(QPainter::CompositionMode_Source);
-    painter.fillRect(dest.rect(), trayiconbackground);
-    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
-  } // if img has alpha channel and background color valid
-  else {
-    painter.setCompositionMode(QPainter::CompositionMode_Source);
-  } // else just make an ARGB32 copy
-  
-  painter.drawImage(0, 0, src);
-  prelimicon = QIcon(QPixmap::fromImage(dest));
-  trayicon->setIcon(prelimicon);
+  // Set the tray icon.  Composited icons are cached and setIcon() is only
+  // called when the icon actually changes, every call makes the system
+  // tray fetch the pixmap again.
+  QString key = QString("%1|%2|%3|%4")
+    .arg(iconname)
+    .arg(22)
+    .arg(qApp->devicePixelRatio() )
+    .arg(trayiconbackground.isValid() ? trayiconbackground.name() : QString() );
+  if (key != trayicon_key) {
+    QHash<QString,QIcon>::iterator itr = trayicon_cache.find(key);
+    if (itr == trayicon_cache.end() ) {
+      if (max_cached_icons > 0 && trayicon_cache.size() >= max_cached_icons) trayicon_cache.clear();
+      itr = trayicon_cache.insert(key, compositeTrayIcon(iconman->getIcon(iconname), QSize(22,22)) );
+    } // if not cached
+    trayicon->setIcon(itr.value() );
+    trayicon_key = key;
+  } // if icon changed
 
   //  Set the tool tip (shown when mouse hovers over the systemtrayicon)
-  if (ui.checkBox_enablesystemtraytooltips->isChecked() )
-    trayicon->setToolTip(stt);
-  else
-    trayicon->setToolTip(QString());
+  if (! ui.checkBox_enablesystemtraytooltips->isChecked() ) stt.clear();
+  if (trayicon->toolTip() != stt) trayicon->setToolTip(stt);
 
-  // Don't continue if we can't get properties
-  if ( (q16_errors & CMST::Err_Properties & CMST::Err_Technologies & CMST::Err_Services) != 0x00 ) return;
+  // The submenus are filled when they are about to be shown, only
+  // keep the enabled state of the vpn submenu up to date here.
+  vpn_submenu->setDisabled( (q16_errors & CMST::Err_Invalid_VPN_Iface) != 0x00 || vpn_manager == NULL);
 
-  // Assemble the submenus for the context menu
-  // tech_submenu.
-  tech_submenu->clear();
+  return;
+}
+
+//
+// Slot to bring the technologies submenu up to date.  Called when the
+// submenu or the tray context menu is about to be shown.
+void ControlBox::assembleTechSubmenu()
+{
+  CMST_TRACE("assembleTechSubmenu", "display");
+
+  if ( (q16_errors & CMST::Err_Technologies) != 0x00 ) return;
+
+  QStringList paths;
   for (int i = 0; i < technologies_list.count(); ++i) {
-    QAction* act = tech_submenu->addAction(technologies_list.at(i).objmap.value("Name").toString() );
+    paths << technologies_list.at(i).objpath.path();
+  } // for
+
+  QList<QAction*> actlist = syncMenuActions(tech_submenu, paths);
+  for (int i = 0; i < actlist.count(); ++i) {
+    QAction* act = actlist.at(i);
+    act->setText(technologies_list.at(i).objmap.value("Name").toString() );
     act->setCheckable(true);
-    act->setChecked(technologies_list.at(i).objmap.value("Powered").toBool() );
-    QString ttstr = QString(tr("<p style='white-space:pre'><center><b>%1 Properties</b></center>").arg(TranslateStrings::cmtr(technologies_list.at(i).objmap.value("Name").toString())) );
-    ttstr.append(tr("Type: %1").arg(technologies_list.at(i).objmap.value("Type").toString()) );
-    ttstr.append(tr("<br>Powered "));
-    technologies_list.at(i).objmap.value("Powered").toBool() ? ttstr.append(tr("On")) : ttstr.append(tr("Off"));
-    ttstr.append("<br>");
-    technologies_list.at(i).objmap.value("Connected").toBool() ? ttstr.append(tr("Connected")) : ttstr.append(tr("Not Connected"));
-    ttstr.append(tr("<br>Tethering "));
-    technologies_list.at(i).objmap.value("Tethering").toBool() ? ttstr.append(tr("Enabled")) : ttstr.append(tr("Disabled"));
-    act->setToolTip(ttstr);
-  } // i for
-
-  // info_submenu
-  info_submenu->clear();
-  for (int j = 0; j < services_list.count(); ++j) {
-    QAction* act = info_submenu->addAction(getNickName(services_list.at(j).objpath) );
-    if (services_list.at(j).objmap.value("Type").toString() == "ethernet" ) {
-      if (services_list.at(j).objmap.value("State").toString() == "online")
-        act->setIcon(iconman->getIcon("connection_wired"));
+    act->setChecked(technologies_list.at(i).rec.is(Conn::Powered) );
+  } // for
+
+  return;
+}
+
+//
+// Slot to bring the service details submenu up to date.  Called when the
+// submenu or the tray context menu is about to be shown.
+void ControlBox::assembleInfoSubmenu()
+{
+  CMST_TRACE("assembleInfoSubmenu", "display");
+
+  if ( (q16_errors & CMST::Err_Services) != 0x00 ) return;
+
+  // count how many services are in the ready state
+  int readycount = 0;
+  QStringList paths;
+  for (int i = 0; i < services_list.count(); ++i) {
+    paths << services_list.at(i).objpath.path();
+    if (services_list.at(i).rec.state == Conn::StateReady)  ++readycount;
+  } // for
+
+  QList<QAction*> actlist = syncMenuActions(info_submenu, paths);
+  for (int j = 0; j < actlist.count(); ++j) {
+    QAction* act = actlist.at(j);
+    act->setText(getNickName(services_list.at(j).objpath) );
+    const quint8 type = services_list.at(j).rec.type;
+    const quint8 state = services_list.at(j).rec.state;
+    if (type == Conn::TypeEthernet) {
+      if (state == Conn::StateOnline)
+        setActionIcon(act, "connection_wired");
       else
-        if(services_list.at(j).objmap.value("State").toString() == "ready")
-          act->setIcon(iconman->getIcon("connection_ready"));
+        if(state == Conn::StateReady)
+          setActionIcon(act, "connection_ready");
         else
-          act->setIcon(iconman->getIcon("connection_not_ready"));
+          setActionIcon(act, "connection_not_ready");
     } // if wired
 
-    else if (services_list.at(j).objmap.value("Type").toString() == "wifi" ) {
-      if (services_list.at(j).objmap.value("State").toString() == "online" ||
+    else if (type == Conn::TypeWifi) {
+      if (state == Conn::StateOnline ||
           (properties_map.value("State").toString() != "online" &&
-          (services_list.at(j).objmap.value("State").toString() == "ready" && readycount == 1)) ) {
-        quint8 str = services_list.at(j).objmap.value("Strength").value<quint8>();
-        if (str > 80 ) act->setIcon(iconman->getIcon("connection_wifi_100") );
-        else if (str > 60 ) act->setIcon(iconman->getIcon("connection_wifi_075") );
-          else if (str > 40 )   act->setIcon(iconman->getIcon("connection_wifi_050") );
-            else if (str > 20 )   act->setIcon(iconman->getIcon("connection_wifi_025") );
-              else act->setIcon(iconman->getIcon("connection_wifi_000") );
+          (state == Conn::StateReady && readycount == 1)) ) {
+        quint8 str = services_list.at(j).rec.strength;
+        if (str > 80 ) setActionIcon(act, "connection_wifi_100");
+        else if (str > 60 ) setActionIcon(act, "connection_wifi_075");
+          else if (str > 40 )   setActionIcon(act, "connection_wifi_050");
+            else if (str > 20 )   setActionIcon(act, "connection_wifi_025");
+              else setActionIcon(act, "connection_wifi_000");
       } // if we want to show a wifi signal symbol
       else
-        if(services_list.at(j).objmap.value("State").toString() == "ready")
-          act->setIcon(iconman->getIcon("connection_ready"));
+        if(state == Conn::StateReady)
+          setActionIcon(act, "connection_ready");
         else
-          act->setIcon(iconman->getIcon("connection_not_ready"));
+          setActionIcon(act, "connection_not_ready");
     } // else if wifi
 
-    else if (services_list.at(j).objmap.value("Type").toString() == "vpn" ) {
-      if (services_list.at(j).objmap.value("State").toString() == "ready")
-        act->setIcon(iconman->getIcon("connection_vpn"));
-      else if (services_list.at(j).objmap.value("State").toString() == "association")
-        act->setIcon(iconman->getIcon("connection_vpn_acquiring"));
+    else if (type == Conn::TypeVpn) {
+      if (state == Conn::StateReady)
+        setActionIcon(act, "connection_vpn");
+      else if (state == Conn::StateAssociation)
+        setActionIcon(act, "connection_vpn_acquiring");
       else
-        act->setIcon(iconman->getIcon("connection_not_ready"));
+        setActionIcon(act, "connection_not_ready");
     } // else if vpn
 
-    else if (services_list.at(j).objmap.value("State").toString() == "ready") act->setIcon(iconman->getIcon("connection_ready"));
-      else if (services_list.at(j).objmap.value("State").toString() == "failure" ) act->setIcon(iconman->getIcon("connection_failure"));
-        else act->setIcon(iconman->getIcon("connection_not_ready"));
+    else if (state == Conn::StateReady) setActionIcon(act, "connection_ready");
+      else if (state == Conn::StateFailure) setActionIcon(act, "connection_failure");
+        else setActionIcon(act, "connection_not_ready");
   } // j for
-  
-  // wifi_submenu.
-  wifi_submenu->clear();
-  for (int k = 0; k < wifi_list.count(); ++k) {
-    QAction* act = wifi_submenu->addAction(getNickName(wifi_list.at(k).objpath) );
+
+  return;
+}
+
+//
+// Slot to bring the wifi submenu up to date.  Called when the submenu or
+// the tray context menu is about to be shown.
+void ControlBox::assembleWifiSubmenu()
+{
+  CMST_TRACE("assembleWifiSubmenu", "display");
+
+  if ( (q16_errors & CMST::Err_Services) != 0x00 ) return;
+
+  QStringList paths;
+  QList<int> rows;
+  for (int k = 0; k < services_list.count(); ++k) {
+    if (services_list.at(k).rec.type != Conn::TypeWifi) continue;
+    paths << services_list.at(k).objpath.path();
+    rows << k;
+  } // for
+
+  QList<QAction*> actlist = syncMenuActions(wifi_submenu, paths);
+  for (int k = 0; k < actlist.count(); ++k) {
+    QAction* act = actlist.at(k);
+    const arrayElement& ae = services_list.at(rows.at(k) );
+    if (pendingCall(ae.objpath.path()) == "Connect")
+      act->setText(tr("%1 (connecting, select to cancel)").arg(getNickName(ae.objpath)) );
+    else
+      act->setText(getNickName(ae.objpath) );
     act->setCheckable(true);
-    QString state = wifi_list.at(k).objmap.value("State").toString();
-    if (state == "online" || state == "ready") act->setChecked(true);
-    QString ttstr = QString(tr("<p style='white-space:pre'><center><b>%1</b></center>").arg(getNickName(wifi_list.at(k).objpath)) );
-    ttstr.append(tr("Connection : %1").arg(TranslateStrings::cmtr(state)) );
-    ttstr.append("<br>");
-    ttstr.append(tr("Signal Strength: %1%").arg(wifi_list.at(k).objmap.value("Strength").toInt()) );
-    ttstr.append("<br>");
-    wifi_list.at(k).objmap.value("Favorite").toBool() ? ttstr.append(tr("Favorite Connection")) : ttstr.append(tr("Never Connected"));
-    ttstr.append("<br>");
-    QStringList sl_tr;
-    for (int m = 0; m < wifi_list.at(k).objmap.value("Security").toStringList().size(); ++m) {
-      sl_tr << TranslateStrings::cmtr(wifi_list.at(k).objmap.value("Security").toStringList().at(m) );
-    } // for    
-    ttstr.append(tr("Security: %1").arg(sl_tr.join(',')) );
-    if (wifi_list.at(k).objmap.value("Roaming").toBool() ) ttstr.append(tr("<br>Roaming"));
-    ttstr.append(tr("<br>Autoconnect is "));
-    wifi_list.at(k).objmap.value("AutoConnect").toBool() ? ttstr.append(tr("Enabled")) : ttstr.append(tr("Disabled"));
-    act->setToolTip(ttstr);
+    act->setChecked(ae.rec.isConnected() );
   } // k for
 
-  // vpn_submenu
-  if ( (q16_errors & CMST::Err_Invalid_VPN_Iface) != 0x00 || vpn_manager == NULL) {
-    vpn_submenu->setDisabled(true);
-    return;
-  }
-  vpn_submenu->clear();
-  for (int l = 0; l < vpn_list.count(); ++l) {
-    QAction* act = vpn_submenu->addAction(getNickName(vpn_list.at(l).objpath) );
+  return;
+}
+
+//
+// Slot to bring the vpn submenu up to date.  Called when the submenu or
+// the tray context menu is about to be shown.
+void ControlBox::assembleVPNSubmenu()
+{
+  CMST_TRACE("assembleVPNSubmenu", "display");
+
+  if ( (q16_errors & CMST::Err_Services) != 0x00 ) return;
+  if ( (q16_errors & CMST::Err_Invalid_VPN_Iface) != 0x00 || vpn_manager == NULL) return;
+
+  QStringList paths;
+  QList<int> rows;
+  for (int l = 0; l < services_list.count(); ++l) {
+    if (services_list.at(l).rec.type != Conn::TypeVpn) continue;
+    paths << services_list.at(l).objpath.path();
+    rows << l;
+  } // for
+
+  QList<QAction*> actlist = syncMenuActions(vpn_submenu, paths);
+  for (int l = 0; l < actlist.count(); ++l) {
+    QAction* act = actlist.at(l);
+    const arrayElement& ae = services_list.at(rows.at(l) );
+    if (pendingCall(ae.objpath.path()) == "Connect")
+      act->setText(tr("%1 (connecting, select to cancel)").arg(getNickName(ae.objpath)) );
+    else
+      act->setText(getNickName(ae.objpath) );
     act->setCheckable(true);
-    QString state = vpn_list.at(l).objmap.value("State").toString();
-    if (state == "ready") act->setChecked(true);
-    QString ttstr = QString(tr("<p style='white-space:pre'><center><b>%1</b></center>").arg(getNickName(vpn_list.at(l).objpath)) );
-    ttstr.append(tr("Connection : %1").arg(TranslateStrings::cmtr(state)) );
-    act->setToolTip(ttstr);
+    act->setChecked(ae.rec.state == Conn::StateReady);
   } //  for
 
   return;
@@ -2448,11 +2332,114 @@ void ControlBox::readSettings()
   return;
 }
 
+//
+// Slot to rebuild the statistics page from the BusStats counters.  Called
+// every second by stats_timer, does nothing unless the page is showing.
+void ControlBox::assembleTabStats()
+{
+  if (! isShowing(ui.Statistics) ) return;
+  CMST_TRACE("assembleTabStats", "display");
+
+  // signals
+  const QList<BusStats::signalRow> srows = BusStats::signalRows();
+  QTableWidget* qtw = ui.tableWidget_signal_stats;
+  qtw->setSortingEnabled(false);
+  qtw->setRowCount(srows.size() );
+  for (int row = 0; row < srows.size(); ++row) {
+    const BusStats::signalRow& sr = srows.at(row);
+    QVariant values[] = {BusStats::signalName(sr.signal), sr.path, sr.count, sr.rate1, sr.rate10, sr.rate60, double(sr.busy_us) / 1000.0};
+    for (int col = 0; col < qtw->columnCount(); ++col) {
+      QTableWidgetItem* qtwi = qtw->item(row, col);
+      if (qtwi == 0) {
+        qtwi = new QTableWidgetItem();
+        if (col > 1) qtwi->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        qtw->setItem(row, col, qtwi);
+      } // if new item
+      qtwi->setData(Qt::DisplayRole, values[col]);
+    } // for columns
+  } // for rows
+  qtw->setSortingEnabled(true);
+  qtw->resizeColumnToContents(0);
+
+  // method calls, times in ms
+  const QList<BusStats::callRow> crows = BusStats::callRows();
+  qtw = ui.tableWidget_call_stats;
+  qtw->setSortingEnabled(false);
+  qtw->setRowCount(crows.size() );
+  for (int row = 0; row < crows.size(); ++row) {
+    const BusStats::callRow& cr = crows.at(row);
+    QVariant values[] = {cr.method, cr.count, double(cr.p50_us) / 1000.0, double(cr.p99_us) / 1000.0, double(cr.max_us) / 1000.0};
+    for (int col = 0; col < qtw->columnCount(); ++col) {
+      QTableWidgetItem* qtwi = qtw->item(row, col);
+      if (qtwi == 0) {
+        qtwi = new QTableWidgetItem();
+        if (col > 0) qtwi->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        qtw->setItem(row, col, qtwi);
+      } // if new item
+      qtwi->setData(Qt::DisplayRole, values[col]);
+    } // for columns
+  } // for rows
+  qtw->setSortingEnabled(true);
+
+  // memory, sizes in KB
+  const QList<MemStats::item> mrows = memoryItems();
+  qtw = ui.tableWidget_memory_stats;
+  qtw->setRowCount(mrows.size() );
+  for (int row = 0; row < mrows.size(); ++row) {
+    const MemStats::item& mi = mrows.at(row);
+    QVariant values[] = {mi.name, mi.count, qRound64(double(mi.bytes) / 1024.0)};
+    for (int col = 0; col < qtw->columnCount(); ++col) {
+      QTableWidgetItem* qtwi = qtw->item(row, col);
+      if (qtwi == 0) {
+        qtwi = new QTableWidgetItem();
+        if (col > 0) qtwi->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        qtw->setItem(row, col, qtwi);
+      } // if new item
+      qtwi->setData(Qt::DisplayRole, values[col]);
+    } // for columns
+  } // for rows
+
+  return;
+}
+
+//
+// Slot to enable the statistics page, it is only available to advanced
+// users.  Called from the constructor and when checkBox_advanced is clicked.
+void ControlBox::enableStatsTab(bool enabled)
+{
+  ui.tabWidget->setTabEnabled(ui.tabWidget->indexOf(ui.Statistics), enabled);
+
+  return;
+}
+
+//
+// Slot called when the watchdog saw the GUI thread stall for ms milliseconds
+// in site.  The stall is already in the system log, add it to the top of
+// the list on the statistics page.
+void ControlBox::stallDetected(const QString& site, int ms)
+{
+  QTableWidget* qtw = ui.tableWidget_stall_stats;
+  qtw->insertRow(0);
+  qtw->setItem(0, 0, new QTableWidgetItem(QDateTime::currentDateTime().toString(Qt::DefaultLocaleShortDate)) );
+  qtw->setItem(0, 1, new QTableWidgetItem(site) );
+  QTableWidgetItem* qtwi = new QTableWidgetItem();
+  qtwi->setData(Qt::DisplayRole, ms);
+  qtwi->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+  qtw->setItem(0, 2, qtwi);
+
+  // keep the most recent 100
+  if (qtw->rowCount() > 100) qtw->setRowCount(100);
+
+  return;
+}
+
 //
 // Slot to create the systemtray icon.  Really part of the constructor
 // and called by a single shot QTimer.
 void ControlBox::createSystemTrayIcon()
 {
+  CMST_TRACE("createSystemTrayIcon", "startup");
+
   // Search for a tray icon, don't read XDG_CURRENT_DESKTOP for the tray type
   bool b_dtaware = qApp->desktopSettingsAware();
   qApp->setDesktopSettingsAware(false);
@@ -2460,8 +2447,8 @@ void ControlBox::createSystemTrayIcon()
   // We still need to make sure there is a tray available
   if (QSystemTrayIcon::isSystemTrayAvailable() ) {
 	
-		// Create the outline of the context menu.  Submenu contents are defined in the
-		// assembletrayIcon() function.
+		// Create the outline of the context menu.  Submenu contents are filled in by
+		// the assembleXXXSubmenu() slots when a submenu is about to be shown.
 		trayiconmenu->clear();
 		trayiconmenu->setTearOffEnabled(true);
 		trayiconmenu->setToolTipsVisible(true);
@@ -2559,7 +2546,7 @@ void ControlBox::createSystemTrayIcon()
 
 //
 // Function to show notifications (if desired by the user). Called from
-// the functions we connect dbus signals to, for instance dbsPropertyChanged(),
+// the functions that handle dbus signals, for instance managerPropertyChanged(),
 // The notifyclient class is used to store data for display from both
 // the systemtrayicon and the notification server.
 void ControlBox::sendNotifications()
@@ -2581,117 +2568,6 @@ void ControlBox::sendNotifications()
   return;
 }
 
-//
-//  Function to query connman.manager.GetProperties
-//  Return a bool, true on success, false otherwise
-bool ControlBox::getProperties()
-{
-  // call connman and GetProperties
-  QDBusMessage reply = con_manager->call("GetProperties");
-  shared::processReply(reply);
-
-  // call the function to get the map values
-  properties_map.clear();
-  return getMap(properties_map, reply);
-}
-
-//
-//  Function to query connman.manager.GetTechnologies
-//  Return a bool, true on success, false otherwise
-bool ControlBox::getTechnologies()
-{
-  // call connman and GetTechnologies
-  QDBusMessage reply = con_manager->call("GetTechnologies");
-  shared::processReply(reply);
-
-  // call the function to get the map values
-  technologies_list.clear();
-  return getArray(technologies_list, reply);
-}
-
-//
-//  Function to query connman.manager.GetServices
-//  Return a bool, true on success, false otherwise
-bool ControlBox::getServices()
-{
-  // call connman and GetServices
-  QDBusMessage reply = con_manager->call("GetServices");
-  shared::processReply(reply);
-
-  // call the function to get the map values
-  services_list.clear();
-  return getArray(services_list, reply);
-}
-
-//
-//  Function to extract arrayElements from a DBus reply message (that contains an array).
-//  This data type is returned by GetServices and GetTechnologies.
-//
-//  Return value a bool, true on success, false otherwise
-//  A QList of arrayElements is sent by reference (called r_list here)
-//  and is modified by this function.  r_msg is a constant reference
-//  to the DBus reply message.
-bool ControlBox::getArray(QList<arrayElement>& r_list, const QDBusMessage& r_msg )
-{
-  // make sure r_msg is a QDBusArgument
-  if ( ! r_msg.arguments().at(0).canConvert<QDBusArgument>() ) return false;
-
-  // make sure the QDBusArgument holds an array
-  const QDBusArgument &qdb_arg = r_msg.arguments().at(0).value<QDBusArgument>();
-  if (qdb_arg.currentType() != QDBusArgument::ArrayType ) return false;
-
-  // iterate over the QDBusArgument pulling array elements out and inserting into
-  // an arrayElement structure.
-  qdb_arg.beginArray();
-  r_list.clear();
-
-  while ( ! qdb_arg.atEnd() ) {
-    // make sure the argument is a structure type
-    if (qdb_arg.currentType() != QDBusArgument::StructureType ) return false;
-
-    arrayElement ael;
-    qdb_arg.beginStructure();
-    qdb_arg >> ael.objpath >> ael.objmap;
-    qdb_arg.endStructure();
-    r_list.append (ael);
-  } // while
-  qdb_arg.endArray();
-
-  return true;
-}
-
-//  Function to extract a QMap from a DBus reply message (that contains a map).
-//  This data type is returned by GetProperties
-//
-//  Return value a bool, true on success, false otherwise.
-//  The map is sent by reference (called r_map here) and is modified by this function.
-//  r_msg is a constant reference to the DBus reply message.
-bool ControlBox::getMap(QMap<QString,QVariant>& r_map, const QDBusMessage& r_msg )
-{
-  // make sure r_msg is a QDBusArgument
-  if ( ! r_msg.arguments().at(0).canConvert<QDBusArgument>() ) return false;
-
-  // make sure the QDBusArgument holds a map
-  const QDBusArgument &qdb_arg = r_msg.arguments().at(0).value<QDBusArgument>();
-  if (qdb_arg.currentType() != QDBusArgument::MapType ) return false;
-
-  // iterate over the QDBusArgument pulling map keys and values out
-  qdb_arg.beginMap();
-  r_map.clear();
-
-  while ( ! qdb_arg.atEnd() ) {
-    QString key;
-    QVariant value;
-    qdb_arg.beginMapEntry();
-    qdb_arg >> key >> value;
-    qdb_arg.endMapEntry();
-    r_map.insert(key, value);
-  }
-  qdb_arg.endMap();
-
-  return true;
-}
-
 //
 // Function to log errors to the system log.  Functionallity provided
 // by syslog.h and friends.
@@ -2771,13 +2647,11 @@ QString ControlBox::readResourceText(const char* textfile)
 
 //
 // Function to clear the counters if selected in the ui.  Called from the constructor
-// and from dbsServicesChanged
+// and from adoptSnapshot when the list of services changed
 void ControlBox::clearCounters()
 {
   if (ui.checkBox_resetcounters->isChecked() && ! onlineobjectpath.isEmpty() ) {
-    QDBusInterface* iface_serv = new QDBusInterface(DBUS_CON_SERVICE, onlineobjectpath, "net.connman.Service", QDBusConnection::systemBus(), this);
-    shared::processReply(iface_serv->call(QDBus::AutoDetect, "ResetCounters") );
-    iface_serv->deleteLater();
+    shared::processReply(proxies->service(onlineobjectpath)->ResetCounters() );
   }
 
   return;
@@ -2790,27 +2664,441 @@ void ControlBox::clearCounters()
 // nickname and return it.
 QString ControlBox::getNickName(const QDBusObjectPath& objpath)
 {
-  for (int i = 0; i < services_list.size(); ++i) {
-    if (services_list.at(i).objpath == objpath) {
-      QMap<QString,QVariant> submap;
-      if (services_list.at(i).objmap.value("Type").toString() == "ethernet") {
-        shared::extractMapData(submap, services_list.at(i).objmap.value("Ethernet") );
-        if (submap.value("Interface").toString().isEmpty() )
-          return services_list.at(i).objmap.value("Name").toString();
-        else
-          return QString(TranslateStrings::cmtr(services_list.at(i).objmap.value("Name").toString()) + " [%1]").arg(submap.value("Interface").toString() );
-      } // if type ethernet
+  const arrayElement* ae = services_list.find(objpath);
 
-      else if ( services_list.at(i).objmap.value("Type").toString() == "wifi" && services_list.at(i).objmap.value("Name").toString().isEmpty() )
-        return tr("[Hidden Wifi]");
-      else
-        return  services_list.at(i).objmap.value("Name").toString();
-    } // if objpath matches
+  return ae == 0 ? QString() : shared::nickName(*ae);
+}
+
+//
+// Function to collect the memory report.  The connman objects are counted
+// once, the snapshots and models share their data with our stores.
+QList<MemStats::item> ControlBox::memoryItems()
+{
+  QList<MemStats::item> items;
+  qint64 submaps = 0;
+  qint64 sub = 0;
+
+  MemStats::item mi;
+  mi.name = tr("Services");
+  mi.count = services_list.size();
+  mi.bytes = services_list.memoryUsage(sub);
+  submaps += sub;
+  items << mi;
+
+  mi.name = tr("Technologies");
+  mi.count = technologies_list.size();
+  mi.bytes = technologies_list.memoryUsage(sub);
+  submaps += sub;
+  items << mi;
+
+  mi.name = tr("Peers");
+  mi.count = peer_list.size();
+  mi.bytes = peer_list.memoryUsage(sub);
+  submaps += sub;
+  items << mi;
+
+  mi.name = tr("Nested properties");
+  mi.count = services_list.size() + technologies_list.size() + peer_list.size();
+  mi.bytes = submaps;
+  items << mi;
+
+  mi.name = tr("Counters");
+  mi.count = counter->entries();
+  mi.bytes = counter->memoryUsage();
+  items << mi;
+
+  mi.name = tr("Icon cache");
+  mi.count = iconman->cacheSize();
+  mi.bytes = iconman->cacheBytes();
+  items << mi;
+
+  mi.name = tr("Icon theme index");
+  mi.count = iconman->indexSize();
+  mi.bytes = iconman->indexBytes();
+  items << mi;
+
+  mi.name = tr("Table icons");
+  mi.count = wifi_model->pixmapCount() + vpn_model->pixmapCount();
+  mi.bytes = wifi_model->pixmapBytes() + vpn_model->pixmapBytes();
+  items << mi;
+
+  mi.name = tr("Tray icons");
+  mi.count = trayicon_cache.size();
+  mi.bytes = 0;
+  for (QHash<QString,QIcon>::const_iterator itr = trayicon_cache.constBegin(); itr != trayicon_cache.constEnd(); ++itr) {
+    const QList<QSize> sizes = itr.value().availableSizes();
+    for (int i = 0; i < sizes.size(); ++i) {
+      mi.bytes += qint64(sizes.at(i).width()) * sizes.at(i).height() * 4;
+    } // for
+  } // for
+  items << mi;
+
+  mi.name = tr("Notification icon files");
+  mi.count = notifyclient != 0 ? notifyclient->tempFileCount() : 0;
+  mi.bytes = notifyclient != 0 ? notifyclient->tempFileBytes() : 0;
+  items << mi;
+
+  return items;
+}
+
+//
+// Function called by services_list and technologies_list when a property
+// of one of their objects changes.  Mark only the display widgets that
+// show the property as needing a rebuild.
+void ControlBox::propertyChanged(const ObjectStore* store, const QString& path, const QString& property, const QVariant& oldval, const QVariant& newval)
+{
+  Q_UNUSED(oldval);
+
+  const arrayElement* ae = store->find(path);
+  if (ae == 0) return;
+  quint16 widgets = CMST::Widget_None;
+
+  if (store == &technologies_list) {
+    if (property == "Name" || property == "Type" || property == "Powered" || property == "Connected" || property == "Tethering")
+      widgets |= CMST::Widget_Status;
+    if (ae->rec.type == Conn::TypeWifi) widgets |= CMST::Widget_Wireless;
+  } // if technology
+
+  else if (store == &services_list) {
+    const bool b_name = (property == "Name" || property == "Ethernet" || property == "Type");
+    if (b_name || property == "State") widgets |= CMST::Widget_Status;
+    if (b_name || path == details_path) widgets |= CMST::Widget_Details;
+    if (ae->rec.type == Conn::TypeWifi) widgets |= CMST::Widget_Wireless;
+    if (ae->rec.type == Conn::TypeVpn) widgets |= CMST::Widget_VPN;
+    // the tray icon and tooltip show the first service and count the ready ones
+    if (store->indexOf(path) == 0 || property == "State") widgets |= CMST::Widget_TrayIcon;
+
+    // process errrors  - errors only valid when service is in the failure state
+    if (property == "Error" && ae->rec.state == Conn::StateFailure) {
+      notifyclient->init();
+      notifyclient->setSummary(QString(tr("Service Error: %1")).arg(newval.toString()) );
+      notifyclient->setBody(QString(tr("Object Path: %1")).arg(path) );
+      notifyclient->setIcon(iconman->getIconName("state_error") );
+      notifyclient->setUrgency(Nc::UrgencyCritical);
+      this->sendNotifications();
+    }
+
+    // if state property changed sync the online data members.
+    if (property == "State") {
+      if (ae->rec.state == Conn::StateOnline) {
+        onlineobjectpath = path;
+      } //
+      else if (path == onlineobjectpath) {
+        onlineobjectpath.clear();
+      } // else if object went offline
+
+      // Send notification if vpn changed
+      if (ae->rec.type == Conn::TypeVpn) {
+        notifyclient->init();
+        if (ae->rec.state == Conn::StateReady) {
+          notifyclient->setSummary(QString(tr("VPN Engaged")) );
+          notifyclient->setIcon(iconman->getIconName("connection_vpn") );
+        }
+        else {
+          notifyclient->setSummary(QString(tr("VPN Disengaged")) );
+          notifyclient->setIcon(iconman->getIconName("onnection_not_ready") );
+        }
+        notifyclient->setBody(QString(tr("Object Path: %1")).arg(path) );
+        notifyclient->setUrgency(Nc::UrgencyNormal);
+        this->sendNotifications();
+      } // if
+
+      // adoptSnapshot() shows a state change right away
+      b_flush_now = true;
+    } // if property contains State
+  } // else if service
+
+  if (widgets != CMST::Widget_None) refreshDisplayWidgets(widgets);
+
+  return;
+}
+
+//
+// Function called by services_list and technologies_list when objects are
+// added, removed or reordered.
+void ControlBox::listChanged(const ObjectStore* store)
+{
+  if (store == &technologies_list)
+    refreshDisplayWidgets(CMST::Widget_Status | CMST::Widget_Wireless);
+  else if (store == &services_list)
+    refreshDisplayWidgets(CMST::Widget_Status | CMST::Widget_Details | CMST::Widget_Wireless | CMST::Widget_VPN | CMST::Widget_TrayIcon);
+
+  return;
+}
+
+//
+// Function to mark display widgets as needing a rebuild.  widgets is an
+// OR of CMST::Widget_ flags.  The rebuild is scheduled on update_timer
+// so a burst of signals results in a single rebuild, unless b_now is
+// true in which case the dirty widgets are rebuilt immediately.
+void ControlBox::refreshDisplayWidgets(const quint16& widgets, bool b_now)
+{
+  q16_dirty |= widgets;
+
+  if (b_now)
+    this->flushDisplayWidgets();
+  else if (! update_timer->isActive() )
+    update_timer->start();
+
+  return;
+}
+
+//
+// Function to return true if the tab page is currently visible to the user
+bool ControlBox::isShowing(QWidget* page)
+{
+  if (! this->isVisible() || this->isMinimized() ) return false;
+
+  return (ui.tabWidget->currentWidget() == page);
+}
+
+//
+// Function to send a method call to connman without waiting for the reply.
+// proxy is the generated proxy for the object (from ProxyPool, or one of
+// the managers), method the method name and args the method arguments.
+// The reply is handled in asyncCallFinished().
+//
+// Only one call of each kind is allowed in flight for an object, a second
+// request is dropped.  The exception is SetProperty, a second call for the
+// same property is sent and the first one is marked superseded.  Calls are
+// delivered in order so connman ends up with the latest value, for
+// instance when Powered is toggled twice from the tray menu.  A Disconnect
+// sent while a Connect is in flight cancels the Connect, connman will
+// abort the connection attempt.
+//
+// Return true if the call was sent.
+bool ControlBox::asyncCall(QDBusAbstractInterface* proxy, const QString& method, const QList<QVariant>& args)
+{
+  CMST_TRACE("asyncCall", "dbus");
+
+  if ( ((q16_errors & CMST::Err_No_DBus) | (q16_errors & CMST::Err_Invalid_Con_Iface)) != 0x00 ) return false;
+
+  // SetProperty calls are told apart by the property they set
+  const QString path = proxy->path();
+  const QString prop = (method == "SetProperty" && ! args.isEmpty()) ? args.at(0).toString() : QString();
+
+  for (int i = 0; i < pending_calls.size(); ++i) {
+    QDBusPendingCallWatcher* w = pending_calls.at(i);
+    if (w->property("objpath").toString() != path) continue;
+    if (w->property("method").toString() == "Connect" && method == "Disconnect") {
+      w->setProperty("cancelled", true);
+      continue;
+    } // if cancelling a connect
+    if (w->property("method").toString() == method && w->property("prop").toString() == prop) {
+      if (method != "SetProperty") return false;
+      w->setProperty("superseded", true);
+    } // if same call
+  } // for
+
+  QDBusPendingCallWatcher* watcher = new QDBusPendingCallWatcher(proxy->asyncCallWithArgumentList(method, args), this);
+  watcher->setProperty("objpath", path);
+  watcher->setProperty("method", method);
+  watcher->setProperty("prop", prop);
+  watcher->setProperty("sent", Trace::now() );
+  connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)), this, SLOT(asyncCallFinished(QDBusPendingCallWatcher*)));
+  pending_calls.append(watcher);
+
+  showPending(path);
+
+  return true;
+}
+
+//
+// Function to return the method of the most recent call in flight for
+// the object at path, a cancelled Connect does not count.  Returns an
+// empty string if there is nothing in flight.
+QString ControlBox::pendingCall(const QString& path)
+{
+  for (int i = pending_calls.size() - 1; i >= 0; --i) {
+    const QDBusPendingCallWatcher* w = pending_calls.at(i);
+    if (w->property("objpath").toString() != path) continue;
+    if (w->property("cancelled").toBool() ) continue;
+    return w->property("method").toString();
   } // for
 
   return QString();
 }
 
+//
+// Function to update the widgets showing calls in progress for the object
+// at path.  Called when a call is sent and when its reply arrives.
+void ControlBox::showPending(const QString& path)
+{
+  const QString method = pendingCall(path);
+  QString text;
+  if (method == "Connect") text = tr("Connecting");
+  else if (method == "Disconnect") text = tr("Disconnecting");
+  else if (method == "Remove") text = tr("Removing");
+  else if (! method.isEmpty() ) text = tr("Working");
+
+  wifi_model->setPending(path, text);
+  vpn_model->setPending(path, text);
+
+  // technology buttons are disabled while a call is in flight
+  if (technologies_list.contains(path) ) refreshDisplayWidgets(CMST::Widget_Status);
+
+  // an open tray submenu is not rebuilt by itself
+  if (wifi_submenu->isVisible() ) assembleWifiSubmenu();
+  if (vpn_submenu->isVisible() ) assembleVPNSubmenu();
+
+  return;
+}
+
+//
+// Function to return the selected row of a wifi or vpn table, or -1 if
+// nothing is selected.  The tables only allow single selection.
+int ControlBox::selectedRow(QTableView* qtv)
+{
+  QModelIndexList list = qtv->selectionModel()->selectedRows();
+  if (list.isEmpty() ) return -1;
+
+  return list.at(0).row();
+}
+
+//
+// Function to build the icon to put in the system tray.  If the
+// trayiconbackground color is valid and there is a valid alpha channel
+// convert the alpha to the background color to get our fake transparency.
+// Fake transparency can be set as a command line option so
+// trayiconbackground is set up in the constructor.  Otherwise just convert
+// the image to ARGB32 which seems to be required for the icons to display
+// in Plasma5.  The icon gets a normal and a double resolution pixmap so it
+// looks right on HiDPI screens.
+QIcon ControlBox::compositeTrayIcon(const QIcon& src_icon, const QSize& size)
+{
+  QIcon rtnicon;
+
+  for (int scale = 1; scale <= 2; ++scale) {
+    // First convert from a QIcon through QPixmap to QImage
+    QPixmap pxm = src_icon.pixmap(src_icon.actualSize(size * scale) );
+    if (scale > 1 && pxm.width() <= size.width() ) break;  // no larger art available
+    QImage src = pxm.toImage();
+    QImage dest = QImage(src.width(), src.height(), QImage::Format_ARGB32);
+    QPainter painter(&dest);
+    if (trayiconbackground.isValid() && src.hasAlphaChannel() ) {
+      painter.setCompositionMode(QPainter::CompositionMode_Source);
+      painter.fillRect(dest.rect(), trayiconbackground);
+      painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    } // if img has alpha channel and background color valid
+    else {
+      painter.setCompositionMode(QPainter::CompositionMode_Source);
+    } // else just make an ARGB32 copy
+
+    painter.drawImage(0, 0, src);
+    painter.end();
+
+    QPixmap result = QPixmap::fromImage(dest);
+    result.setDevicePixelRatio(scale);
+    rtnicon.addPixmap(result);
+  } // for
+
+  return rtnicon;
+}
+
+//
+// Function to make the actions of a tray submenu match a list of object
+// paths.  Each action carries its object path as data.  The menu is
+// brought in line with an edit script, actions for objects that are gone
+// are deleted, new ones are created, and only actions that are out of
+// order are moved.  Return value is the list of actions in the same order
+// as paths.
+QList<QAction*> ControlBox::syncMenuActions(QMenu* menu, const QStringList& paths)
+{
+  QStringList before;
+  QList<QAction*> oldlist = menu->actions();
+  for (int i = 0; i < oldlist.count(); ++i) {
+    before.append(oldlist.at(i)->data().toString() );
+  } // for
+
+  const QList<storeEdit> script = ObjectStore::editScript(before, paths);
+  for (int i = 0; i < script.size(); ++i) {
+    const storeEdit& edit = script.at(i);
+    switch (edit.op) {
+      case storeEdit::Remove:
+        delete menu->actions().at(edit.from);
+        break;
+      case storeEdit::Insert: {
+        QAction* act = new QAction(menu);
+        act->setData(edit.key);
+        menu->insertAction(menu->actions().value(edit.to, 0), act);
+        } break;
+      case storeEdit::Move: {
+        QAction* act = menu->actions().at(edit.from);
+        menu->removeAction(act);
+        menu->insertAction(menu->actions().value(edit.to, 0), act);
+        } break;
+      default:
+        break;
+    } // switch
+  } // for
+
+  return menu->actions();
+}
+
+//
+// Function to set the icon of a tray submenu action, but only if it is
+// different from the icon the action already has.
+void ControlBox::setActionIcon(QAction* act, const QString& name)
+{
+  if (act->property("icon_name").toString() == name) return;
+
+  act->setProperty("icon_name", name);
+  act->setIcon(iconman->getIcon(name) );
+
+  return;
+}
+
+//
+// Function to build the tooltip text for an action in one of the tray
+// submenus.  Called from the event filter when the tooltip is requested.
+QString ControlBox::menuToolTip(QMenu* menu, const QString& path)
+{
+  QString ttstr;
+
+  if (menu == tech_submenu) {
+    const arrayElement* ae = technologies_list.find(path);
+    if (ae == 0) return ttstr;
+    ttstr = QString(tr("<p style='white-space:pre'><center><b>%1 Properties</b></center>").arg(TranslateStrings::cmtr(ae->objmap.value("Name").toString())) );
+    ttstr.append(tr("Type: %1").arg(ae->objmap.value("Type").toString()) );
+    ttstr.append(tr("<br>Powered "));
+    ae->rec.is(Conn::Powered) ? ttstr.append(tr("On")) : ttstr.append(tr("Off"));
+    ttstr.append("<br>");
+    ae->rec.is(Conn::Connected) ? ttstr.append(tr("Connected")) : ttstr.append(tr("Not Connected"));
+    ttstr.append(tr("<br>Tethering "));
+    ae->rec.is(Conn::Tethering) ? ttstr.append(tr("Enabled")) : ttstr.append(tr("Disabled"));
+  } // if tech
+
+  else if (menu == wifi_submenu) {
+    const arrayElement* ae = services_list.find(path);
+    if (ae == 0) return ttstr;
+    QString state = ae->objmap.value("State").toString();
+    ttstr = QString(tr("<p style='white-space:pre'><center><b>%1</b></center>").arg(getNickName(ae->objpath)) );
+    ttstr.append(tr("Connection : %1").arg(TranslateStrings::cmtr(state)) );
+    ttstr.append("<br>");
+    ttstr.append(tr("Signal Strength: %1%").arg(ae->rec.strength) );
+    ttstr.append("<br>");
+    ae->rec.is(Conn::Favorite) ? ttstr.append(tr("Favorite Connection")) : ttstr.append(tr("Never Connected"));
+    ttstr.append("<br>");
+    QStringList sl_tr;
+    for (int m = 0; m < ae->objmap.value("Security").toStringList().size(); ++m) {
+      sl_tr << TranslateStrings::cmtr(ae->objmap.value("Security").toStringList().at(m) );
+    } // for
+    ttstr.append(tr("Security: %1").arg(sl_tr.join(',')) );
+    if (ae->rec.is(Conn::Roaming) ) ttstr.append(tr("<br>Roaming"));
+    ttstr.append(tr("<br>Autoconnect is "));
+    ae->rec.is(Conn::AutoConnect) ? ttstr.append(tr("Enabled")) : ttstr.append(tr("Disabled"));
+  } // else if wifi
+
+  else if (menu == vpn_submenu) {
+    const arrayElement* ae = services_list.find(path);
+    if (ae == 0) return ttstr;
+    ttstr = QString(tr("<p style='white-space:pre'><center><b>%1</b></center>").arg(getNickName(ae->objpath)) );
+    ttstr.append(tr("Connection : %1").arg(TranslateStrings::cmtr(ae->objmap.value("State").toString())) );
+  } // else if vpn
+
+  return ttstr;
+}
+
 
 // Slot to connect to the notification client. Called from QTimers to give time for the notification server
 // to start up if this program is started automatically at boot.  We make four attempts at finding the
@@ -2879,7 +3167,7 @@ void ControlBox::configureService()
   if (ui.comboBox_service->currentIndex() < 0 ) return;
 
   // Create a new properties editor
-  PropertiesEditor* peditor = new PropertiesEditor(this, services_list.at(ui.comboBox_service->currentIndex()) );
+  PropertiesEditor* peditor = new PropertiesEditor(this, services_list.at(ui.comboBox_service->currentIndex()), proxies->service(services_list.at(ui.comboBox_service->currentIndex()).objpath.path()) );
 
   // Set the whatsthis button icon
   peditor->setWhatsThisIcon(iconman->getIcon("whats_this"));
@@ -2924,10 +3212,50 @@ void ControlBox::provisionService()
 
 //
 // Slot called when a connection to the local socket was detected.  Means another instance of CMST was started
-// while this instance was running.
+// while this instance was running, show ourself.  An instance started
+// with a command (--dump-memory) writes it as soon as it is connected,
+// if the command is already here answer it instead of showing.
 void ControlBox::socketConnectionDetected()
 {
-  this->showNormal();
+  while (socketserver->hasPendingConnections() ) {
+    QLocalSocket* socket = socketserver->nextPendingConnection();
+    connect(socket, SIGNAL(readyRead()), this, SLOT(socketReadyRead()));
+    connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+    if (socket->canReadLine() ) this->socketCommand(socket);
+    else this->showNormal();
+
+    // a plain start closes its end straight away
+    if (socket->state() == QLocalSocket::UnconnectedState) socket->deleteLater();
+  } // while
+
+  return;
+}
+
+//
+// Slot to read a command that arrives after the connection was detected
+void ControlBox::socketReadyRead()
+{
+  QLocalSocket* socket = qobject_cast<QLocalSocket*>(sender() );
+  if (socket != 0) this->socketCommand(socket);
+
+  return;
+}
+
+//
+// Function to answer a command from another instance of CMST.  The only
+// command is dump-memory (from --dump-memory), answered with the memory
+// report and the icon cache hit and miss counts.
+void ControlBox::socketCommand(QLocalSocket* socket)
+{
+  if (! socket->canReadLine() ) return;
+
+  const QString cmd = QString::fromUtf8(socket->readLine()).trimmed();
+  if (cmd == "dump-memory") {
+    socket->write(MemStats::report(memoryItems()).toUtf8() );
+    socket->write(QString("icon cache lookups: %1 hits, %2 misses\n").arg(iconman->cacheHits()).arg(iconman->cacheMisses()).toUtf8() );
+    socket->disconnectFromServer();
+  } // if dump-memory
+
   return;
 }
 
@@ -2942,19 +3270,28 @@ void ControlBox::cleanUp()
   // write settings
   this->writeSettings();
 
+  // stop the ingest, metrics and watchdog threads
+  ingest_thread->quit();
+  ingest_thread->wait();
+  if (metrics_thread != NULL) {
+    metrics_thread->quit();
+    metrics_thread->wait();
+  } // if metrics
+  if (watchdog != NULL) watchdog->stop();
+
   // unregister objects
   if (con_manager->isValid() ) {
     // agent
-    shared::processReply(con_manager->call(QDBus::AutoDetect, "UnregisterAgent", QVariant::fromValue(QDBusObjectPath(AGENT_OBJECT))) );
+    shared::processReply(con_manager->UnregisterAgent(QDBusObjectPath(AGENT_OBJECT)) );
     // counter - only have a signal-slot connection if the counter was able to be registered
     if (counter->cnxns() > 0) {
-      shared::processReply(con_manager->call(QDBus::AutoDetect, "UnregisterCounter", QVariant::fromValue(QDBusObjectPath(CNTR_OBJECT))) );
+      shared::processReply(con_manager->UnregisterCounter(QDBusObjectPath(CNTR_OBJECT)) );
     } // if counters are connected to anything
   } // if con_manager isValid
 
   if (vpn_manager != NULL) {
     if (vpn_manager->isValid() ) {
-      shared::processReply(vpn_manager->call(QDBus::AutoDetect, "UnregisterAgent", QVariant::fromValue(QDBusObjectPath(VPN_AGENT_OBJECT))) );
+      shared::processReply(vpn_manager->UnregisterAgent(QDBusObjectPath(VPN_AGENT_OBJECT)) );
     } // ivpn_manager isValid
   } // not null
 
@@ -2976,6 +3313,14 @@ void ControlBox::callColorDialog()
 void ControlBox::iconColorChanged(const QString& col)
 {
   iconman->setIconColor(QColor(col) );
+  trayicon_cache.clear();
+  trayicon_key.clear();
+  svc_delegate->setHighlight(QColor(col) );
+  wifi_model->refreshIcons();
+  vpn_model->refreshIcons();
+  for (int i = 0; i < info_submenu->actions().count(); ++i) {
+    info_submenu->actions().at(i)->setProperty("icon_name", QVariant() );
+  } // for
   this->updateDisplayWidgets();
   ui.toolButton_whatsthis->setIcon(iconman->getIcon("whats_this"));
   agent->setWhatsThisIcon(iconman->getIcon("whats_this"));
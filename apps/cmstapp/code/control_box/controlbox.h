@@ -48,6 +48,8 @@ DEALINGS IN THE SOFTWARE.
 # include <QProgressBar>
 # include <QColor>
 # include <QToolButton>
+# include <QTimer>
+# include <QThread>
 
 # include "ui_controlbox.h"
 # include "./code/agent/agent.h"
@@ -55,15 +57,15 @@ DEALINGS IN THE SOFTWARE.
 # include "./code/notify/notify.h"
 # include "./code/iconman/iconman.h"
 # include "./code/vpn_agent/vpnagent.h"
-
-//  Two of the connman.Manager query functions will return an array of structures.
-//  This struct provides a receiving element we can use to collect the return data.
-struct arrayElement
-{
-  QDBusObjectPath objpath;
-  QMap<QString,QVariant> objmap;
-};
-
+# include "./code/objstore/objstore.h"
+# include "./code/svcmodel/svcmodel.h"
+# include "./code/proxy/proxypool.h"
+# include "./code/ingest/ingest.h"
+# include "./code/watchdog/watchdog.h"
+# include "./code/memstats/memstats.h"
+# include "./code/metrics/metrics.h"
+# include "manager_interface.h"
+# include "vpnmanager_interface.h"
 
 //
 // custom QFrame containing a QToolButton that will emit a button id
@@ -89,8 +91,9 @@ class idButton : public QFrame
 };
 
 //
-//  The main program class based on a QDialog
-class ControlBox : public QDialog
+//  The main program class based on a QDialog.  Also watches the object
+//  stores so it knows which display widgets a change affects.
+class ControlBox : public QDialog, public StoreObserver
 {
   Q_OBJECT
 
@@ -107,17 +110,21 @@ class ControlBox : public QDialog
     void closeEvent(QCloseEvent*);
     void keyPressEvent(QKeyEvent*);
     bool eventFilter(QObject*, QEvent*);   
+    void showEvent(QShowEvent*);
+    void changeEvent(QEvent*);
     
   private:
   // members 
     Ui::ControlBox ui;
     quint16 q16_errors;
+    quint16 q16_dirty;
     QMap<QString,QVariant>  properties_map;
-    QList<arrayElement>   services_list;
-    QList<arrayElement>   technologies_list;
-    QList<arrayElement>   wifi_list;
-    QList<arrayElement>   peer_list;
-    QList<arrayElement> 	vpn_list;
+    ObjectStore services_list;
+    ObjectStore technologies_list;
+    ObjectStore peer_list;
+    ServiceModel* wifi_model;
+    ServiceModel* vpn_model;
+    ServiceDelegate* svc_delegate;
     ConnmanAgent* agent;
     ConnmanVPNAgent* vpnagent;
     ConnmanCounter* counter;  
@@ -125,8 +132,9 @@ class ControlBox : public QDialog
     short wifi_interval;    
     quint32 counter_accuracy; 
     quint32 counter_period;       
-    QDBusInterface* con_manager;
-    QDBusInterface* vpn_manager;
+    NetConnmanManagerInterface* con_manager;
+    NetConnmanVpnManagerInterface* vpn_manager;
+    ProxyPool* proxies;
     QSystemTrayIcon*  trayicon;
     QMenu* trayiconmenu;
     QMenu* tech_submenu;
@@ -145,10 +153,30 @@ class ControlBox : public QDialog
     QString onlineobjectpath;
     QLocalServer* socketserver;
     QColor trayiconbackground;
+    QHash<QString,QIcon> trayicon_cache;
+    int max_cached_icons;
+    QString trayicon_key;
+    QTimer* update_timer;
+    QList<QDBusPendingCallWatcher*> pending_calls;
+    QString details_path;
+    quint32 details_gen;
+    Ingest* ingest;
+    QThread* ingest_thread;
+    MetricsServer* metrics;
+    QThread* metrics_thread;
+    quint32 services_changed;
+    bool b_flush_now;
+    QTimer* stats_timer;
+    Watchdog* watchdog;
     IconManager* iconman;
   
   // functions
     int managerRescan(const int& srv = 0);
+    int selectedRow(QTableView*);
+    QList<QAction*> syncMenuActions(QMenu*, const QStringList&);
+    void setActionIcon(QAction*, const QString&);
+    QString menuToolTip(QMenu*, const QString&);
+    QIcon compositeTrayIcon(const QIcon&, const QSize&);
     void assembleTabStatus();
     void assembleTabDetails();
     void assembleTabWireless();
@@ -156,18 +184,25 @@ class ControlBox : public QDialog
     void assembleTabCounters();
     void assembleTrayIcon();
     void sendNotifications();
-    bool getProperties();
-    bool getTechnologies();   
-    bool getServices();
-    bool getArray(QList<arrayElement>&, const QDBusMessage&);
-    bool getMap(QMap<QString,QVariant>&, const QDBusMessage&); 
     void logErrors(const quint16&);
     QString readResourceText(const char*);
     void clearCounters();
     QString getNickName(const QDBusObjectPath&);
+    void refreshDisplayWidgets(const quint16&, bool b_now = false);
+    bool isShowing(QWidget*);
+    bool asyncCall(QDBusAbstractInterface*, const QString&, const QList<QVariant>& = QList<QVariant>() );
+    QString pendingCall(const QString&);
+    void showPending(const QString&);
+    void managerPropertyChanged(const QString&, const QVariant&, const QVariant&);
+    void propertyChanged(const ObjectStore*, const QString&, const QString&, const QVariant&, const QVariant&);
+    void listChanged(const ObjectStore*);
+    QList<MemStats::item> memoryItems();
+    void socketCommand(QLocalSocket*);
 
   private slots:
     void updateDisplayWidgets();
+    void flushDisplayWidgets();
+    void asyncCallFinished(QDBusPendingCallWatcher*);
     void moveService(QAction*);
     void moveButtonPressed(QAction*);
     void enableMoveButtons(int,int);
@@ -175,13 +210,7 @@ class ControlBox : public QDialog
     void connectPressed();
     void disconnectPressed();
     void removePressed();
-    void dbsPropertyChanged(QString,QDBusVariant);
-    void dbsServicesChanged(QList<QVariant>, QList<QDBusObjectPath>, QDBusMessage);
-    void dbsPeersChanged(QList<QVariant>, QList<QDBusObjectPath>, QDBusMessage);
-    void dbsServicePropertyChanged(QString, QDBusVariant, QDBusMessage);
-    void dbsTechnologyPropertyChanged(QString, QDBusVariant, QDBusMessage);
-    void dbsTechnologyAdded(QDBusObjectPath, QVariantMap);
-    void dbsTechnologyRemoved(QDBusObjectPath);
+    void adoptSnapshot(bool b_rescan = false);
     void scanWiFi();
     void wifiIDPass(const QString& obj_path = QString() );
     void toggleOfflineMode(bool);
@@ -207,10 +236,18 @@ class ControlBox : public QDialog
     void configureService();
     void provisionService();
     void socketConnectionDetected();
+    void socketReadyRead();
     void cleanUp();
     void callColorDialog();
     void iconColorChanged(const QString&);
     void setStateRescan(bool);
+    void assembleTechSubmenu();
+    void assembleInfoSubmenu();
+    void assembleWifiSubmenu();
+    void assembleVPNSubmenu();
+    void assembleTabStats();
+    void enableStatsTab(bool);
+    void stallDetected(const QString&, int);
 };
 
 #endif
@@ -0,0 +1,254 @@
+/**************************** iconindex.cpp ***************************
+
+Class to maintain an index of the files in an icon theme.  The index
+maps an icon base name to the files that provide it and is kept on disk
+so the theme directories do not need to be walked every time we look
+for the file behind an icon.
+
+Copyright (C) 2015-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include "./iconindex.h"
+# include "../resource.h"
+# include "./code/trace/trace.h"
+# include "./code/memstats/memstats.h"
+
+# include <QDir>
+# include <QFile>
+# include <QFileInfo>
+# include <QDirIterator>
+# include <QDateTime>
+# include <QIcon>
+# include <QSaveFile>
+# include <QByteArray>
+# include <QProcessEnvironment>
+
+//  The first line of an index file, change the number if the layout of
+//  the file ever changes so old files get rebuilt.
+# define INDEX_MAGIC "CMST_ICON_INDEX 1"
+
+// Constructor
+IconIndex::IconIndex()
+{
+  index_theme.clear();
+  b_loaded = false;
+  index.clear();
+}
+
+////////////////////////////// Public Functions ////////////////////////////
+//
+// Function to load the index for a theme.  Use the index on disk if it is
+// still valid, otherwise walk the theme directories and write a new one.
+void IconIndex::load(const QString& theme)
+{
+  CMST_TRACE("IconIndex::load", "icons");
+
+  index.clear();
+  index_theme = theme;
+  b_loaded = true;
+
+  const QStringList roots = themeRoots(theme);
+  const QString file = cacheFile(theme);
+  if (readIndex(file, roots) ) return;
+
+  index.clear();
+  QList<QPair<QString, qint64> > dirs;
+  buildIndex(roots, dirs);
+  if (! writeIndex(file, roots, dirs) )
+    qWarning("Failed writing the icon index file: %s", qPrintable(file) );
+
+  return;
+}
+
+//
+// Function to return the files (canonical paths) whose base name matches
+// iconname.  Files are in the order they were found in the search paths.
+QStringList IconIndex::lookup(const QString& iconname) const
+{
+  return index.value(iconname);
+}
+
+//
+// Function to return an estimate of the bytes held by the index
+qint64 IconIndex::memoryUsage() const
+{
+  qint64 rtn = qint64(index.capacity() ) * (sizeof(void*) + sizeof(QString) + sizeof(QStringList) );
+  QHash<QString, QStringList>::const_iterator itr = index.constBegin();
+  for (; itr != index.constEnd(); ++itr) {
+    rtn += MemStats::bytes(itr.key() ) + MemStats::bytes(itr.value() );
+  } // for
+
+  return rtn;
+}
+
+////////////////////////////// Private Functions ////////////////////////////
+//
+// Function to return the name of the index file for a theme
+QString IconIndex::cacheFile(const QString& theme) const
+{
+  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+  QString dir = QString(env.value("XDG_CACHE_HOME", QString(QDir::homePath()) + "/.cache") + "/%1").arg(QString(APP).toLower() );
+
+  return QString(dir + "/icon_index_%1").arg(theme);
+}
+
+//
+// Function to return the theme directories to index, one for each of the
+// icon theme search paths that actually contains the theme.
+QStringList IconIndex::themeRoots(const QString& theme) const
+{
+  QStringList roots;
+  QStringList sl_dirs = QIcon::themeSearchPaths();
+  for (int i = 0; i < sl_dirs.size(); ++i) {
+    QString root = QString(sl_dirs.at(i) + '/' + theme);
+    if (QFileInfo(root).isDir() ) roots << root;
+  } // for
+
+  return roots;
+}
+
+//
+// Function to read an index file into the index hash.  Return false if
+// the file does not exist, is for a different set of theme directories,
+// or if any of the directories it recorded has been modified since the
+// file was written.
+//
+// File layout (UTF-8, one record per line, fields separated by tabs):
+//    CMST_ICON_INDEX 1
+//    root <tab> path                 one line per theme root
+//    dir <tab> mtime <tab> path      one line per indexed directory
+//    <empty line>
+//    basename <tab> path [<tab> path ...]
+bool IconIndex::readIndex(const QString& file, const QStringList& roots)
+{
+  QFile f(file);
+  if (! f.open(QIODevice::ReadOnly) ) return false;
+
+  bool b_valid = true;
+  bool b_header = true;
+  QStringList filed_roots;
+  int lineno = 0;
+  while (b_valid && ! f.atEnd() ) {
+    QByteArray ba = f.readLine();
+    if (ba.endsWith('\n') ) ba.chop(1);
+    const QString line = QString::fromUtf8(ba);
+
+    // header, validate as we go
+    if (b_header) {
+      if (lineno++ == 0) {
+        b_valid = (line == INDEX_MAGIC);
+      } // if first line
+      else if (line.isEmpty() ) {
+        b_header = false;
+        b_valid = (filed_roots == roots);
+      } // else if end of header
+      else if (line.startsWith("root\t") ) {
+        filed_roots << line.section('\t', 1);
+      } // else if root
+      else if (line.startsWith("dir\t") ) {
+        const qint64 mtime = line.section('\t', 1, 1).toLongLong();
+        const QFileInfo fi(line.section('\t', 2) );
+        b_valid = (fi.isDir() && fi.lastModified().toMSecsSinceEpoch() == mtime);
+      } // else if dir
+      else {
+        b_valid = false;
+      } // else unknown header line
+    } // if header
+
+    // index entries
+    else if (! line.isEmpty() ) {
+      QStringList sl = line.split('\t');
+      const QString key = sl.takeFirst();
+      index.insert(key, sl);
+    } // else
+  } // while
+
+  f.close();
+
+  if (b_header) b_valid = false;  // never reached the end of the header
+  if (! b_valid) index.clear();
+
+  return b_valid;
+}
+
+//
+// Function to walk the theme directories and fill the index.  This is the
+// expensive part, every file in the theme gets looked at.  dirs receives
+// every directory visited along with its modification time.
+void IconIndex::buildIndex(const QStringList& roots, QList<QPair<QString, qint64> >& dirs)
+{
+  dirs.clear();
+
+  for (int i = 0; i < roots.size(); ++i) {
+    QFileInfo rfi(roots.at(i) );
+    dirs.append(qMakePair(rfi.absoluteFilePath(), rfi.lastModified().toMSecsSinceEpoch()) );
+
+    QDirIterator dit(roots.at(i), QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden, QDirIterator::Subdirectories);
+    while (dit.hasNext()) {
+      dit.next();
+      QFileInfo fi = dit.fileInfo();
+      if (fi.isDir() ) {
+        dirs.append(qMakePair(fi.absoluteFilePath(), fi.lastModified().toMSecsSinceEpoch()) );
+        continue;
+      } // if dir
+      index[fi.completeBaseName()].append(fi.canonicalFilePath() );
+    } // while
+  } // for
+
+  return;
+}
+
+//
+// Function to write the index to disk.  Written to a temporary file and
+// renamed so a reader never sees a partial file.
+bool IconIndex::writeIndex(const QString& file, const QStringList& roots, const QList<QPair<QString, qint64> >& dirs)
+{
+  QDir d;
+  if (! d.mkpath(QFileInfo(file).path()) ) return false;
+
+  QSaveFile f(file);
+  if (! f.open(QIODevice::WriteOnly) ) return false;
+
+  QByteArray ba;
+  ba.append(INDEX_MAGIC).append('\n');
+  for (int i = 0; i < roots.size(); ++i) {
+    ba.append("root\t").append(roots.at(i).toUtf8() ).append('\n');
+  } // for
+  for (int i = 0; i < dirs.size(); ++i) {
+    ba.append("dir\t").append(QByteArray::number(dirs.at(i).second) ).append('\t').append(dirs.at(i).first.toUtf8() ).append('\n');
+  } // for
+  ba.append('\n');
+
+  QHash<QString, QStringList>::const_iterator itr;
+  for (itr = index.constBegin(); itr != index.constEnd(); ++itr) {
+    ba.append(itr.key().toUtf8() );
+    for (int i = 0; i < itr.value().size(); ++i) {
+      ba.append('\t').append(itr.value().at(i).toUtf8() );
+    } // for
+    ba.append('\n');
+  } // for
+
+  f.write(ba);
+
+  return f.commit();
+}
@@ -0,0 +1,73 @@
+/**************************** iconindex.h *****************************
+
+Class to maintain an index of the files in an icon theme.  The index
+maps an icon base name to the files that provide it and is kept on disk
+so the theme directories do not need to be walked every time we look
+for the file behind an icon.
+
+Copyright (C) 2015-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef ICON_INDEX
+# define ICON_INDEX
+
+# include <QString>
+# include <QStringList>
+# include <QHash>
+# include <QList>
+# include <QPair>
+
+//
+//  Index of the files in one icon theme.  The index is built by walking
+//  the theme directories under QIcon::themeSearchPaths() once and is then
+//  saved in $XDG_CACHE_HOME/cmst.  On the next start the saved index is
+//  read back and used as long as none of the theme directories have been
+//  modified since it was written.
+class IconIndex
+{
+  public:
+    IconIndex();
+
+  // functions
+    void load(const QString&);
+    QStringList lookup(const QString&) const;
+    inline QString theme() const {return index_theme;}
+    inline bool isLoaded() const {return b_loaded;}
+    inline int size() const {return index.size();}
+    qint64 memoryUsage() const;
+
+  private:
+  // members
+    QString index_theme;
+    bool b_loaded;
+    QHash<QString, QStringList> index;
+
+  // functions
+    QString cacheFile(const QString&) const;
+    QStringList themeRoots(const QString&) const;
+    bool readIndex(const QString&, const QStringList&);
+    void buildIndex(const QStringList&, QList<QPair<QString, qint64> >&);
+    bool writeIndex(const QString&, const QStringList&, const QList<QPair<QString, qint64> >&);
+};
+
+# endif
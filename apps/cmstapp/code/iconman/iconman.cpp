@@ -27,6 +27,8 @@ DEALINGS IN THE SOFTWARE.
 ***********************************************************************/
 
 # include "./iconman.h"
+# include "./code/trace/trace.h"
+# include "./code/memstats/memstats.h"
 
 # include <QDir>
 # include <QFile>
@@ -39,7 +41,6 @@ DEALINGS IN THE SOFTWARE.
 # include <QSettings>
 # include <QMessageBox>
 # include <QProcessEnvironment>
-# include <QDirIterator>
 
 // Constructor
 IconManager::IconManager(QObject* parent) : QObject(parent) 
@@ -53,8 +54,13 @@ IconManager::IconManager(QObject* parent) : QObject(parent)
 	// Set the qrc data member
 	qrc = QString(":/text/text/icon_def.txt");
 	
-	// Initialize icon_map
+	// Initialize icon_map and the icon cache
 	icon_map.clear();
+	icon_cache.clear();
+	cache_theme = QIcon::themeName();
+	cache_hits = 0;
+	cache_misses = 0;
+	max_cached = 128;
 	
 	// Make the local conf file if necessary
 	this->makeLocalFile();	
@@ -95,43 +101,84 @@ IconManager::IconManager(QObject* parent) : QObject(parent)
 
 ////////////////////////////// Public Functions ////////////////////////////
 //
-// Function to return a QIcon based on the name provided
+// Function to return a QIcon based on the name provided.  Icons are built
+// once and then served from icon_cache.  The cache only holds icons for
+// the current theme and icon color, it is cleared when either changes.
 QIcon IconManager::getIcon(const QString& name)
 {
-	// Data members
-	IconElement ie = icon_map.value(name);
-	QIcon ico = QIcon();
+	// Drop the cache if the theme changed since it was filled
+	if (QIcon::themeName() != cache_theme) {
+		clearCache();
+		cache_theme = QIcon::themeName();
+	}	// if theme changed
 	
-	// If the internal theme is being used (and the user has not
-	// messed up the local config file) use that first.
-	if (QIcon::themeName() == INTERNAL_THEME) {
-		if (buildResourceIcon(ico, ie.resource_path, ie.colorize) )
-			return ico;
-	}	// if using internal theme
+	QHash<QString, QIcon>::const_iterator itr = icon_cache.constFind(name);
+	if (itr != icon_cache.constEnd() ) {
+		++cache_hits;
+		return itr.value();
+	}	// if cached
 	
-	// Next look for a user specified theme icon
-	if (ie.theme_names.size() > 0 ) {
-		for (int i = 0; i < ie.theme_names.size(); ++i) {
-			if (buildThemeIcon(ico, ie.theme_names.at(i) )  )
-				return ico;
-		}	// for
-	}	// if theme_names.size() > 0
+	++cache_misses;
+	QIcon ico = buildIcon(name);
+	if (max_cached > 0 && icon_cache.size() >= max_cached) clearCache();
+	icon_cache.insert(name, ico);
 	
-	// Next look for a freedesktop.org named icon
-	if (! ie.fdo_name.isEmpty() ) {
-		if (buildThemeIcon(ico, ie.fdo_name) )
-			return ico;
-	}	// if freedesktop name not empty
-			
-	// Then look for hardcoded name in the users config dir
-	if (buildResourceIcon(ico, ie.resource_path, ie.colorize) )
-		return ico;
-	
-	// Last stop is our fallback hard coded into the program
-	buildResourceIcon(ico, getFallback(name), ie.colorize);
 	return ico;
 }
 
+//
+// Function to set the color used to colorize the internal icons.  Icons
+// already built used the old color so the cache is cleared.
+void IconManager::setIconColor(const QColor& col)
+{
+	if (col == icon_color) return;
+	
+	icon_color = col;
+	clearCache();
+	
+	return;
+}
+
+//
+// Function to empty the icon cache
+void IconManager::clearCache()
+{
+	icon_cache.clear();
+	
+	return;
+}
+
+//
+// Function to load the icon index for the current theme unless it is
+// already loaded.  Called at startup once the theme is set so the theme
+// directories are checked before the first icon is looked up.
+void IconManager::loadIndex()
+{
+	if (! icon_index.isLoaded() || icon_index.theme() != QIcon::themeName() )
+		icon_index.load(QIcon::themeName() );
+	
+	return;
+}
+
+//
+// Function to return an estimate of the bytes held by the icon cache.  An
+// icon is counted as a 32 bit pixmap for each size it can supply, which
+// is what it costs once every size has been drawn.
+qint64 IconManager::cacheBytes() const
+{
+	qint64 rtn = 0;
+	QHash<QString, QIcon>::const_iterator itr = icon_cache.constBegin();
+	for (; itr != icon_cache.constEnd(); ++itr) {
+		rtn += MemStats::bytes(itr.key() );
+		const QList<QSize> sizes = itr.value().availableSizes();
+		for (int i = 0; i < sizes.size(); ++i) {
+			rtn += qint64(sizes.at(i).width()) * sizes.at(i).height() * 4;
+		}	// for
+	}	// for
+	
+	return rtn;
+}
+
 //
 // Function to return a QString containing the fully qualified icon name or resource path
 QString IconManager::getIconName(const QString& name)
@@ -184,6 +231,45 @@ QString IconManager::getIconName(const QString& name)
  }
 
 ////////////////////////////// Private Functions ////////////////////////////
+//
+// Function to build a QIcon based on the name provided.  Called from
+// getIcon() when the icon is not in the cache.
+QIcon IconManager::buildIcon(const QString& name)
+{
+	// Data members
+	IconElement ie = icon_map.value(name);
+	QIcon ico = QIcon();
+	
+	// If the internal theme is being used (and the user has not
+	// messed up the local config file) use that first.
+	if (QIcon::themeName() == INTERNAL_THEME) {
+		if (buildResourceIcon(ico, ie.resource_path, ie.colorize) )
+			return ico;
+	}	// if using internal theme
+	
+	// Next look for a user specified theme icon
+	if (ie.theme_names.size() > 0 ) {
+		for (int i = 0; i < ie.theme_names.size(); ++i) {
+			if (buildThemeIcon(ico, ie.theme_names.at(i) )  )
+				return ico;
+		}	// for
+	}	// if theme_names.size() > 0
+	
+	// Next look for a freedesktop.org named icon
+	if (! ie.fdo_name.isEmpty() ) {
+		if (buildThemeIcon(ico, ie.fdo_name) )
+			return ico;
+	}	// if freedesktop name not empty
+			
+	// Then look for hardcoded name in the users config dir
+	if (buildResourceIcon(ico, ie.resource_path, ie.colorize) )
+		return ico;
+	
+	// Last stop is our fallback hard coded into the program
+	buildResourceIcon(ico, getFallback(name), ie.colorize);
+	return ico;
+}
+
 //
 // Function to make an icon from resource file(s).  A reference to the Icon
 // is sent to this function and is modified by this function.  If the name
@@ -485,21 +571,13 @@ QPixmap IconManager::processArt(const QString& res, const QColor& color)
 // Called from the getIconName function
 QString IconManager::findQualifiedName(const QString& iconname, const QStringList& sl_filter)
 {
-	// variables
-	QStringList sl_results = QStringList();
-	
-	// get search paths
-	QStringList sl_dirs = QIcon::themeSearchPaths();
-	if (sl_dirs.size() < 1) return QString();
+	CMST_TRACE("IconManager::findQualifiedName", "icons");
 
-	// iterate over the search paths 
-	for (int i = 0; i < sl_dirs.size(); ++i) { 
-		QDirIterator dit(QString(sl_dirs.at(i) + '/' + QIcon::themeName()) , QDirIterator::Subdirectories);
-		while (dit.hasNext()) {
-			QFileInfo fi(dit.next());
-			if (fi.completeBaseName() == iconname) sl_results << fi.canonicalFilePath();
-		}	// while
-	}	// for
+	// (re)load the index if the theme changed since it was loaded
+	this->loadIndex();
+	
+	// files in the theme matching iconname
+	const QStringList sl_results = icon_index.lookup(iconname);
 	
 	// search the list for icons matching the filter list and return first found
 	if (sl_results.size() < 1) return QString();
@@ -34,9 +34,11 @@ DEALINGS IN THE SOFTWARE.
 # include <QStringList>
 # include <QIcon>
 # include <QMap>
+# include <QHash>
 # include <QColor>
 # include <QMap>
 # include "../resource.h"
+# include "./iconindex.h"
 
 struct IconElement
 {
@@ -57,7 +59,16 @@ class IconManager : public QObject
   // functions
 		QIcon getIcon(const QString&);
 		QString getIconName(const QString&);
-		inline void setIconColor(const QColor& col) {icon_color = col;}
+		void setIconColor(const QColor&);
+		void clearCache();
+		void loadIndex();
+		inline quint32 cacheHits() const {return cache_hits;}
+		inline quint32 cacheMisses() const {return cache_misses;}
+		inline int cacheSize() const {return icon_cache.size();}
+		inline void setMaxCached(int i) {max_cached = i;}
+		qint64 cacheBytes() const;
+		inline int indexSize() const {return icon_index.size();}
+		inline qint64 indexBytes() const {return icon_index.memoryUsage();}
   
   private:
   // members
@@ -65,8 +76,15 @@ class IconManager : public QObject
 		QString cfg;
 		QString qrc;
 		QColor icon_color;
+		QHash<QString, QIcon> icon_cache;
+		QString cache_theme;
+		quint32 cache_hits;
+		quint32 cache_misses;
+		int max_cached;
+		IconIndex icon_index;
 		
 	// functions
+		QIcon buildIcon(const QString&);
 		bool buildResourceIcon(QIcon&, const QString&, const QString&);
 		bool buildThemeIcon(QIcon&, const QString&);	
 		QString getFallback(const QString&);
@@ -36,10 +36,13 @@ DEALINGS IN THE SOFTWARE.
 # include <QSessionManager>
 # include <QTranslator>
 # include <QLibraryInfo>
+# include <QTextStream>
 
 # include <signal.h>
 
 # include "./control_box/controlbox.h"
+# include "./shared/shared.h"
+# include "./code/trace/trace.h"
 # include "../resource.h"
 
 
@@ -65,6 +68,26 @@ int main(int argc, char *argv[])
   QLocalSocket* socket = new QLocalSocket();
   socket->connectToServer(SOCKET_NAME);
   bool b_connected = socket->waitForConnected(500);
+
+  // --dump-memory asks the running instance for its memory report
+  if (QCoreApplication::arguments().contains("--dump-memory") ) {
+    if (! b_connected) {
+      qDebug() << QCoreApplication::translate("main.cpp", "No running instance of CMST was found.");
+      delete socket;
+      return 1;
+    }
+    socket->write("dump-memory\n");
+    QByteArray ba;
+    while (socket->waitForReadyRead(2000) ) {
+      ba.append(socket->readAll() );
+    }
+    ba.append(socket->readAll() );
+    delete socket;
+    QTextStream out(stdout);
+    out << QString::fromUtf8(ba);
+    return 0;
+  }
+
   socket->abort();
   delete socket;
   if (b_connected) {
@@ -124,6 +147,12 @@ int main(int argc, char *argv[])
 		"0");
   parser.addOption(waitTime);
 
+  QCommandLineOption busAddress (QStringList() << "bus-address",
+		QCoreApplication::translate("main.cpp", "Look for connman on the D-Bus bus at this address instead of the system bus. Used to run against a private dbus-daemon."),
+		QCoreApplication::translate("main.cpp", "address"),
+		QString("") );
+  parser.addOption(busAddress);
+
   QCommandLineOption counterUpdateKb (QStringList() << "counter-update-kb",
 		QCoreApplication::translate("main.cpp", "[Experimental] The number of kb that have to be transmitted before the counter updates."),
 		QCoreApplication::translate("main.cpp", "KB"),
@@ -136,6 +165,10 @@ int main(int argc, char *argv[])
 		"10" );
   parser.addOption(counterUpdateRate);
 
+  QCommandLineOption dumpMemory(QStringList() << "dump-memory",
+		QCoreApplication::translate("main.cpp", "Print an estimate of the memory held by the running instance of CMST and exit.") );
+  parser.addOption(dumpMemory);
+
 	// Added on 2015.01.04 to work around QT5.4 bug with transparency not always working
   QCommandLineOption fakeTransparency(QStringList() << "fake-transparency",
 		QCoreApplication::translate("main.cpp", "If tray icon fake transparency is required, specify the background color to use (format: 0xRRGGBB)"),
@@ -143,6 +176,42 @@ int main(int argc, char *argv[])
 		"0x222222" );
   parser.addOption(fakeTransparency);
 
+  QCommandLineOption maxCachedIcons(QStringList() << "max-cached-icons",
+		QCoreApplication::translate("main.cpp", "The most icons to keep in each of the icon caches. 0 removes the limit."),
+		QCoreApplication::translate("main.cpp", "n"),
+		"128" );
+  parser.addOption(maxCachedIcons);
+
+  QCommandLineOption maxNotifyFiles(QStringList() << "max-notify-files",
+		QCoreApplication::translate("main.cpp", "The most icon files to keep for notifications still showing, the oldest are removed first. 0 removes the limit."),
+		QCoreApplication::translate("main.cpp", "n"),
+		"8" );
+  parser.addOption(maxNotifyFiles);
+
+  QCommandLineOption metricsSocket(QStringList() << "metrics-socket",
+		QCoreApplication::translate("main.cpp", "Serve connectivity metrics in the OpenMetrics text format on a local socket with this name, or at this path. Each client that connects is sent the metrics and disconnected."),
+		QCoreApplication::translate("main.cpp", "name"),
+		QString("") );
+  parser.addOption(metricsSocket);
+
+  QCommandLineOption stallThreshold(QStringList() << "stall-threshold",
+		QCoreApplication::translate("main.cpp", "Log to the system log when the GUI stops responding for this many milliseconds, and where it was busy. 0 disables the check."),
+		QCoreApplication::translate("main.cpp", "milliseconds"),
+		"1000" );
+  parser.addOption(stallThreshold);
+
+  QCommandLineOption traceFile(QStringList() << "trace",
+		QCoreApplication::translate("main.cpp", "Record how long startup, D-Bus signals and calls, and display updates take, and write the timeline to this file on exit as Chrome trace-event JSON."),
+		QCoreApplication::translate("main.cpp", "file"),
+		QString("") );
+  parser.addOption(traceFile);
+
+  QCommandLineOption updateInterval(QStringList() << "update-interval",
+		QCoreApplication::translate("main.cpp", "The minimum interval in milliseconds between display updates. Changes that arrive within the interval are combined into a single update."),
+		QCoreApplication::translate("main.cpp", "milliseconds"),
+		"50" );
+  parser.addOption(updateInterval);
+
   // Added on 2014.11.24 to work around a bug where QT5.3 won't show an icon in XFCE,  My fix may not work, but keep it in for now.  If this gets fixed in
   // QT5.4 keep the command line option so users start up commands don't break, but make it a NOP.
   QCommandLineOption useXFCE(QStringList() << "use-xfce",
@@ -154,7 +223,8 @@ int main(int argc, char *argv[])
 		QCoreApplication::translate("main.cpp", "Use MATE DE specific code.") );
   parser.addOption(useMATE);
 
-  // Setup translations
+  // Setup translations, timed for --trace which we can't read yet
+  const qint64 trace_ts = Trace::now();
   QTranslator qtTranslator;
   qtTranslator.load("qt_" + QLocale::system().name(),
   QLibraryInfo::location(QLibraryInfo::TranslationsPath));
@@ -168,6 +238,7 @@ int main(int argc, char *argv[])
 	else if (cmstTranslator.load("cmst_en_US", ":/translations/translations" ) ) {
 		app.installTranslator(&cmstTranslator);
 	}
+  const qint64 trace_end = Trace::now();
 
   // Make sure all the command lines can be parsed
   // using parse() instead of process() as process stops on an error if an option needs a value
@@ -192,8 +263,27 @@ int main(int argc, char *argv[])
   // signal handler
   signal(SIGINT, signalhandler);
 
+  // start tracing if asked to
+  if (parser.isSet("trace") ) {
+    if (Trace::start(parser.value("trace")) ) {
+      Trace::setThreadName("gui");
+      Trace::complete("load translators", "startup", trace_ts, trace_end);
+    }
+    else {
+      qDebug() << QCoreApplication::translate("main.cpp", "Unable to write the trace file %1").arg(parser.value("trace"));
+    }
+  } // if trace
+
+  // the bus to find connman on, must be set before anything connects to it
+  if (parser.isSet("bus-address") ) shared::setBusAddress(parser.value("bus-address") );
+
   // Showing the dialog (or not) is controlled in the createSystemTrayIcon() function
   // called from the ControlBox constructor.  We don't show it from here.
   ControlBox ctlbox(parser);
-  return app.exec();
+  int rtn = app.exec();
+
+  // the ingest thread has been stopped by ControlBox::cleanUp()
+  Trace::stop();
+
+  return rtn;
 }
@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 # include <QPixmap>
 # include <QTemporaryFile>
 # include <QFile>
+# include <QFileInfo>
 
 # include "./notify.h"
                      
@@ -54,6 +55,7 @@ NotifyClient::NotifyClient(QObject* parent)
   b_validconnection = false;
   current_id = 0;
   file_map.clear();
+  i_max_files = 8;
   this->init();
 
   // Create our client and try to connect to the notify server
@@ -207,7 +209,16 @@ void NotifyClient::sendNotification ()
 				tempfileicon = NULL;
 			}	// else
 		}	// if contains current_id and not NULL
-		if (tempfileicon != NULL) file_map[current_id] = tempfileicon;
+		if (tempfileicon != NULL) {
+			// keep at most i_max_files icon files, the oldest go first
+			while (i_max_files > 0 && file_map.size() >= i_max_files) {
+				QMap<quint32, QTemporaryFile*>::iterator itr = file_map.begin();
+				itr.value()->remove();
+				delete itr.value();
+				file_map.erase(itr);
+			}	// while
+			file_map[current_id] = tempfileicon;
+		}	// if
   }	// if reply is valid
   
   else
@@ -220,6 +231,21 @@ void NotifyClient::sendNotification ()
   return;
 } 
   
+//
+// Function to return the number of bytes used on disk by the icon files
+// we are holding for notifications still showing
+qint64 NotifyClient::tempFileBytes() const
+{
+	qint64 rtn = 0;
+	QMapIterator<quint32, QTemporaryFile*> itr(file_map);
+	while (itr.hasNext()) {
+		itr.next();
+		rtn += QFileInfo(itr.value()->fileName()).size();
+	}	// while
+	
+	return rtn;
+}
+  
 /////////////////////////////////////// PRIVATE FUNCTIONS////////////////////////////////
 //
 //  Function to get information about the server and write results to data members
@@ -98,6 +98,9 @@ class NotifyClient : public QObject
       void connectToServer();
       void init();
       void sendNotification();                                
+      inline void setMaxFiles(int i) {i_max_files = i;}
+      inline int tempFileCount() const {return file_map.size();}
+      qint64 tempFileBytes() const;
 
     private:
       // members
@@ -117,6 +120,7 @@ class NotifyClient : public QObject
       int i_expire_timeout;
       bool b_overwrite;
       QMap<quint32, QTemporaryFile*> file_map;
+      int i_max_files;
       
       // functions
       void getServerInformation();
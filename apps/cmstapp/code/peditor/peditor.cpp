@@ -33,9 +33,7 @@ DEALINGS IN THE SOFTWARE.
 # include "./code/shared/shared.h"
 # include "./code/trstring/tr_strings.h"
 
-#define DBUS_SERVICE "net.connman"
-
-PropertiesEditor::PropertiesEditor(QWidget* parent, const arrayElement& ae)
+PropertiesEditor::PropertiesEditor(QWidget* parent, const arrayElement& ae, NetConnmanServiceInterface* svc)
     : QDialog(parent)
 {
   // Setup the user interface
@@ -44,6 +42,7 @@ PropertiesEditor::PropertiesEditor(QWidget* parent, const arrayElement& ae)
   // Data members
   objpath = ae.objpath;
   objmap = ae.objmap;
+  iface_serv = svc;
   sl_ipv4_method << "dhcp" << "manual" << "off"; 
 	sl_ipv6_method << "auto" << "manual" << "off";
 	sl_ipv6_privacy << "disabled" << "enabled" << "prefered";	// misspelling prefered is necessary
@@ -83,9 +82,9 @@ PropertiesEditor::PropertiesEditor(QWidget* parent, const arrayElement& ae)
   ipv4map.clear();
   ipv6map.clear();
   proxmap.clear();
-  shared::extractMapData(ipv4map, objmap.value("IPv4.Configuration") );
-  shared::extractMapData(ipv6map, objmap.value("IPv6.Configuration") );
-  shared::extractMapData(proxmap, objmap.value("Proxy.Configuration") );
+  ipv4map = objmap.value("IPv4.Configuration").toMap();
+  ipv6map = objmap.value("IPv6.Configuration").toMap();
+  proxmap = objmap.value("Proxy.Configuration").toMap();
 
   // Seed initial values in the dialog.
   ui.checkBox_autoconnect->setChecked(objmap.value("AutoConnect").toBool() );
@@ -222,7 +221,6 @@ void PropertiesEditor::updateConfiguration()
   QStringList sl;
   QList<QVariant> vlist;
   QMap<QString,QVariant> dict;
-  QDBusInterface* iface_serv = new QDBusInterface(DBUS_SERVICE, objpath.path(), "net.connman.Service", QDBusConnection::systemBus(), this);
   QList<QLineEdit*> lep;
   QStringList slp;
 
@@ -362,7 +360,5 @@ void PropertiesEditor::updateConfiguration()
     shared::processReply(iface_serv->callWithArgumentList(QDBus::AutoDetect, "SetProperty", vlist) );
   } // if proxy changed
 
-  // cleanup
-  iface_serv->deleteLater();
   this->accept();
 }
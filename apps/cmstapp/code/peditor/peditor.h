@@ -45,12 +45,13 @@ class PropertiesEditor : public QDialog
 
   public:
   // members
-    PropertiesEditor(QWidget*, const arrayElement&);
+    PropertiesEditor(QWidget*, const arrayElement&, NetConnmanServiceInterface*);
     
   private:  
   // members
 		Ui::Peditor ui;
 		QDBusObjectPath objpath;
+		NetConnmanServiceInterface* iface_serv;
 		QMap<QString,QVariant> objmap;
 		QMap<QString,QVariant> ipv4map; 
 		QMap<QString,QVariant> ipv6map;
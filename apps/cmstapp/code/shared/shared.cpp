@@ -34,6 +34,7 @@ DEALINGS IN THE SOFTWARE.
 # include "../resource.h"
 # include "./shared.h"
 # include "./code/trstring/tr_strings.h"
+# include "./code/trace/trace.h"
 
 //
 // Function to process the reply from a dbus call.
@@ -53,39 +54,15 @@ QDBusMessage::MessageType shared::processReply(const QDBusMessage& reply)
 }
 
 //
-//  Function to extract the data from a QDBusArgument that contains a map.
-//  Some of the arrayElements can contain a QDBusArgument as the object
-//  instead of a primitive (string, bool, int, etc.). This function
-//  will extract the data from the QDBusArgument and write it into a map.
-//
-//  Return value a bool, true on success, false otherwise.
-//  The map is sent by reference (called r_map here) and is modified by this function.
-//  r_var is a constant reference to the QDBusArgument.
-//
-bool shared::extractMapData(QMap<QString,QVariant>& r_map, const QVariant& r_var)
+//  Function to wait for a pending call made through one of the generated
+//  proxies and then process its reply as above.
+QDBusMessage::MessageType shared::processReply(QDBusPendingCall call)
 {
-  //  make sure we can convert the QVariant into a QDBusArgument
-  if (! r_var.canConvert<QDBusArgument>() ) return false;
-  const QDBusArgument qdba =  r_var.value<QDBusArgument>();
-
-  // make sure the QDBusArgument holds a map
-  if (qdba.currentType() != QDBusArgument::MapType ) return false;
-
-  // iterate over the QDBusArgument pulling map keys and values out
-    r_map.clear();
-    qdba.beginMap();
-
-    while ( ! qdba.atEnd() ) {
-      QString key;
-      QVariant value;
-      qdba.beginMapEntry();
-      qdba >> key >> value;
-      qdba.endMapEntry();
-      r_map.insert(key, value);
-    } // while
-
-    qdba.endMap();
-    return true;
+  CMST_TRACE("wait for reply", "dbus");
+
+  call.waitForFinished();
+
+  return processReply(call.reply() );
 }
 
 //
@@ -31,6 +31,7 @@ DEALINGS IN THE SOFTWARE.
 # include <QMessageBox>
 # include <QtDBus/QDBusMessage>
 # include <QtDBus/QDBusArgument>
+# include <QtDBus/QDBusPendingCall>
 # include <QString>
 # include <QVariant>
 # include <QDialogButtonBox>
@@ -38,6 +39,8 @@ DEALINGS IN THE SOFTWARE.
 # include <QLabel>
 # include <QPushButton>
 
+# include "./code/shared/sharedcore.h"
+
 namespace shared {
 //
 // Class for an QInputDialog knockoff with validator
@@ -67,7 +70,7 @@ class ValidatingDialog : public QDialog
 };
 
 QDBusMessage::MessageType processReply(const QDBusMessage& reply);
-bool extractMapData(QMap<QString,QVariant>&,const QVariant&);
+QDBusMessage::MessageType processReply(QDBusPendingCall call);
 
 }
 #endif
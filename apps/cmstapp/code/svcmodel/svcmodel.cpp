@@ -0,0 +1,378 @@
+/**************************** svcmodel.cpp ****************************
+
+Table model and item delegate used to display the wifi and vpn
+services.  The model is synced against the services list and only
+reports the rows that actually changed, the delegate paints the icons
+and the signal strength bar directly instead of using cell widgets.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QApplication>
+# include <QCoreApplication>
+# include <QStyle>
+# include <QStyleOptionProgressBar>
+# include <QPainter>
+# include <QFileInfo>
+# include <QStringList>
+
+# include "./svcmodel.h"
+# include "./code/trstring/tr_strings.h"
+# include "../shared/shared.h"
+
+//  Column headers.  These used to be defined in the ui file so keep the
+//  ControlBox context, that way the existing translations still apply.
+static const char* wifi_headers[] = {
+  QT_TRANSLATE_NOOP("ControlBox", "Name"),
+  QT_TRANSLATE_NOOP("ControlBox", "Favorite"),
+  QT_TRANSLATE_NOOP("ControlBox", "Connected"),
+  QT_TRANSLATE_NOOP("ControlBox", "Security"),
+  QT_TRANSLATE_NOOP("ControlBox", "Signal Strength")
+};
+
+static const char* vpn_headers[] = {
+  QT_TRANSLATE_NOOP("ControlBox", "Name"),
+  QT_TRANSLATE_NOOP("ControlBox", "Type"),
+  QT_TRANSLATE_NOOP("ControlBox", "State"),
+  QT_TRANSLATE_NOOP("ControlBox", "Host"),
+  QT_TRANSLATE_NOOP("ControlBox", "Connection")
+};
+
+// Constructor.  svctype is the connman service type this model will
+// display, "wifi" or "vpn".
+ServiceModel::ServiceModel(const QString& svctype, IconManager* im, QObject* parent) : QAbstractTableModel(parent)
+{
+  svc_type = svctype;
+  svc_rectype = Conn::typeValue(svctype);
+  iconman = im;
+  rows.clear();
+  pixmaps.clear();
+  pending.clear();
+}
+
+////////////////////////////// Public Functions ////////////////////////////
+//
+// Function to return the number of rows in the model
+int ServiceModel::rowCount(const QModelIndex& parent) const
+{
+  if (parent.isValid() ) return 0;
+
+  return rows.size();
+}
+
+//
+// Function to return the number of columns in the model.  Both the wifi
+// and the vpn tables have five columns.
+int ServiceModel::columnCount(const QModelIndex& parent) const
+{
+  if (parent.isValid() ) return 0;
+
+  return 5;
+}
+
+//
+// Function to return the data for a cell
+QVariant ServiceModel::data(const QModelIndex& index, int role) const
+{
+  if (! index.isValid() || index.row() >= rows.size() ) return QVariant();
+  if (role == Qt::TextAlignmentRole) return int(Qt::AlignCenter);
+
+  const ModelRow& mr = rows.at(index.row() );
+  const QMap<QString,QVariant>& map = mr.ae.objmap;
+  const objectRecord& rec = mr.ae.rec;
+
+  // wifi table
+  if (svc_rectype == Conn::TypeWifi) {
+    switch (index.column() ) {
+      case 0:
+        if (role == Qt::DisplayRole) return shared::nickName(mr.ae);
+        break;
+      case 1:
+        if (role == Qt::DecorationRole && rec.is(Conn::Favorite) ) return pixmap("favorite");
+        break;
+      case 2:
+        if (role == BusyRole) return pending.contains(mr.ae.objpath.path() );
+        if (role == BusyTextRole) return pending.value(mr.ae.objpath.path() );
+        if (role == Qt::DecorationRole && ! pending.contains(mr.ae.objpath.path()) ) {
+          if (rec.state == Conn::StateOnline) return pixmap("state_online");
+          if (rec.state == Conn::StateReady) return pixmap("state_ready");
+          return pixmap("wifi_tab_state_not_ready");
+        } // if decoration
+        if (role == Qt::ToolTipRole) return TranslateStrings::cmtr(Conn::stateName(rec.state) );
+        break;
+      case 3:
+        if (role == Qt::DisplayRole) {
+          QStringList sl_tr;
+          for (int i = 0; i < map.value("Security").toStringList().size(); ++i) {
+            sl_tr << TranslateStrings::cmtr(map.value("Security").toStringList().at(i) );
+          } // for
+          return sl_tr.join(',');
+        } // if display
+        break;
+      case 4:
+        if (role == StrengthRole) return int(rec.strength);
+        break;
+      default:
+        break;
+    } // switch
+  } // if wifi
+
+  // vpn table
+  else {
+    switch (index.column() ) {
+      case 0:
+        if (role == Qt::DisplayRole) return shared::nickName(mr.ae);
+        break;
+      case 1:
+        if (role == Qt::DisplayRole) return TranslateStrings::cmtr(mr.provider.value("Type").toString() );
+        break;
+      case 2:
+        if (role == BusyRole) return (rec.state == Conn::StateAssociation || pending.contains(mr.ae.objpath.path()) );
+        if (role == BusyTextRole) return pending.value(mr.ae.objpath.path() );
+        if (role == Qt::DecorationRole && rec.state != Conn::StateAssociation && ! pending.contains(mr.ae.objpath.path()) ) {
+          if (rec.state == Conn::StateReady) return pixmap("state_vpn_connected");
+          return pixmap("state_not_ready");
+        } // if decoration
+        if (role == Qt::ToolTipRole) return TranslateStrings::cmtr(Conn::stateName(rec.state) );
+        break;
+      case 3:
+        if (role == Qt::DisplayRole) return mr.provider.value("Host").toString();
+        break;
+      case 4:
+        if (role == Qt::DisplayRole) return QFileInfo(mr.ae.objpath.path()).baseName();
+        break;
+      default:
+        break;
+    } // switch
+  } // else vpn
+
+  return QVariant();
+}
+
+//
+// Function to return the column headers
+QVariant ServiceModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QVariant();
+  if (section < 0 || section >= columnCount() ) return QVariant();
+
+  if (svc_rectype == Conn::TypeWifi) return QCoreApplication::translate("ControlBox", wifi_headers[section]);
+
+  return QCoreApplication::translate("ControlBox", vpn_headers[section]);
+}
+
+//
+// Function to bring the model in line with the services list.  Only the
+// services of our type are looked at.  The rows are brought into the new
+// order with an edit script so only rows that are gone, new, or out of
+// order are removed, inserted or moved.  Rows whose properties changed
+// then report a change.  Views keep their selection and scroll position
+// through all of this.
+void ServiceModel::sync(const ObjectStore& services)
+{
+  // the rows we should end up with, in order
+  QList<const arrayElement*> target;
+  QStringList after;
+  QHash<QString,const arrayElement*> bypath;
+  for (int i = 0; i < services.count(); ++i) {
+    if (services.at(i).rec.type != svc_rectype) continue;
+    target.append(&services.at(i) );
+    after.append(services.at(i).objpath.path() );
+    bypath.insert(after.last(), target.last() );
+  } // for
+
+  QStringList before;
+  for (int row = 0; row < rows.size(); ++row) {
+    before.append(rows.at(row).ae.objpath.path() );
+  } // for
+
+  // put the rows in order
+  const QList<storeEdit> script = ObjectStore::editScript(before, after);
+  for (int i = 0; i < script.size(); ++i) {
+    const storeEdit& edit = script.at(i);
+    switch (edit.op) {
+      case storeEdit::Remove:
+        beginRemoveRows(QModelIndex(), edit.from, edit.from);
+        rows.removeAt(edit.from);
+        endRemoveRows();
+        break;
+      case storeEdit::Insert: {
+        ModelRow mr;
+        setRow(mr, *bypath.value(edit.key) );
+        beginInsertRows(QModelIndex(), edit.to, edit.to);
+        rows.insert(edit.to, mr);
+        endInsertRows();
+        } break;
+      case storeEdit::Move:
+        // the destination of beginMoveRows is the row before the move
+        beginMoveRows(QModelIndex(), edit.from, edit.from, QModelIndex(), edit.to > edit.from ? edit.to + 1 : edit.to);
+        rows.move(edit.from, edit.to);
+        endMoveRows();
+        break;
+      default:
+        break;
+    } // switch
+  } // for
+
+  // update rows whose generation moved on since they were set
+  for (int i = 0; i < target.size(); ++i) {
+    if (rows.at(i).ae.gen == target.at(i)->gen) continue;
+    setRow(rows[i], *target.at(i) );
+    emit dataChanged(index(i, 0), index(i, columnCount() - 1) );
+  } // for
+
+  return;
+}
+
+//
+// Function to drop the cached pixmaps, called when the icon color or theme
+// changes.  All the icon cells need to be repainted.
+void ServiceModel::refreshIcons()
+{
+  pixmaps.clear();
+  if (rows.isEmpty() ) return;
+
+  emit dataChanged(index(0, 0), index(rows.size() - 1, columnCount() - 1) );
+
+  return;
+}
+
+//
+// Function to return the bytes held by the cached pixmaps
+qint64 ServiceModel::pixmapBytes() const
+{
+  qint64 rtn = 0;
+  QHash<QString,QPixmap>::const_iterator itr = pixmaps.constBegin();
+  for (; itr != pixmaps.constEnd(); ++itr) {
+    rtn += qint64(itr.value().width()) * itr.value().height() * itr.value().depth() / 8;
+  } // for
+
+  return rtn;
+}
+
+//
+// Function to mark a service as having a call to connman in progress.
+// path is the object path of the service, text is shown in the busy bar
+// of the state column.  An empty text clears the mark.
+void ServiceModel::setPending(const QString& path, const QString& text)
+{
+  if (text == pending.value(path) ) return;
+  if (text.isEmpty() ) pending.remove(path);
+  else pending.insert(path, text);
+
+  for (int row = 0; row < rows.size(); ++row) {
+    if (rows.at(row).ae.objpath.path() != path) continue;
+    emit dataChanged(index(row, 2), index(row, 2) );
+    break;
+  } // for
+
+  return;
+}
+
+////////////////////////////// Private Functions ////////////////////////////
+//
+// Function to copy an arrayElement into a row.  For vpn services the
+// provider dict is extracted here so data() does not need to do it
+// every time a cell is painted.
+void ServiceModel::setRow(ModelRow& mr, const arrayElement& ae)
+{
+  mr.ae = ae;
+  mr.provider.clear();
+  if (svc_rectype == Conn::TypeVpn) mr.provider = ae.objmap.value("Provider").toMap();
+
+  return;
+}
+
+//
+// Function to return a 16x16 pixmap of the named icon.  Pixmaps are
+// cached since the same few icons are used on every row.
+QPixmap ServiceModel::pixmap(const QString& name) const
+{
+  QHash<QString,QPixmap>::const_iterator itr = pixmaps.constFind(name);
+  if (itr != pixmaps.constEnd() ) return itr.value();
+
+  QPixmap pm = iconman->getIcon(name).pixmap(QSize(16,16) );
+  pixmaps.insert(name, pm);
+
+  return pm;
+}
+
+//
+// Constructor
+ServiceDelegate::ServiceDelegate(QObject* parent) : QStyledItemDelegate(parent)
+{
+  highlight = QColor();
+}
+
+//
+// Function to paint a cell.  Text cells are left to the base class, icon
+// cells get the icon centered, and the strength and connecting cells get
+// a progress bar drawn with the current style.
+void ServiceDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+  QVariant strength = index.data(ServiceModel::StrengthRole);
+  bool busy = index.data(ServiceModel::BusyRole).toBool();
+  QPixmap pm = qvariant_cast<QPixmap>(index.data(Qt::DecorationRole) );
+
+  if (! strength.isValid() && ! busy && pm.isNull() ) {
+    QStyledItemDelegate::paint(painter, option, index);
+    return;
+  }
+
+  QStyleOptionViewItem opt(option);
+  initStyleOption(&opt, index);
+  const QWidget* widget = option.widget;
+  QStyle* style = widget ? widget->style() : QApplication::style();
+
+  // cell background (selection, alternating rows)
+  style->drawPrimitive(QStyle::PE_PanelItemViewItem, &opt, painter, widget);
+
+  // progress bar, use the same margins the cell widget layout used to have
+  if (strength.isValid() || busy) {
+    QStyleOptionProgressBar pbo;
+    pbo.rect = option.rect.adjusted(7, 5, -11, -5);
+    pbo.state = option.state | QStyle::State_Horizontal;
+    pbo.direction = option.direction;
+    pbo.fontMetrics = option.fontMetrics;
+    pbo.palette = option.palette;
+    pbo.minimum = 0;
+    pbo.maximum = busy ? 0 : 100;
+    pbo.progress = busy ? 0 : strength.toInt();
+    pbo.textVisible = true;
+    pbo.textAlignment = Qt::AlignCenter;
+    if (busy) {
+      pbo.text = index.data(ServiceModel::BusyTextRole).toString();
+      if (pbo.text.isEmpty() ) pbo.text = tr("Connecting");
+    }
+    else pbo.text = QString("%1%").arg(pbo.progress);
+    if (highlight.isValid() ) pbo.palette.setColor(QPalette::Active, QPalette::Highlight, highlight);
+    style->drawControl(QStyle::CE_ProgressBar, &pbo, painter, widget);
+  } // if progress bar
+
+  // icon only cell
+  else {
+    style->drawItemPixmap(painter, option.rect, Qt::AlignCenter, pm);
+  } // else
+
+  return;
+}
@@ -0,0 +1,111 @@
+/**************************** svcmodel.h ******************************
+
+Table model and item delegate used to display the wifi and vpn
+services.  The model is synced against the services list and only
+reports the rows that actually changed, the delegate paints the icons
+and the signal strength bar directly instead of using cell widgets.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef SERVICE_MODEL
+# define SERVICE_MODEL
+
+# include <QAbstractTableModel>
+# include <QStyledItemDelegate>
+# include <QString>
+# include <QList>
+# include <QHash>
+# include <QPixmap>
+# include <QColor>
+# include <QVariant>
+
+# include "./code/objstore/objstore.h"
+# include "../iconman/iconman.h"
+
+//
+//  Table model holding the services of a single type ("wifi" or "vpn")
+//  in the order they appear in the services list.
+class ServiceModel : public QAbstractTableModel
+{
+  Q_OBJECT
+
+  public:
+    ServiceModel(const QString&, IconManager*, QObject* parent = 0);
+
+    // custom roles used by ServiceDelegate
+    enum {
+      StrengthRole  = Qt::UserRole + 1,   // int 0 - 100, paint a strength bar
+      BusyRole      = Qt::UserRole + 2,   // bool, paint a connecting bar
+      BusyTextRole  = Qt::UserRole + 3,   // QString, text for the connecting bar
+    };
+
+  // functions
+    int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const;
+    QVariant data(const QModelIndex&, int role = Qt::DisplayRole) const;
+    QVariant headerData(int, Qt::Orientation, int role = Qt::DisplayRole) const;
+    void sync(const ObjectStore&);
+    void refreshIcons();
+    void setPending(const QString&, const QString& = QString() );
+    inline const arrayElement& at(int row) const {return rows.at(row).ae;}
+    inline int pixmapCount() const {return pixmaps.size();}
+    qint64 pixmapBytes() const;
+
+  private:
+    // one row of the table, provider is extracted once when the row is set
+    struct ModelRow
+    {
+      arrayElement ae;
+      QMap<QString,QVariant> provider;
+    };
+
+  // members
+    QString svc_type;
+    int svc_rectype;
+    IconManager* iconman;
+    QList<ModelRow> rows;
+    mutable QHash<QString,QPixmap> pixmaps;
+    QHash<QString,QString> pending;
+
+  // functions
+    void setRow(ModelRow&, const arrayElement&);
+    QPixmap pixmap(const QString&) const;
+};
+
+//
+//  Delegate to paint the icon and strength bar cells of a ServiceModel
+class ServiceDelegate : public QStyledItemDelegate
+{
+  Q_OBJECT
+
+  public:
+    ServiceDelegate(QObject* parent = 0);
+    void paint(QPainter*, const QStyleOptionViewItem&, const QModelIndex&) const;
+    inline void setHighlight(const QColor& col) {highlight = col;}
+
+  private:
+    QColor highlight;
+};
+
+# endif
@@ -37,6 +37,8 @@ DEALINGS IN THE SOFTWARE.
 #	include "./vpnagent.h"
 # include "../resource.h"	
 # include "./code/trstring/tr_strings.h"
+# include "./code/shared/shared.h"
+# include "./code/trace/trace.h"
 
 //	header files generated by qmake from the xml file created by qdbuscpp2xml
 # include "./vpnagent_adaptor.h"
@@ -57,7 +59,7 @@ ConnmanVPNAgent::ConnmanVPNAgent(QObject* parent)
 	
 	//	Create Adaptor and register this Agent on the system bus.  
 	new VPNAgentAdaptor(this);
-	QDBusConnection::systemBus().registerObject(VPN_AGENT_OBJECT, this);
+	shared::connmanBus().registerObject(VPN_AGENT_OBJECT, this);
 	
 	return;
 }
@@ -94,6 +96,7 @@ void ConnmanVPNAgent::ReportError(QDBusObjectPath path, QString s_error)
 // A dialog is displayed with the required fields enabled (non-required fields are disabled).
 QVariantMap ConnmanVPNAgent::RequestInput(QDBusObjectPath path, QMap<QString,QVariant> dict)
 {
+	CMST_TRACE("ConnmanVPNAgent::RequestInput", "agent");
 	(void) path;
 	
 	// Take the dict returned by DBus and extract the information we are interested in and place in input_map.
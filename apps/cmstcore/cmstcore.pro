@@ -0,0 +1,61 @@
+#  We need the qt libraries, we want compiler warnings on, and this is a release version of the program  
+CONFIG += qt
+CONFIG += warn_on
+CONFIG += release
+CONFIG += nostrip 
+CONFIG += c++11
+CONFIG += staticlib
+
+#  No widgets (or gui) here, the core must run under a QCoreApplication
+QT -= gui
+QT += dbus
+QT += network
+QT += core
+
+# cmst variables
+include(../../cmst.pri)
+
+TEMPLATE = lib
+TARGET = cmstcore
+
+# dbus
+DBUS_ADAPTORS 	+= ./code/counter/org.monkey_business_enterprises.counter.xml
+DBUS_INTERFACES	+= ./code/counter/org.monkey_business_enterprises.counter.xml
+DBUS_INTERFACES	+= ./code/proxy/net.connman.manager.xml
+DBUS_INTERFACES	+= ./code/proxy/net.connman.service.xml
+DBUS_INTERFACES	+= ./code/proxy/net.connman.technology.xml
+DBUS_INTERFACES	+= ./code/proxy/net.connman.vpnmanager.xml
+
+#	header files
+HEADERS		+= ../resource.h
+HEADERS		+= ./code/counter/counter.h
+HEADERS		+= ./code/trstring/tr_strings.h
+HEADERS		+= ./code/shared/sharedcore.h
+HEADERS		+= ./code/objstore/objstore.h
+HEADERS		+= ./code/ingest/ingest.h
+HEADERS		+= ./code/proxy/proxypool.h
+HEADERS		+= ./code/trace/trace.h
+HEADERS		+= ./code/stats/busstats.h
+HEADERS		+= ./code/watchdog/watchdog.h
+HEADERS		+= ./code/memstats/memstats.h
+HEADERS		+= ./code/metrics/metrics.h
+
+#	sources
+SOURCES += ./code/counter/counter.cpp
+SOURCES	+= ./code/trstring/tr_strings.cpp
+SOURCES += ./code/shared/sharedcore.cpp
+SOURCES += ./code/objstore/objstore.cpp
+SOURCES += ./code/ingest/ingest.cpp
+SOURCES += ./code/proxy/proxypool.cpp
+SOURCES += ./code/trace/trace.cpp
+SOURCES += ./code/stats/busstats.cpp
+SOURCES += ./code/watchdog/watchdog.cpp
+SOURCES += ./code/memstats/memstats.cpp
+SOURCES += ./code/metrics/metrics.cpp
+
+##  Place all object files in their own directory and moc files in their own directory
+##  This is not necessary but keeps things cleaner.
+OBJECTS_DIR = ./object_files
+MOC_DIR = ./moc_files
+
+sources.files = $$SOURCES $$HEADERS *.pro
@@ -31,6 +31,10 @@ DEALINGS IN THE SOFTWARE.
 
 # include "./counter.h"
 # include "../resource.h" 
+# include "../shared/sharedcore.h"
+# include "../stats/busstats.h"
+# include "../memstats/memstats.h"
+# include "../metrics/metrics.h"
 
 //  header files generated by qmake from the xml file created by qdbuscpp2xml
 # include "counter_adaptor.h"
@@ -48,7 +52,7 @@ ConnmanCounter::ConnmanCounter(QObject* parent)
   new CounterAdaptor(this);
   
 	// Try to register an object on the system bus
-	QDBusConnection::systemBus().registerObject(CNTR_OBJECT, this);
+	shared::connmanBus().registerObject(CNTR_OBJECT, this);
 	
 }
 
@@ -135,6 +139,13 @@ QString ConnmanCounter::getLabel(const QVariantMap& map)
 }
 
 /////////////////////////////////////// PUBLIC Q_SLOTS////////////////////////////////
+//
+//  Function to return an estimate of the bytes held by the counter data
+qint64 ConnmanCounter::memoryUsage() const
+{
+  return MemStats::bytes(home_data) + MemStats::bytes(roam_data);
+}
+
 //
 // Called when the service daemon unregisters the counter.  QT deals with cleanup
 // tasks so don't need much here
@@ -149,6 +160,8 @@ void ConnmanCounter::Release()
 //  Called when there is a change in counter values
 void ConnmanCounter::Usage(QDBusObjectPath qdb_objpath, QVariantMap home, QVariantMap roaming)
 {
+  BusStatsTimer stats_timer(BusStats::CounterUsage, qdb_objpath.path() );
+
   // First time through connman will send home and roaming fully loaded.  After that only
   // items that change are sent.  We need to keep the data as a class member
   QMapIterator<QString, QVariant> i(home);
@@ -163,6 +176,8 @@ void ConnmanCounter::Usage(QDBusObjectPath qdb_objpath, QVariantMap home, QVaria
     roam_data[j.key()] = j.value();
     }    
   
+  Metrics::counterUsage(qdb_objpath.path(), home, roaming);
+
   // Emit signal with object and labels to display
   emit usageUpdated(qdb_objpath, getLabel(home_data), getLabel(roam_data) );
 
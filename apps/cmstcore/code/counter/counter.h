@@ -48,6 +48,8 @@ class ConnmanCounter : public QObject
     public:
 			ConnmanCounter(QObject*);
 			QString getLabel(const QVariantMap&);
+			qint64 memoryUsage() const;
+			inline int entries() const {return home_data.size() + roam_data.size();}
 			inline int cnxns() {return receivers(SIGNAL(usageUpdated(const QDBusObjectPath&, const QString&, const QString&)));}
 							
 		signals:
@@ -0,0 +1,331 @@
+/**************************** ingest.cpp ******************************
+
+Class to read the connman service, technology and peer objects off the
+system bus in a thread of its own.  The objects are published to the GUI
+thread as snapshots that are never changed once published.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include "./ingest.h"
+# include "../resource.h"
+# include "../shared/sharedcore.h"
+# include "../trace/trace.h"
+# include "../stats/busstats.h"
+# include "../metrics/metrics.h"
+
+# include <QTimer>
+
+# define DBUS_PATH "/"
+# define DBUS_CON_SERVICE "net.connman"
+# define DBUS_CON_MANAGER "net.connman.Manager"
+
+//  Name of our private connection to the system bus
+# define INGEST_CONNECTION "cmst_ingest"
+
+// Constructor.  The bus is not opened until start() runs in our thread.
+Ingest::Ingest() : QObject(0),
+  bus(QString())
+{
+  services_changed = 0;
+  metrics_services = 0;
+  metrics_technologies = 0;
+  notify_pending = 0;
+  current = std::make_shared<const StateSnapshot>();
+
+  // a child, so it moves to our thread with us
+  publish_timer = new QTimer(this);
+  publish_timer->setSingleShot(true);
+  publish_timer->setInterval(0);
+  connect(publish_timer, SIGNAL(timeout()), this, SLOT(publishSnapshot()));
+}
+
+////////////////////////////// Public Functions ////////////////////////////
+//
+// Function to return the latest snapshot, called from the GUI thread.
+// Clears the pending flag first so a snapshot published while the caller
+// is working on this one signals again.
+std::shared_ptr<const StateSnapshot> Ingest::take()
+{
+  notify_pending.storeRelease(0);
+
+  return std::atomic_load(&current);
+}
+
+//
+// Function to return the error replies received by the last rescan().
+// Only call after rescan() has returned.
+QList<QDBusMessage> Ingest::rescanErrors() const
+{
+  return rescan_errors;
+}
+
+////////////////////////////// Public Slots ////////////////////////////////
+//
+// Slot to open our connection to the system bus and subscribe to the
+// connman signals.  Subscribe before the first rescan() so no change can
+// slip in between.  Return false if the bus could not be opened.
+bool Ingest::start()
+{
+  Trace::setThreadName("ingest");
+  bus = shared::connectConnmanBus(INGEST_CONNECTION);
+  if (! bus.isConnected() ) return false;
+
+  // One subscription each for all the service and technology objects (empty path
+  // matches any object).  The slots look the object up by msg.path().
+  bus.connect(DBUS_CON_SERVICE, QString(), "net.connman.Service", "PropertyChanged", this, SLOT(dbsServicePropertyChanged(QString, QDBusVariant, QDBusMessage)));
+  bus.connect(DBUS_CON_SERVICE, QString(), "net.connman.Technology", "PropertyChanged", this, SLOT(dbsTechnologyPropertyChanged(QString, QDBusVariant, QDBusMessage)));
+  bus.connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "PropertyChanged", this, SLOT(dbsManagerPropertyChanged(QString, QDBusVariant, QDBusMessage)));
+  bus.connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "ServicesChanged", this, SLOT(dbsServicesChanged(QList<QVariant>, QList<QDBusObjectPath>, QDBusMessage)));
+  bus.connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "PeersChanged", this, SLOT(dbsPeersChanged(QList<QVariant>, QList<QDBusObjectPath>, QDBusMessage)));
+  bus.connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "TechnologyAdded", this, SLOT(dbsTechnologyAdded(QDBusObjectPath, QVariantMap)));
+  bus.connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "TechnologyRemoved", this, SLOT(dbsTechnologyRemoved(QDBusObjectPath)));
+
+  return true;
+}
+
+//
+// Slot to read the manager properties and the technologies and services
+// lists from connman.  srv is an OR of CMST::Manager_Properties,
+// CMST::Manager_Technologies and CMST::Manager_Services.  The replies are
+// read straight into our stores and a snapshot is published.  Return
+// value is an OR of CMST::Err_Properties, CMST::Err_Technologies and
+// CMST::Err_Services for what could not be read, error replies are kept
+// for rescanErrors() since we can't show them from this thread.
+int Ingest::rescan(int srv)
+{
+  int errs = 0;
+  rescan_errors.clear();
+
+  if (srv & CMST::Manager_Properties) {
+    CMST_TRACE("GetProperties", "dbus");
+    const qint64 ts = Trace::now();
+    QDBusMessage reply = bus.call(QDBusMessage::createMethodCall(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "GetProperties") );
+    BusStats::call("GetProperties", Trace::now() - ts);
+    if (reply.type() != QDBusMessage::ReplyMessage) rescan_errors.append(reply);
+    properties.clear();
+    if (! shared::getMap(properties, reply) ) errs |= CMST::Err_Properties;
+  } // if properties
+
+  if (srv & CMST::Manager_Technologies) {
+    CMST_TRACE("GetTechnologies", "dbus");
+    const qint64 ts = Trace::now();
+    QDBusMessage reply = bus.call(QDBusMessage::createMethodCall(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "GetTechnologies") );
+    BusStats::call("GetTechnologies", Trace::now() - ts);
+    if (reply.type() != QDBusMessage::ReplyMessage) rescan_errors.append(reply);
+    if (! technologies.merge(reply.arguments().value(0), true) ) {
+      technologies.clear();
+      errs |= CMST::Err_Technologies;
+    } // if
+  } // if technologies
+
+  if (srv & CMST::Manager_Services) {
+    CMST_TRACE("GetServices", "dbus");
+    const qint64 ts = Trace::now();
+    QDBusMessage reply = bus.call(QDBusMessage::createMethodCall(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "GetServices") );
+    BusStats::call("GetServices", Trace::now() - ts);
+    if (reply.type() != QDBusMessage::ReplyMessage) rescan_errors.append(reply);
+    if (! services.merge(reply.arguments().value(0), true) ) {
+      services.clear();
+      errs |= CMST::Err_Services;
+    } // if
+  } // if services
+
+  this->publishSnapshot();
+
+  return errs;
+}
+
+////////////////////////////// Private Functions ////////////////////////////
+//
+// Function to ask for a snapshot once the signals already waiting in our
+// event queue have been read.  A burst of signals is read into the stores
+// one after the other and published once.
+void Ingest::publish()
+{
+  if (! publish_timer->isActive() ) publish_timer->start();
+
+  return;
+}
+
+////////////////////////////// Private Slots ////////////////////////////////
+//
+// Slot to publish the current state of our stores.  Copying a store only
+// copies references to its data, the data itself is copied the next time
+// we change the store, which is why this is not done for every signal.
+// snapshotReady() is only emitted if the GUI has taken the previous
+// snapshot, so a burst of signals costs the GUI a single update.
+void Ingest::publishSnapshot()
+{
+  CMST_TRACE("publish", "signal");
+
+  publish_timer->stop();
+
+  std::shared_ptr<StateSnapshot> snap = std::make_shared<StateSnapshot>();
+  snap->properties = properties;
+  snap->services = services;
+  snap->technologies = technologies;
+  snap->peers = peers;
+  snap->services_changed = services_changed;
+  std::atomic_store(&current, std::shared_ptr<const StateSnapshot>(snap) );
+
+  // the metrics are kept up to date from here, off the GUI thread.  Only
+  // look at a store if it changed since the metrics last saw it.
+  Metrics::setManagerState(properties.value("State").toString(), properties.value("OfflineMode").toBool() );
+  if (services.generation() != metrics_services) {
+    Metrics::setServices(services);
+    metrics_services = services.generation();
+  } // if
+  if (technologies.generation() != metrics_technologies) {
+    Metrics::setTechnologies(technologies);
+    metrics_technologies = technologies.generation();
+  } // if
+
+  if (notify_pending.testAndSetOrdered(0, 1) ) emit snapshotReady();
+
+  return;
+}
+
+//
+// Slot called whenever DBUS issues a PropertyChanged signal for the
+// connman manager.  The properties travel in the same snapshot as the
+// objects so the GUI never sees a State that its services list has not
+// caught up with.
+void Ingest::dbsManagerPropertyChanged(QString prop, QDBusVariant dbvalue, QDBusMessage msg)
+{
+  CMST_TRACE("dbsManagerPropertyChanged", "signal");
+  BusStatsTimer stats_timer(BusStats::ManagerPropertyChanged, msg.path());
+
+  properties.insert(prop, dbvalue.variant() );
+  this->publish();
+
+  return;
+}
+
+//
+// Slot called whenever DBUS issues a ServicesChanged signal.  When a
+// Scan method is called on a technology the results of that scan are
+// signaled through this slot.  This is also called when the sort order
+// of the services list changes.  It will not be called when a property
+// of a service object changes.
+void Ingest::dbsServicesChanged(QList<QVariant> vlist, QList<QDBusObjectPath> removed, QDBusMessage msg)
+{
+  CMST_TRACE("dbsServicesChanged", "signal");
+  BusStatsTimer stats_timer(BusStats::ServicesChanged, msg.path());
+
+  // process removed services
+  if (! removed.isEmpty() ) services.remove(removed);
+
+  // process added or changed servcies
+  // Demarshall the raw QDBusMessage instead of vlist, the changed properties
+  // are written straight into services.  The list is in the new order
+  // and services without changes carry no properties.
+  if (! vlist.isEmpty() ) services.merge(msg.arguments().value(0) );
+
+  ++services_changed;
+  this->publish();
+
+  return;
+}
+
+//
+// Slot called whenever DBUS issues a Peerschanged signal.  See note above about
+// scan results being signaled here.
+void Ingest::dbsPeersChanged(QList<QVariant> vlist, QList<QDBusObjectPath> removed, QDBusMessage msg)
+{
+  CMST_TRACE("dbsPeersChanged", "signal");
+  BusStatsTimer stats_timer(BusStats::PeersChanged, msg.path());
+
+  if (! vlist.isEmpty() ) peers.merge(msg.arguments().value(0) );
+  if (! removed.isEmpty() ) peers.remove(removed);
+
+  this->publish();
+
+  return;
+}
+
+//
+// Slot called whenever DBUS issues a TechonlogyAdded signal
+// There must be an internal counter for technologies, first time a
+// technology is changed we get a signal even if we've already run
+// getTechnologies.  After that first time we never get this signal.
+// Use this this to catch real additions, which we defined as something
+// we don't already have from getTechnologies.
+void Ingest::dbsTechnologyAdded(QDBusObjectPath path, QVariantMap properties)
+{
+  CMST_TRACE("dbsTechnologyAdded", "signal");
+  BusStatsTimer stats_timer(BusStats::TechnologyAdded, path.path());
+
+  arrayElement ae;
+  ae.objpath = path;
+  ae.objmap = properties;
+
+  // first see if the element exists, if so replace it, otherwise add it
+  int row = technologies.indexOf(path);
+  if (row >= 0)
+    technologies.replace(row, ae);
+  else
+    technologies.append(ae);
+
+  this->publish();
+
+  return;
+}
+
+//
+//  Slot called whenever DBUS issues a TechonlogyRemoved signal
+void Ingest::dbsTechnologyRemoved(QDBusObjectPath removed)
+{
+  CMST_TRACE("dbsTechnologyRemoved", "signal");
+  BusStatsTimer stats_timer(BusStats::TechnologyRemoved, removed.path());
+
+  if (technologies.remove(removed) ) this->publish();
+
+  return;
+}
+
+//
+//  Slot called whenever a service object issues a PropertyChanged signal on DBUS.
+//  We receive the signal for every service, ignore any we are not (yet)
+//  tracking, they will be in full in the next ServicesChanged.
+void Ingest::dbsServicePropertyChanged(QString property, QDBusVariant dbvalue, QDBusMessage msg)
+{
+  CMST_TRACE("dbsServicePropertyChanged", "signal");
+  BusStatsTimer stats_timer(BusStats::ServicePropertyChanged, msg.path());
+
+  if (services.setProperty(msg.path(), property, dbvalue.variant()) ) this->publish();
+
+  return;
+}
+
+//
+//  Slot called whenever a technology object issues a PropertyChanged signal on DBUS
+void Ingest::dbsTechnologyPropertyChanged(QString name, QDBusVariant dbvalue, QDBusMessage msg)
+{
+  CMST_TRACE("dbsTechnologyPropertyChanged", "signal");
+  BusStatsTimer stats_timer(BusStats::TechnologyPropertyChanged, msg.path());
+
+  if (technologies.setProperty(msg.path(), name, dbvalue.variant()) ) this->publish();
+
+  return;
+}
@@ -0,0 +1,115 @@
+/**************************** ingest.h ********************************
+
+Class to read the connman service, technology and peer objects off the
+system bus in a thread of its own.  The objects are published to the GUI
+thread as snapshots that are never changed once published.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef CONNMAN_INGEST
+# define CONNMAN_INGEST
+
+# include <QObject>
+# include <QString>
+# include <QList>
+# include <QMap>
+# include <QVariant>
+# include <QAtomicInt>
+# include <QtDBus/QDBusConnection>
+# include <QtDBus/QDBusMessage>
+# include <QtDBus/QDBusObjectPath>
+# include <QtDBus/QDBusVariant>
+
+# include <memory>
+
+class QTimer;
+
+# include "../objstore/objstore.h"
+
+//
+//  One consistent view of the connman manager and objects.  A snapshot is
+//  never changed after it is published, the stores in it share their data
+//  with the stores in Ingest until Ingest changes them.
+struct StateSnapshot
+{
+  QMap<QString,QVariant> properties;   // connman.Manager properties
+  ObjectStore services;
+  ObjectStore technologies;
+  ObjectStore peers;
+  quint32 services_changed;   // number of ServicesChanged signals read
+};
+
+//
+//  Reads connman signals and replies on its own connection to the system
+//  bus.  Create it without a parent, move it to a QThread and call start()
+//  and rescan() through a BlockingQueuedConnection.  The changes read in
+//  one pass of the event loop produce a new snapshot, snapshotReady() is
+//  emitted when one is waiting and is not emitted again until take() has
+//  been called.
+class Ingest : public QObject
+{
+  Q_OBJECT
+
+  public:
+    Ingest();
+    std::shared_ptr<const StateSnapshot> take();
+    QList<QDBusMessage> rescanErrors() const;
+
+  public slots:
+    bool start();
+    int rescan(int);
+
+  signals:
+    void snapshotReady();
+
+  private:
+  // members
+    QDBusConnection bus;
+    QMap<QString,QVariant> properties;
+    ObjectStore services;
+    ObjectStore technologies;
+    ObjectStore peers;
+    quint32 services_changed;
+    quint32 metrics_services;       // store generations the metrics have
+    quint32 metrics_technologies;
+    QTimer* publish_timer;
+    std::shared_ptr<const StateSnapshot> current;
+    QAtomicInt notify_pending;
+    QList<QDBusMessage> rescan_errors;
+
+  // functions
+    void publish();
+
+  private slots:
+    void publishSnapshot();
+    void dbsManagerPropertyChanged(QString, QDBusVariant, QDBusMessage);
+    void dbsServicesChanged(QList<QVariant>, QList<QDBusObjectPath>, QDBusMessage);
+    void dbsPeersChanged(QList<QVariant>, QList<QDBusObjectPath>, QDBusMessage);
+    void dbsServicePropertyChanged(QString, QDBusVariant, QDBusMessage);
+    void dbsTechnologyPropertyChanged(QString, QDBusVariant, QDBusMessage);
+    void dbsTechnologyAdded(QDBusObjectPath, QVariantMap);
+    void dbsTechnologyRemoved(QDBusObjectPath);
+};
+
+# endif
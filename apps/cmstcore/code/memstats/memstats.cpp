@@ -0,0 +1,125 @@
+/**************************** memstats.cpp ****************************
+
+Estimates of the heap memory held by the Qt containers we keep.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QtDBus/QDBusObjectPath>
+# include <QTextStream>
+
+# include "./memstats.h"
+
+//  Approximate overheads of the Qt 5 containers on a 64 bit system
+# define ARRAY_HEADER 24    // QArrayData / QListData header
+# define MAP_HEADER 48      // QMapData
+# define MAP_NODE 24        // QMapNodeBase, parent, left, right
+
+//
+//  Function to return the bytes held by a string
+qint64 MemStats::bytes(const QString& s)
+{
+  if (s.isNull() || s.capacity() == 0) return 0;
+
+  return ARRAY_HEADER + qint64(s.capacity() + 1) * sizeof(QChar);
+}
+
+//
+//  Function to return the bytes held by a string list
+qint64 MemStats::bytes(const QStringList& sl)
+{
+  if (sl.isEmpty() ) return 0;
+
+  qint64 rtn = ARRAY_HEADER + qint64(sl.size() ) * sizeof(void*);
+  for (int i = 0; i < sl.size(); ++i) {
+    rtn += bytes(sl.at(i) );
+  } // for
+
+  return rtn;
+}
+
+//
+//  Function to return the bytes held by a variant, not counting the
+//  QVariant itself.  Only the types connman sends us are looked into.
+qint64 MemStats::bytes(const QVariant& v)
+{
+  switch (v.type() ) {
+    case QVariant::String:
+      return bytes(v.toString() );
+    case QVariant::StringList:
+      return bytes(v.toStringList() );
+    case QVariant::Map:
+      return bytes(v.toMap() );
+    case QVariant::List: {
+      const QList<QVariant> vl = v.toList();
+      qint64 rtn = ARRAY_HEADER + qint64(vl.size() ) * (sizeof(void*) + sizeof(QVariant) );
+      for (int i = 0; i < vl.size(); ++i) {
+        rtn += bytes(vl.at(i) );
+      } // for
+      return rtn;
+    }
+    default:
+      break;
+  } // switch
+
+  if (v.userType() == qMetaTypeId<QDBusObjectPath>() ) return bytes(v.value<QDBusObjectPath>().path() );
+
+  return 0;
+}
+
+//
+//  Function to return the bytes held by a property map
+qint64 MemStats::bytes(const QMap<QString,QVariant>& map)
+{
+  if (map.isEmpty() ) return 0;
+
+  qint64 rtn = MAP_HEADER;
+  for (QMap<QString,QVariant>::const_iterator itr = map.constBegin(); itr != map.constEnd(); ++itr) {
+    rtn += MAP_NODE + sizeof(QString) + sizeof(QVariant);
+    rtn += bytes(itr.key() ) + bytes(itr.value() );
+  } // for
+
+  return rtn;
+}
+
+//
+//  Function to format a memory report as a text table with a total line
+QString MemStats::report(const QList<item>& items)
+{
+  QString rtn;
+  QTextStream out(&rtn);
+  qint64 total = 0;
+
+  for (int i = 0; i < items.size(); ++i) {
+    out << qSetFieldWidth(32) << left << items.at(i).name
+        << qSetFieldWidth(10) << right << items.at(i).count
+        << qSetFieldWidth(14) << items.at(i).bytes
+        << qSetFieldWidth(0) << " bytes\n";
+    total += items.at(i).bytes;
+  } // for
+  out << qSetFieldWidth(32) << left << "total" << qSetFieldWidth(10) << right << ""
+      << qSetFieldWidth(14) << total << qSetFieldWidth(0) << " bytes\n";
+  out.flush();
+
+  return rtn;
+}
@@ -0,0 +1,56 @@
+/**************************** memstats.h ******************************
+
+Estimates of the heap memory held by the Qt containers we keep.  The
+figures count the container nodes and string data, they are estimates
+and count implicitly shared data once for every holder.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef CMST_MEMSTATS
+# define CMST_MEMSTATS
+
+# include <QString>
+# include <QStringList>
+# include <QList>
+# include <QMap>
+# include <QVariant>
+
+namespace MemStats
+{
+  // one line of a memory report
+  struct item
+  {
+    QString name;
+    int count;        // entries held
+    qint64 bytes;
+  };
+
+  qint64 bytes(const QString&);
+  qint64 bytes(const QStringList&);
+  qint64 bytes(const QVariant&);
+  qint64 bytes(const QMap<QString,QVariant>&);
+  QString report(const QList<item>&);
+} // namespace MemStats
+
+# endif
@@ -0,0 +1,487 @@
+/**************************** metrics.cpp *****************************
+
+Connectivity metrics in the OpenMetrics text format, served on a local
+socket for monitoring agents to scrape.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QtCore/QDebug>
+# include <QDir>
+# include <QFile>
+# include <QLocalServer>
+# include <QLocalSocket>
+# include <QMutex>
+# include <QMutexLocker>
+# include <QList>
+# include <QStringList>
+# include <QHash>
+
+# include <atomic>
+# include <sys/stat.h>
+
+# include "./metrics.h"
+# include "../objstore/objstore.h"
+# include "../trace/trace.h"
+
+//  Room reserved for the rendered text, enough for a few dozen services
+//  without growing
+# define METRICS_BUFFER 16384
+
+namespace
+{
+  // a service as of the last publish, labels are ready to write
+  struct serviceRow
+  {
+    QString path;
+    quint32 gen;
+    QByteArray labels;    // service="...",name="...",type="..."
+    quint8 state;         // Conn::State
+    qint16 strength;      // -1 if the service has no Strength
+    QString error;
+  };
+
+  // a technology as of the last publish
+  struct technologyRow
+  {
+    QByteArray labels;    // technology="...",type="..."
+    bool powered;
+    bool connected;
+  };
+
+  // the bytes connman has counted for a service
+  struct counterRow
+  {
+    QByteArray labels;    // service="..."
+    quint64 bytes[4];     // home rx, home tx, roaming rx, roaming tx
+  };
+
+  // an error seen, by Error property value or D-Bus error name
+  struct errorRow
+  {
+    QByteArray labels;    // error="..."
+    quint64 count;
+  };
+
+  // manager states, in the order of the stateset
+  const char* const manager_states[] = {"offline", "idle", "ready", "online"};
+  const int manager_count = sizeof(manager_states) / sizeof(manager_states[0]);
+
+  std::atomic<bool> enabled(false);
+  std::atomic<int> manager_state(-1);
+  std::atomic<bool> offline_mode(false);
+  std::atomic<quint64> transitions[Conn::StateCount];
+
+  // tables, swapped in and copied out under lock
+  QMutex lock;
+  QList<serviceRow> services;
+  QList<technologyRow> technologies;
+  QHash<QString, counterRow> counters;
+  QHash<QString, errorRow> errors;
+
+  //
+  // Function to append name="value" to a label set, escaping the value
+  void appendLabel(QByteArray& out, const char* name, const QString& value)
+  {
+    if (! out.isEmpty() ) out.append(',');
+    out.append(name);
+    out.append("=\"");
+    const QByteArray ba = value.toUtf8();
+    for (int i = 0; i < ba.size(); ++i) {
+      switch (ba.at(i) ) {
+        case '\\':  out.append("\\\\"); break;
+        case '"':   out.append("\\\""); break;
+        case '\n':  out.append("\\n"); break;
+        default:    out.append(ba.at(i) ); break;
+      } // switch
+    } // for
+    out.append('"');
+
+    return;
+  }
+
+  //
+  // Function to return state="..." for each Conn::State, built once
+  QList<QByteArray> stateLabels()
+  {
+    QList<QByteArray> rtn;
+    for (int i = 0; i < Conn::StateCount; ++i) {
+      QByteArray ba;
+      appendLabel(ba, "state", i > 0 ? Conn::stateName(i) : QString("unknown") );
+      rtn.append(ba);
+    } // for
+
+    return rtn;
+  }
+
+  //
+  // Function to count an error, call with lock held
+  void countError(const QString& error)
+  {
+    QHash<QString, errorRow>::iterator itr = errors.find(error);
+    if (itr == errors.end() ) {
+      errorRow er;
+      appendLabel(er.labels, "error", error);
+      er.count = 0;
+      itr = errors.insert(error, er);
+    } // if new error
+    ++itr->count;
+
+    return;
+  }
+
+  //
+  // Function to append a number without building a temporary string
+  void appendNumber(QByteArray& out, quint64 n)
+  {
+    char num[24];
+    int len = qsnprintf(num, sizeof(num), "%llu", static_cast<unsigned long long>(n) );
+    out.append(num, len);
+
+    return;
+  }
+
+  //
+  // Function to append the TYPE and HELP lines of a metric family
+  void appendFamily(QByteArray& out, const char* name, const char* type, const char* help)
+  {
+    out.append("# TYPE ").append(name).append(' ').append(type).append('\n');
+    out.append("# HELP ").append(name).append(' ').append(help).append('\n');
+
+    return;
+  }
+
+  //
+  // Function to append one sample, labels may be empty
+  void appendSample(QByteArray& out, const char* name, const QByteArray& labels, const char* extra, quint64 value)
+  {
+    out.append(name);
+    if (! labels.isEmpty() || extra != 0) {
+      out.append('{').append(labels);
+      if (extra != 0) {
+        if (! labels.isEmpty() ) out.append(',');
+        out.append(extra);
+      } // if extra labels
+      out.append('}');
+    } // if labels
+    out.append(' ');
+    appendNumber(out, value);
+    out.append('\n');
+
+    return;
+  }
+} // namespace
+
+//
+//  Function to return true once a MetricsServer is listening
+bool Metrics::isEnabled()
+{
+  return enabled.load(std::memory_order_relaxed);
+}
+
+//
+//  Function to record the services.  Called by Ingest each time it
+//  publishes, which is the only thread that writes the service table.
+//  Services are compared to the last call by generation, a changed state
+//  counts a transition and a new Error property counts an error.
+void Metrics::setServices(const ObjectStore& store)
+{
+  if (! isEnabled() ) return;
+
+  QList<serviceRow> old;
+  {
+    QMutexLocker locker(&lock);
+    old = services;
+  }
+
+  QHash<QString, int> oldrows;
+  oldrows.reserve(old.size() );
+  for (int i = 0; i < old.size(); ++i) {
+    oldrows.insert(old.at(i).path, i);
+  } // for
+
+  QList<serviceRow> rows;
+  rows.reserve(store.size() );
+  QStringList newerrors;
+  for (int i = 0; i < store.size(); ++i) {
+    const arrayElement& ae = store.at(i);
+    const int row = oldrows.value(ae.objpath.path(), -1);
+    if (row >= 0 && old.at(row).gen == ae.gen) {
+      rows.append(old.at(row) );
+      continue;
+    } // if unchanged
+
+    serviceRow sr;
+    sr.path = ae.objpath.path();
+    sr.gen = ae.gen;
+    appendLabel(sr.labels, "service", sr.path);
+    appendLabel(sr.labels, "name", ae.objmap.value("Name").toString() );
+    appendLabel(sr.labels, "type", Conn::typeName(ae.rec.type) );
+    sr.state = ae.rec.state;
+    sr.strength = ae.objmap.contains("Strength") ? qint16(ae.rec.strength) : qint16(-1);
+    sr.error = ae.objmap.value("Error").toString();
+    rows.append(sr);
+
+    // services we already knew about
+    if (row < 0) continue;
+    if (sr.state != old.at(row).state && sr.state < Conn::StateCount)
+      transitions[sr.state].fetch_add(1, std::memory_order_relaxed);
+    if (! sr.error.isEmpty() && sr.error != old.at(row).error) newerrors.append(sr.error);
+  } // for
+
+  QMutexLocker locker(&lock);
+  services = rows;
+  for (int i = 0; i < newerrors.size(); ++i) {
+    countError(newerrors.at(i) );
+  } // for
+
+  return;
+}
+
+//
+//  Function to record the technologies.  Called by Ingest each time it
+//  publishes.
+void Metrics::setTechnologies(const ObjectStore& store)
+{
+  if (! isEnabled() ) return;
+
+  QList<technologyRow> rows;
+  rows.reserve(store.size() );
+  for (int i = 0; i < store.size(); ++i) {
+    const arrayElement& ae = store.at(i);
+    technologyRow tr;
+    appendLabel(tr.labels, "technology", ae.objpath.path() );
+    appendLabel(tr.labels, "type", ae.objmap.value("Type").toString() );
+    tr.powered = ae.rec.is(Conn::Powered);
+    tr.connected = ae.rec.is(Conn::Connected);
+    rows.append(tr);
+  } // for
+
+  QMutexLocker locker(&lock);
+  technologies = rows;
+
+  return;
+}
+
+//
+//  Function to record the connman manager State and OfflineMode properties
+void Metrics::setManagerState(const QString& state, bool offline)
+{
+  int index = -1;
+  for (int i = 0; i < manager_count; ++i) {
+    if (state == QLatin1String(manager_states[i]) ) index = i;
+  } // for
+  manager_state.store(index, std::memory_order_relaxed);
+  offline_mode.store(offline, std::memory_order_relaxed);
+
+  return;
+}
+
+//
+//  Function to record a Usage call from connman.  home and roaming hold
+//  only the values that changed since the last call for this service.
+void Metrics::counterUsage(const QString& path, const QVariantMap& home, const QVariantMap& roaming)
+{
+  if (! isEnabled() ) return;
+
+  QMutexLocker locker(&lock);
+  QHash<QString, counterRow>::iterator itr = counters.find(path);
+  if (itr == counters.end() ) {
+    counterRow cr;
+    appendLabel(cr.labels, "service", path);
+    for (int i = 0; i < 4; ++i) {
+      cr.bytes[i] = 0;
+    } // for
+    itr = counters.insert(path, cr);
+  } // if new service
+
+  if (home.contains("RX.Bytes") ) itr->bytes[0] = home.value("RX.Bytes").toULongLong();
+  if (home.contains("TX.Bytes") ) itr->bytes[1] = home.value("TX.Bytes").toULongLong();
+  if (roaming.contains("RX.Bytes") ) itr->bytes[2] = roaming.value("RX.Bytes").toULongLong();
+  if (roaming.contains("TX.Bytes") ) itr->bytes[3] = roaming.value("TX.Bytes").toULongLong();
+
+  return;
+}
+
+//
+//  Function to count a failed Connect call, error is the D-Bus error name
+void Metrics::connectError(const QString& error)
+{
+  if (! isEnabled() ) return;
+
+  QMutexLocker locker(&lock);
+  countError(error);
+
+  return;
+}
+
+//
+//  Function to append the metrics to out in the OpenMetrics text format.
+//  The tables are copied under the lock, which costs a reference count
+//  each, and written out after it is released.
+void Metrics::render(QByteArray& out)
+{
+  static const QList<QByteArray> state_labels = stateLabels();
+  QList<serviceRow> svcs;
+  QList<technologyRow> techs;
+  QHash<QString, counterRow> cntrs;
+  QHash<QString, errorRow> errs;
+  {
+    QMutexLocker locker(&lock);
+    svcs = services;
+    techs = technologies;
+    cntrs = counters;
+    errs = errors;
+  }
+
+  // manager
+  appendFamily(out, "cmst_connman_state", "stateset", "Connman global connection state.");
+  const int ms = manager_state.load(std::memory_order_relaxed);
+  for (int i = 0; i < manager_count; ++i) {
+    out.append("cmst_connman_state{cmst_connman_state=\"").append(manager_states[i]).append("\"} ");
+    out.append(i == ms ? '1' : '0').append('\n');
+  } // for
+  appendFamily(out, "cmst_offline_mode", "gauge", "1 if connman is in offline (airplane) mode.");
+  appendSample(out, "cmst_offline_mode", QByteArray(), 0, offline_mode.load(std::memory_order_relaxed) ? 1 : 0);
+
+  // technologies
+  appendFamily(out, "cmst_technology_powered", "gauge", "1 if the technology is powered.");
+  for (int i = 0; i < techs.size(); ++i) {
+    appendSample(out, "cmst_technology_powered", techs.at(i).labels, 0, techs.at(i).powered ? 1 : 0);
+  } // for
+  appendFamily(out, "cmst_technology_connected", "gauge", "1 if the technology has a connected service.");
+  for (int i = 0; i < techs.size(); ++i) {
+    appendSample(out, "cmst_technology_connected", techs.at(i).labels, 0, techs.at(i).connected ? 1 : 0);
+  } // for
+
+  // services
+  appendFamily(out, "cmst_service", "info", "The services connman reports and the state of each.");
+  for (int i = 0; i < svcs.size(); ++i) {
+    const int state = svcs.at(i).state < Conn::StateCount ? svcs.at(i).state : 0;
+    appendSample(out, "cmst_service_info", svcs.at(i).labels, state_labels.at(state).constData(), 1);
+  } // for
+  appendFamily(out, "cmst_service_strength", "gauge", "Signal strength of the service, 0 to 100.");
+  for (int i = 0; i < svcs.size(); ++i) {
+    if (svcs.at(i).strength >= 0) appendSample(out, "cmst_service_strength", svcs.at(i).labels, 0, quint64(svcs.at(i).strength) );
+  } // for
+  appendFamily(out, "cmst_service_transitions", "counter", "Changes of service state, by the state entered.");
+  for (int i = 1; i < Conn::StateCount; ++i) {
+    appendSample(out, "cmst_service_transitions_total", QByteArray(), state_labels.at(i).constData(), transitions[i].load(std::memory_order_relaxed) );
+  } // for
+  appendFamily(out, "cmst_connect_errors", "counter", "Service Error properties and failed Connect calls, by error.");
+  for (QHash<QString, errorRow>::const_iterator itr = errs.constBegin(); itr != errs.constEnd(); ++itr) {
+    appendSample(out, "cmst_connect_errors_total", itr.value().labels, 0, itr.value().count);
+  } // for
+
+  // counters
+  appendFamily(out, "cmst_counter_bytes", "counter", "Bytes connman has counted for the service since the counter was registered.");
+  out.append("# UNIT cmst_counter_bytes bytes\n");
+  static const char* const directions[] = {
+    "direction=\"rx\",roaming=\"false\"", "direction=\"tx\",roaming=\"false\"",
+    "direction=\"rx\",roaming=\"true\"", "direction=\"tx\",roaming=\"true\""
+  };
+  for (QHash<QString, counterRow>::const_iterator itr = cntrs.constBegin(); itr != cntrs.constEnd(); ++itr) {
+    for (int i = 0; i < 4; ++i) {
+      appendSample(out, "cmst_counter_bytes_total", itr.value().labels, directions[i], itr.value().bytes[i]);
+    } // for
+  } // for
+
+  out.append("# EOF\n");
+
+  return;
+}
+
+////////////////////////////// MetricsServer ////////////////////////////////
+//
+// Constructor.  The server is not created until start() runs in our thread.
+MetricsServer::MetricsServer(const QString& socketname) : QObject(0),
+  name(socketname),
+  server(0)
+{
+  // reserved so that resize(0) keeps the allocation between scrapes
+  buffer.reserve(METRICS_BUFFER);
+}
+
+////////////////////////////// Public Slots ////////////////////////////////
+//
+// Slot to start listening.  name is either a socket name, which is placed
+// in the temporary directory, or a full path.  Only our own user may
+// connect.  A socket already at the path is taken to be left over after a
+// crash and removed, anything else there is left alone and we fail.
+// Return false if the socket could not be opened.
+bool MetricsServer::start()
+{
+  Trace::setThreadName("metrics");
+
+  // the path QLocalServer will use for name
+  const QString path = name.startsWith('/') ? name : QDir::cleanPath(QDir::tempPath()) + '/' + name;
+  struct stat st;
+  if (::lstat(QFile::encodeName(path).constData(), &st) == 0) {
+    if (! S_ISSOCK(st.st_mode) ) {
+      #if QT_VERSION >= 0x050400
+        qCritical("CMST - Cannot listen for metrics on %s: the file exists and is not a socket", qUtf8Printable(path) );
+      # else
+        qCritical("CMST - Cannot listen for metrics on %s: the file exists and is not a socket", qPrintable(path) );
+      # endif
+      return false;
+    } // if not a socket
+    QLocalServer::removeServer(name);
+  } // if something at the path
+
+  server = new QLocalServer(this);
+  server->setSocketOptions(QLocalServer::UserAccessOption);
+  if (! server->listen(name) ) {
+    #if QT_VERSION >= 0x050400
+      qCritical("CMST - Cannot listen for metrics on %s: %s", qUtf8Printable(name), qUtf8Printable(server->errorString()) );
+    # else
+      qCritical("CMST - Cannot listen for metrics on %s: %s", qPrintable(name), qPrintable(server->errorString()) );
+    # endif
+    return false;
+  } // if listen failed
+
+  connect(server, SIGNAL(newConnection()), this, SLOT(newConnection()));
+  enabled.store(true, std::memory_order_relaxed);
+
+  return true;
+}
+
+////////////////////////////// Private Slots ////////////////////////////////
+//
+// Slot called when a client connects.  Write the metrics and hang up, the
+// socket is deleted once the data is sent.
+void MetricsServer::newConnection()
+{
+  while (server->hasPendingConnections() ) {
+    QLocalSocket* socket = server->nextPendingConnection();
+    {
+      CMST_TRACE("render metrics", "metrics");
+      buffer.resize(0);
+      Metrics::render(buffer);
+    }
+    socket->write(buffer);
+    connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+    socket->disconnectFromServer();
+  } // while
+
+  return;
+}
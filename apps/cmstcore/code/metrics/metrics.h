@@ -0,0 +1,82 @@
+/**************************** metrics.h *******************************
+
+Connectivity metrics in the OpenMetrics text format, served on a local
+socket for monitoring agents to scrape.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef CMST_METRICS
+# define CMST_METRICS
+
+# include <QObject>
+# include <QString>
+# include <QByteArray>
+# include <QVariantMap>
+
+class ObjectStore;
+class QLocalServer;
+
+//
+//  The values are recorded from the threads that see them: the manager
+//  state, services and technologies by Ingest each time it publishes, the
+//  counters in the GUI thread.  Recording does nothing until a
+//  MetricsServer has been started.  Writers take a lock only to swap in
+//  data they have already prepared, and a scrape takes it only to copy
+//  the implicitly shared tables, so neither waits on the other for long.
+namespace Metrics
+{
+  bool isEnabled();
+  void setServices(const ObjectStore&);
+  void setTechnologies(const ObjectStore&);
+  void setManagerState(const QString&, bool);
+  void counterUsage(const QString&, const QVariantMap&, const QVariantMap&);
+  void connectError(const QString&);
+  void render(QByteArray&);
+} // namespace Metrics
+
+//
+//  Serves Metrics::render() on a QLocalServer.  Create it without a parent,
+//  move it to a QThread and queue a call to start().  A client that
+//  connects is sent the metrics and disconnected, nothing is read from it.
+class MetricsServer : public QObject
+{
+  Q_OBJECT
+
+  public:
+    MetricsServer(const QString&);
+
+  public slots:
+    bool start();
+
+  private:
+  // members
+    QString name;
+    QLocalServer* server;
+    QByteArray buffer;
+
+  private slots:
+    void newConnection();
+};
+
+# endif
@@ -0,0 +1,873 @@
+/**************************** objstore.cpp ****************************
+
+Class to hold the objects (services, technologies, peers) reported by
+connman.  Objects are kept in the order connman reports them and are
+indexed by object path so a lookup does not need to walk the list.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include "./objstore.h"
+# include "../memstats/memstats.h"
+
+# include <QtDBus/QDBusMetaType>
+# include <QLatin1String>
+# include <QStringList>
+# include <QVector>
+
+////////////////////////////// Property Tables /////////////////////////////
+//
+//  Connman names for the Conn::State and Conn::Type values, in enum order
+static constexpr const char* state_names[] = {
+  "", "idle", "failure", "association", "configuration", "ready", "disconnect", "online"
+};
+static_assert(sizeof(state_names) / sizeof(state_names[0]) == Conn::StateCount, "state_names out of step with Conn::State");
+
+static constexpr const char* type_names[] = {
+  "", "system", "ethernet", "wifi", "bluetooth", "cellular", "gps", "vpn", "gadget", "p2p"
+};
+static_assert(sizeof(type_names) / sizeof(type_names[0]) == Conn::TypeCount, "type_names out of step with Conn::Type");
+
+//  Connman security names and the bit each sets
+static constexpr struct {const char* name; quint8 bit;} security_names[] = {
+  {"none", Conn::SecurityNone},
+  {"wep", Conn::SecurityWep},
+  {"psk", Conn::SecurityPsk},
+  {"ieee8021x", Conn::SecurityIeee8021x},
+  {"wps", Conn::SecurityWps}
+};
+
+//
+// Function to return the position of s in a name table, 0 if not found
+template <int N>
+static quint8 nameIndex(const char* const (&names)[N], const QString& s)
+{
+  for (int i = 1; i < N; ++i) {
+    if (s == QLatin1String(names[i]) ) return i;
+  } // for
+
+  return 0;
+}
+
+//
+// Functions to write one property into an objectRecord
+static void setState(objectRecord& rec, const QVariant& var) {rec.state = nameIndex(state_names, var.toString() );}
+static void setType(objectRecord& rec, const QVariant& var) {rec.type = nameIndex(type_names, var.toString() );}
+static void setStrength(objectRecord& rec, const QVariant& var) {rec.strength = quint8(qMin(var.toUInt(), 100u) );}
+static void setSecurity(objectRecord& rec, const QVariant& var)
+{
+  const QStringList sl = var.toStringList();
+  rec.security = 0;
+  for (int i = 0; i < sl.size(); ++i) {
+    for (unsigned j = 0; j < sizeof(security_names) / sizeof(security_names[0]); ++j) {
+      if (sl.at(i) == QLatin1String(security_names[j].name) ) rec.security |= security_names[j].bit;
+    } // for
+  } // for
+
+  return;
+}
+
+template <Conn::Flag F>
+static void setFlag(objectRecord& rec, const QVariant& var)
+{
+  if (var.toBool() ) rec.flags |= F;
+  else rec.flags &= quint16(~F);
+
+  return;
+}
+
+//  Property name to objectRecord field.  Properties not in the table only
+//  live in the property map.
+static constexpr struct {const char* name; void (*set)(objectRecord&, const QVariant&);} property_table[] = {
+  {"State",       setState},
+  {"Type",        setType},
+  {"Strength",    setStrength},
+  {"Security",    setSecurity},
+  {"Favorite",    setFlag<Conn::Favorite>},
+  {"Immutable",   setFlag<Conn::Immutable>},
+  {"AutoConnect", setFlag<Conn::AutoConnect>},
+  {"Roaming",     setFlag<Conn::Roaming>},
+  {"Powered",     setFlag<Conn::Powered>},
+  {"Connected",   setFlag<Conn::Connected>},
+  {"Tethering",   setFlag<Conn::Tethering>}
+};
+
+//
+// Function to return the connman name of a Conn::State
+QString Conn::stateName(int state)
+{
+  if (state <= 0 || state >= Conn::StateCount) return QString();
+
+  return QLatin1String(state_names[state]);
+}
+
+//
+// Function to return the connman name of a Conn::Type
+QString Conn::typeName(int type)
+{
+  if (type <= 0 || type >= Conn::TypeCount) return QString();
+
+  return QLatin1String(type_names[type]);
+}
+
+//
+// Function to return the Conn::Type for a connman type name
+int Conn::typeValue(const QString& name)
+{
+  return nameIndex(type_names, name);
+}
+
+//
+// Function to write a property into the record.  Return true if the
+// property is one the record keeps.
+bool objectRecord::setProperty(const QString& property, const QVariant& value)
+{
+  for (unsigned i = 0; i < sizeof(property_table) / sizeof(property_table[0]); ++i) {
+    if (property == QLatin1String(property_table[i].name) ) {
+      property_table[i].set(*this, value);
+      return true;
+    } // if
+  } // for
+
+  return false;
+}
+
+//
+// Function to fill the record from a complete property map
+void objectRecord::load(const QMap<QString,QVariant>& map)
+{
+  *this = objectRecord();
+  for (unsigned i = 0; i < sizeof(property_table) / sizeof(property_table[0]); ++i) {
+    QMap<QString,QVariant>::const_iterator itr = map.constFind(QLatin1String(property_table[i].name) );
+    if (itr != map.constEnd() ) property_table[i].set(*this, itr.value() );
+  } // for
+
+  return;
+}
+
+////////////////////////////// DBus Marshalling ////////////////////////////
+//
+// Write an arrayElement as a (oa{sv}) structure
+QDBusArgument& operator<<(QDBusArgument& argument, const arrayElement& ae)
+{
+  argument.beginStructure();
+  argument << ae.objpath << ae.objmap;
+  argument.endStructure();
+
+  return argument;
+}
+
+//
+// Read an arrayElement from a (oa{sv}) structure
+const QDBusArgument& operator>>(const QDBusArgument& argument, arrayElement& ae)
+{
+  argument.beginStructure();
+  argument >> ae.objpath >> ae.objmap;
+  argument.endStructure();
+  ae.rec.load(ae.objmap);
+  ae.gen = 0;
+
+  return argument;
+}
+
+// Constructor
+ObjectStore::ObjectStore()
+{
+  elements.clear();
+  index.clear();
+  store_gen = 0;
+  observers.clear();
+}
+
+// Copy constructor, the observers stay with other
+ObjectStore::ObjectStore(const ObjectStore& other)
+{
+  elements = other.elements;
+  index = other.index;
+  store_gen = other.store_gen;
+  observers.clear();
+}
+
+//
+// Assignment, the observers of this store are kept and those of other are
+// not copied
+ObjectStore& ObjectStore::operator=(const ObjectStore& other)
+{
+  elements = other.elements;
+  index = other.index;
+  store_gen = other.store_gen;
+
+  return *this;
+}
+
+//
+// Function to return a property value ready for use.  Nested dictionaries
+// (IPv4, IPv6, Proxy, Ethernet, Provider, *.Configuration) arrive as a
+// QDBusArgument, they are demarshalled once here into a QVariantMap so
+// nothing reading the store needs to touch a QDBusArgument.  Any other
+// value is returned as is.
+static QVariant normalized(const QVariant& var)
+{
+  if (var.userType() != qMetaTypeId<QDBusArgument>() ) return var;
+  const QDBusArgument qdba = var.value<QDBusArgument>();
+  if (qdba.currentType() != QDBusArgument::MapType ) return var;
+
+  QVariantMap map;
+  qdba.beginMap();
+  while (! qdba.atEnd() ) {
+    QString key;
+    QVariant value;
+    qdba.beginMapEntry();
+    qdba >> key >> value;
+    qdba.endMapEntry();
+    map.insert(key, normalized(value) );
+  } // while
+  qdba.endMap();
+
+  return map;
+}
+
+//
+// Function to normalize every value of a property map in place
+static void normalizeMap(QMap<QString,QVariant>& r_map)
+{
+  QMap<QString,QVariant>::iterator itr;
+  for (itr = r_map.begin(); itr != r_map.end(); ++itr) {
+    if (itr.value().userType() == qMetaTypeId<QDBusArgument>() ) itr.value() = normalized(itr.value() );
+  } // for
+
+  return;
+}
+
+//
+// Functions to keep a count of filled slots in a Fenwick tree, used by
+// editScript() to find the row a key is on in O(log n).  tree[0] is not
+// used, slot s is held at tree[s + 1].
+static void fillSlot(QVector<int>& tree, int slot, int delta)
+{
+  for (int i = slot + 1; i < tree.size(); i += (i & -i) ) tree[i] += delta;
+
+  return;
+}
+
+static int filledBefore(const QVector<int>& tree, int slot)
+{
+  int rtn = 0;
+  for (int i = slot; i > 0; i -= (i & -i) ) rtn += tree.at(i);
+
+  return rtn;
+}
+
+////////////////////////////// Public Functions ////////////////////////////
+//
+// Function to register arrayElement, and a list of them, with QtDBus.  Once
+// registered a(oa{sv}) replies can be used in typed calls and signals.
+// Call once before the first DBus call is made.
+void ObjectStore::registerMetaTypes()
+{
+  qDBusRegisterMetaType<arrayElement>();
+  qDBusRegisterMetaType<QList<arrayElement> >();
+
+  return;
+}
+
+//
+// Function to work out the steps that turn the list before into the list
+// after.  Both lists hold unique keys (object paths), a key repeated in
+// before is removed after its first appearance.  The script removes keys
+// that are gone, then walks after inserting new keys and moving keys
+// that are out of order.  Keys that lie on a longest increasing run of
+// their old positions keep their place, so only the keys that actually
+// changed their order are moved.  Views and menus apply the same script
+// to their own rows so a reordered list moves a few rows rather than
+// rebuilding all of them.
+QList<storeEdit> ObjectStore::editScript(const QStringList& before, const QStringList& after)
+{
+  QList<storeEdit> script;
+
+  QHash<QString,int> wanted;
+  wanted.reserve(after.size() );
+  for (int i = 0; i < after.size(); ++i) {
+    wanted.insert(after.at(i), i);
+  } // for
+
+  // keys we no longer want, work from the bottom up
+  QStringList work;
+  QHash<QString,int> oldpos;
+  QVector<bool> keep(before.size(), false);
+  for (int i = 0; i < before.size(); ++i) {
+    if (! wanted.contains(before.at(i)) || oldpos.contains(before.at(i)) ) continue;
+    oldpos.insert(before.at(i), i);
+    keep[i] = true;
+  } // for
+  for (int i = before.size() - 1; i >= 0; --i) {
+    if (keep.at(i) ) continue;
+    storeEdit edit;
+    edit.op = storeEdit::Remove;
+    edit.from = i;
+    edit.to = -1;
+    edit.key = before.at(i);
+    script.append(edit);
+  } // for
+  for (int i = 0; i < before.size(); ++i) {
+    if (keep.at(i) ) work.append(before.at(i) );
+  } // for
+
+  // old positions of the surviving keys taken in the new order, the keys
+  // on the longest increasing subsequence of these stay where they are
+  QVector<int> seq;
+  QVector<int> seqitem;
+  for (int i = 0; i < after.size(); ++i) {
+    QHash<QString,int>::const_iterator itr = oldpos.constFind(after.at(i) );
+    if (itr == oldpos.constEnd() ) continue;
+    seq.append(itr.value() );
+    seqitem.append(i);
+  } // for
+
+  QVector<bool> stays(after.size(), false);
+  QVector<int> tails;
+  QVector<int> prev(seq.size(), -1);
+  for (int i = 0; i < seq.size(); ++i) {
+    int lo = 0;
+    int hi = tails.size();
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      if (seq.at(tails.at(mid)) < seq.at(i) ) lo = mid + 1;
+      else hi = mid;
+    } // while
+    if (lo > 0) prev[i] = tails.at(lo - 1);
+    if (lo == tails.size() ) tails.append(i);
+    else tails[lo] = i;
+  } // for
+  for (int i = tails.isEmpty() ? -1 : tails.last(); i >= 0; i = prev.at(i) ) {
+    stays[seqitem.at(i)] = true;
+  } // for
+
+  // Rows of the list being edited are counted in a tree of slots laid out
+  // in the order keys pass through them: the keys of work, each key that
+  // stays followed by slots for the keys that will be put after it, and
+  // in front of everything the keys that go before the first one that
+  // stays.  A slot counts while its key is in it, so the row of a key is
+  // the number of filled slots before its slot.
+  QHash<QString,int> slot;
+  QVector<int> target(after.size(), -1);
+  int nslots = 0;
+  for (int i = 0; i < after.size() && ! stays.at(i); ++i) {
+    target[i] = nslots++;
+  } // for
+  for (int j = 0; j < work.size(); ++j) {
+    slot.insert(work.at(j), nslots++);
+    const int i = wanted.value(work.at(j) );
+    if (! stays.at(i) ) continue;
+    for (int k = i + 1; k < after.size() && ! stays.at(k); ++k) {
+      target[k] = nslots++;
+    } // for
+  } // for
+  QVector<int> tree(nslots + 1, 0);
+  for (int j = 0; j < work.size(); ++j) {
+    fillSlot(tree, slot.value(work.at(j)), 1);
+  } // for
+
+  // walk the new order, a key that does not stay is moved or inserted
+  // directly after the key before it in the new order
+  for (int i = 0; i < after.size(); ++i) {
+    if (stays.at(i) ) continue;
+
+    storeEdit edit;
+    edit.key = after.at(i);
+    QHash<QString,int>::const_iterator itr = slot.constFind(edit.key);
+    if (itr != slot.constEnd() ) {
+      edit.op = storeEdit::Move;
+      edit.from = filledBefore(tree, itr.value() );
+      fillSlot(tree, itr.value(), -1);
+    } // if move
+    else {
+      edit.op = storeEdit::Insert;
+      edit.from = -1;
+    } // else insert
+    edit.to = (i == 0 ? 0 : filledBefore(tree, slot.value(after.at(i - 1))) + 1);
+    fillSlot(tree, target.at(i), 1);
+    slot.insert(edit.key, target.at(i) );
+
+    if (edit.op == storeEdit::Move && edit.from == edit.to) continue;
+    script.append(edit);
+  } // for
+
+  return script;
+}
+
+//
+// Function to return a pointer to the element with the object path, or
+// a null pointer if we don't have it.  The pointer is only good until
+// the next time the store is modified.
+const arrayElement* ObjectStore::find(const QString& path) const
+{
+  QHash<QString,int>::const_iterator itr = index.constFind(path);
+  if (itr == index.constEnd() ) return 0;
+
+  return &elements.at(itr.value() );
+}
+
+//
+// Function to return the generation of the element with the object path,
+// 0 if we don't have it.
+quint32 ObjectStore::generation(const QString& path) const
+{
+  const arrayElement* ae = find(path);
+
+  return ae == 0 ? 0 : ae->gen;
+}
+
+//
+// Function to register an observer.  The observer is told about changes
+// to the property of the object at path.  An empty path or property
+// matches all of them.  An observer may subscribe more than once, it must
+// unsubscribe before it is deleted.
+void ObjectStore::subscribe(StoreObserver* observer, const QString& path, const QString& property)
+{
+  subscription sub;
+  sub.observer = observer;
+  sub.path = path;
+  sub.property = property;
+  observers.append(sub);
+
+  return;
+}
+
+//
+// Function to remove all the subscriptions of an observer
+void ObjectStore::unsubscribe(StoreObserver* observer)
+{
+  for (int i = observers.size() - 1; i >= 0; --i) {
+    if (observers.at(i).observer == observer) observers.removeAt(i);
+  } // for
+
+  return;
+}
+
+//
+// Function to empty the store
+void ObjectStore::clear()
+{
+  const bool b_changed = ! elements.isEmpty();
+  elements.clear();
+  index.clear();
+  if (b_changed) {
+    ++store_gen;
+    this->notifyList();
+  } // if
+
+  return;
+}
+
+//
+// Function to replace the entire contents of the store.  Called when
+// we get a complete list from connman (GetServices, GetTechnologies)
+// or after a merge produced a new ordering.
+void ObjectStore::setList(const QList<arrayElement>& r_list)
+{
+  elements = r_list;
+  for (int i = 0; i < elements.size(); ++i) {
+    normalizeMap(elements[i].objmap);
+    elements[i].rec.load(elements.at(i).objmap);
+    this->touch(i);
+  } // for
+  index.clear();
+  index.reserve(elements.size() );
+  this->reindex();
+  this->notifyList();
+
+  return;
+}
+
+//
+// Function to add an element to the end of the store
+void ObjectStore::append(const arrayElement& ae)
+{
+  index.insert(ae.objpath.path(), elements.size() );
+  elements.append(ae);
+  normalizeMap(elements.last().objmap);
+  elements.last().rec.load(elements.last().objmap);
+  this->touch(elements.size() - 1);
+  this->notifyList();
+
+  return;
+}
+
+//
+// Function to replace the element at row i.  The object path may change
+// so remove the old index entry first.
+void ObjectStore::replace(int i, const arrayElement& ae)
+{
+  if (i < 0 || i >= elements.size() ) return;
+
+  const arrayElement old = elements.at(i);
+  index.remove(old.objpath.path() );
+  elements.replace(i, ae);
+  normalizeMap(elements[i].objmap);
+  elements[i].rec.load(elements.at(i).objmap);
+  this->touch(i);
+  index.insert(ae.objpath.path(), i);
+  if (old.objpath == ae.objpath)
+    this->notifyMap(ae.objpath.path(), old.objmap, elements.at(i).objmap);
+  else
+    this->notifyList();
+
+  return;
+}
+
+//
+// Function to remove the element at row i.  Rows after i move up one so
+// their index entries need to be refreshed.
+void ObjectStore::removeAt(int i)
+{
+  if (i < 0 || i >= elements.size() ) return;
+
+  index.remove(elements.at(i).objpath.path() );
+  elements.removeAt(i);
+  this->reindex(i);
+  ++store_gen;
+  this->notifyList();
+
+  return;
+}
+
+//
+// Function to remove the element with the object path.  Return true if
+// something was removed.
+bool ObjectStore::remove(const QDBusObjectPath& path)
+{
+  int i = index.value(path.path(), -1);
+  if (i < 0) return false;
+
+  this->removeAt(i);
+  return true;
+}
+
+//
+// Function to remove a list of object paths (ServicesChanged and
+// PeersChanged send these).  Elements are removed in a single pass and the
+// index rebuilt once. Return value is the number of elements removed.
+int ObjectStore::remove(const QList<QDBusObjectPath>& r_removed)
+{
+  int first = elements.size();
+  int cntr = 0;
+
+  for (int i = 0; i < r_removed.size(); ++i) {
+    int row = index.value(r_removed.at(i).path(), -1);
+    if (row < 0) continue;
+    index.remove(r_removed.at(i).path() );
+    elements[row].objpath = QDBusObjectPath();  // mark for removal
+    if (row < first) first = row;
+    ++cntr;
+  } // for
+
+  if (cntr == 0) return 0;
+
+  for (int i = elements.size() - 1; i >= first; --i) {
+    if (elements.at(i).objpath.path().isEmpty() ) elements.removeAt(i);
+  } // for
+  this->reindex(first);
+  ++store_gen;
+  this->notifyList();
+
+  return cntr;
+}
+
+//
+// Function to change a single property of an object in place, both in the
+// property map and in the record.  Return true if the object was found.
+bool ObjectStore::setProperty(const QString& path, const QString& property, const QVariant& value)
+{
+  int i = index.value(path, -1);
+  if (i < 0) return false;
+
+  const QVariant newval = normalized(value);
+  const QVariant oldval = elements.at(i).objmap.value(property);
+  if (oldval == newval) return true;
+
+  elements[i].objmap.insert(property, newval);
+  elements[i].rec.setProperty(property, value);
+  this->touch(i);
+  this->notify(path, property, oldval, newval);
+  return true;
+}
+
+//
+// Function to bring the store up to date from an a(oa{sv}) array as sent by
+// GetServices, GetTechnologies, ServicesChanged and PeersChanged.  r_var is
+// the message argument holding the array.  The message is read once and
+// then applied to the store:
+//  - elements are put in the order of the array, anything not in the
+//    array is dropped.  The store is reordered with an edit script so
+//    elements that keep their relative order are not touched,
+//  - if b_full is true the array holds all the properties of each element
+//    (Get... replies) and they replace what we have,
+//  - otherwise only properties that changed are present (xxChanged signals)
+//    and they are written into the existing element.  An element that
+//    has no changed properties is not touched.
+//
+// Return true if the array was read, if not the store is left as it was.
+bool ObjectStore::merge(const QVariant& r_var, bool b_full)
+{
+  //  make sure we can convert the QVariant into a QDBusArgument holding an array
+  if (! r_var.canConvert<QDBusArgument>() ) return false;
+  const QDBusArgument qdba = r_var.value<QDBusArgument>();
+  if (qdba.currentType() != QDBusArgument::ArrayType ) return false;
+
+  // read the array, the paths in order and the properties sent with each
+  QStringList order;
+  QList<QMap<QString,QVariant> > props;
+  QHash<QString,int> seen;
+  qdba.beginArray();
+  while (! qdba.atEnd() ) {
+    if (qdba.currentType() != QDBusArgument::StructureType ) return false;
+
+    QDBusObjectPath path;
+    QMap<QString,QVariant> map;
+    qdba.beginStructure();
+    qdba >> path >> map;
+    qdba.endStructure();
+
+    // path appears twice in the array, keep the first one
+    if (seen.contains(path.path()) ) continue;
+    seen.insert(path.path(), order.size() );
+    normalizeMap(map);
+    order.append(path.path() );
+    props.append(map);
+  } // while
+  qdba.endArray();
+
+  // bring the order of the store in line with the array
+  QStringList current;
+  for (int i = 0; i < elements.size(); ++i) {
+    current.append(elements.at(i).objpath.path() );
+  } // for
+  const bool b_reordered = (current != order);
+  if (b_reordered) this->applyScript(editScript(current, order) );
+
+  // write the properties into the elements.  Elements just inserted have
+  // a generation of 0 and are reported through listChanged() only.
+  for (int row = 0; row < props.size(); ++row) {
+    const bool b_new = (elements.at(row).gen == 0);
+    if (b_full) {
+      if (! b_new && elements.at(row).objmap == props.at(row) ) continue;
+      const QMap<QString,QVariant> old = elements.at(row).objmap;
+      elements[row].objmap = props.at(row);
+      elements[row].rec.load(elements.at(row).objmap);
+      this->touch(row);
+      if (! b_new) this->notifyMap(order.at(row), old, elements.at(row).objmap);
+    } // if full
+    else {
+      QMap<QString,QVariant>::const_iterator itr;
+      for (itr = props.at(row).constBegin(); itr != props.at(row).constEnd(); ++itr) {
+        // compare on the const map first, writing detaches a shared map
+        const QMap<QString,QVariant>& cmap = elements.at(row).objmap;
+        QMap<QString,QVariant>::const_iterator old = cmap.constFind(itr.key() );
+        if (old == cmap.constEnd() || old.value() != itr.value() ) {
+          const QVariant oldval = (old == cmap.constEnd() ? QVariant() : old.value() );
+          elements[row].objmap.insert(itr.key(), itr.value() );
+          elements[row].rec.setProperty(itr.key(), itr.value() );
+          this->touch(row);
+          if (! b_new) this->notify(order.at(row), itr.key(), oldval, itr.value() );
+        } // if changed
+      } // for
+      if (b_new) this->touch(row);
+    } // else changed only
+  } // for
+
+  if (b_reordered) {
+    ++store_gen;
+    this->notifyList();
+  } // if
+
+  return true;
+}
+
+//
+// Function to take on the contents of another store, typically a snapshot
+// published by another thread.  Only the data is taken, our observers
+// stay and are told what changed.  Elements are compared by generation,
+// which only works because both stores get their generations from the
+// same source.  Return value is the list of objects we no longer have.
+QList<QDBusObjectPath> ObjectStore::adopt(const ObjectStore& next)
+{
+  QList<QDBusObjectPath> removed;
+  if (&next == this || next.store_gen == store_gen) return removed;
+
+  const QList<arrayElement> old = elements;
+  const QHash<QString,int> oldindex = index;
+  elements = next.elements;
+  index = next.index;
+  store_gen = next.store_gen;
+
+  // objects gone, and whether the order changed
+  bool b_list = (old.size() != elements.size() );
+  for (int i = 0; i < old.size(); ++i) {
+    if (! index.contains(old.at(i).objpath.path()) ) removed.append(old.at(i).objpath);
+    else if (! b_list && old.at(i).objpath != elements.at(i).objpath) b_list = true;
+  } // for
+  if (! removed.isEmpty() ) b_list = true;
+
+  // properties of objects we already had
+  if (! observers.isEmpty() ) {
+    for (int i = 0; i < elements.size(); ++i) {
+      int row = oldindex.value(elements.at(i).objpath.path(), -1);
+      if (row < 0 || old.at(row).gen == elements.at(i).gen) continue;
+      this->notifyMap(elements.at(i).objpath.path(), old.at(row).objmap, elements.at(i).objmap);
+    } // for
+  } // if
+
+  if (b_list) this->notifyList();
+
+  return removed;
+}
+
+//
+// Function to return an estimate of the bytes held by the store.  The
+// part held by nested dictionary properties (IPv4, Proxy, Ethernet and
+// the like) is not included, it is returned in submaps.
+qint64 ObjectStore::memoryUsage(qint64& submaps) const
+{
+  qint64 rtn = 24 + qint64(elements.size() ) * (sizeof(void*) + sizeof(arrayElement) );
+  rtn += qint64(index.capacity() ) * (sizeof(void*) + sizeof(QString) + sizeof(int) );
+  submaps = 0;
+
+  for (int i = 0; i < elements.size(); ++i) {
+    const arrayElement& ae = elements.at(i);
+    qint64 sub = 0;
+    for (QMap<QString,QVariant>::const_iterator itr = ae.objmap.constBegin(); itr != ae.objmap.constEnd(); ++itr) {
+      if (itr.value().type() == QVariant::Map) sub += MemStats::bytes(itr.value() );
+    } // for
+    rtn += MemStats::bytes(ae.objpath.path() ) * 2;   // list and index
+    rtn += MemStats::bytes(ae.objmap) - sub;
+    submaps += sub;
+  } // for
+
+  return rtn;
+}
+
+////////////////////////////// Private Functions ////////////////////////////
+//
+// Function to apply an edit script made by editScript() to the elements.
+// Inserted elements are given their object path only, the caller fills
+// in the properties.
+void ObjectStore::applyScript(const QList<storeEdit>& script)
+{
+  for (int i = 0; i < script.size(); ++i) {
+    const storeEdit& edit = script.at(i);
+    switch (edit.op) {
+      case storeEdit::Remove:
+        index.remove(elements.at(edit.from).objpath.path() );
+        elements.removeAt(edit.from);
+        break;
+      case storeEdit::Insert: {
+        arrayElement ae;
+        ae.objpath = QDBusObjectPath(edit.key);
+        ae.gen = 0;
+        elements.insert(edit.to, ae);
+        } break;
+      case storeEdit::Move:
+        elements.move(edit.from, edit.to);
+        break;
+      default:
+        break;
+    } // switch
+  } // for
+  this->reindex();
+
+  return;
+}
+
+//
+// Function to give the element at row a new generation
+void ObjectStore::touch(int row)
+{
+  elements[row].gen = ++store_gen;
+
+  return;
+}
+
+//
+// Function to tell the observers that want it about a property change
+void ObjectStore::notify(const QString& path, const QString& property, const QVariant& oldval, const QVariant& newval)
+{
+  for (int i = 0; i < observers.size(); ++i) {
+    const subscription& sub = observers.at(i);
+    if (! sub.path.isEmpty() && sub.path != path) continue;
+    if (! sub.property.isEmpty() && sub.property != property) continue;
+    sub.observer->propertyChanged(this, path, property, oldval, newval);
+  } // for
+
+  return;
+}
+
+//
+// Function to tell every observer objects were added, removed or moved.
+// An observer subscribed more than once is only told once.
+void ObjectStore::notifyList()
+{
+  QList<StoreObserver*> told;
+  for (int i = 0; i < observers.size(); ++i) {
+    if (told.contains(observers.at(i).observer) ) continue;
+    told.append(observers.at(i).observer);
+    observers.at(i).observer->listChanged(this);
+  } // for
+
+  return;
+}
+
+//
+// Function to report the differences between two property maps of the
+// object at path, one notify() per property that changed
+void ObjectStore::notifyMap(const QString& path, const QMap<QString,QVariant>& oldmap, const QMap<QString,QVariant>& newmap)
+{
+  if (observers.isEmpty() ) return;
+
+  QMap<QString,QVariant>::const_iterator itr;
+  for (itr = newmap.constBegin(); itr != newmap.constEnd(); ++itr) {
+    QMap<QString,QVariant>::const_iterator old = oldmap.constFind(itr.key() );
+    if (old == oldmap.constEnd() )
+      this->notify(path, itr.key(), QVariant(), itr.value() );
+    else if (old.value() != itr.value() )
+      this->notify(path, itr.key(), old.value(), itr.value() );
+  } // for
+  for (itr = oldmap.constBegin(); itr != oldmap.constEnd(); ++itr) {
+    if (! newmap.contains(itr.key()) ) this->notify(path, itr.key(), itr.value(), QVariant() );
+  } // for
+
+  return;
+}
+
+//
+// Function to rebuild the index for rows from through to (inclusive), to
+// of -1 means through the end of the list.
+void ObjectStore::reindex(int from, int to)
+{
+  if (to < 0 || to >= elements.size() ) to = elements.size() - 1;
+  for (int i = from; i <= to; ++i) {
+    index.insert(elements.at(i).objpath.path(), i);
+  } // for
+
+  return;
+}
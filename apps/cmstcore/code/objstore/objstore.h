@@ -0,0 +1,241 @@
+/**************************** objstore.h ******************************
+
+Class to hold the objects (services, technologies, peers) reported by
+connman.  Objects are kept in the order connman reports them and are
+indexed by object path so a lookup does not need to walk the list.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef OBJECT_STORE
+# define OBJECT_STORE
+
+# include <QString>
+# include <QList>
+# include <QStringList>
+# include <QHash>
+# include <QMap>
+# include <QVariant>
+# include <QMetaType>
+# include <QtDBus/QDBusObjectPath>
+# include <QtDBus/QDBusArgument>
+
+//  Values of the connman properties we test most often.  The numbering of
+//  State and Type must match the name tables in objstore.cpp.
+namespace Conn
+{
+  enum State {
+    StateUnknown      = 0,
+    StateIdle,
+    StateFailure,
+    StateAssociation,
+    StateConfiguration,
+    StateReady,
+    StateDisconnect,
+    StateOnline,
+    StateCount
+  };
+
+  enum Type {
+    TypeUnknown       = 0,
+    TypeSystem,
+    TypeEthernet,
+    TypeWifi,
+    TypeBluetooth,
+    TypeCellular,
+    TypeGps,
+    TypeVpn,
+    TypeGadget,
+    TypeP2P,
+    TypeCount
+  };
+
+  // bits, a service may offer more than one
+  enum Security {
+    SecurityNone      = 0x01,
+    SecurityWep       = 0x02,
+    SecurityPsk       = 0x04,
+    SecurityIeee8021x = 0x08,
+    SecurityWps       = 0x10
+  };
+
+  // bits, boolean properties
+  enum Flag {
+    Favorite          = 0x01,
+    Immutable         = 0x02,
+    AutoConnect       = 0x04,
+    Roaming           = 0x08,
+    Powered           = 0x10,
+    Connected         = 0x20,
+    Tethering         = 0x40
+  };
+
+  QString stateName(int);
+  QString typeName(int);
+  int typeValue(const QString&);
+} // namespace Conn
+
+//  Typed copy of the properties of a service or technology that the
+//  display code looks at.  Values are parsed once when the property
+//  arrives so a row can be tested without a map lookup and string compare.
+struct objectRecord
+{
+  objectRecord() : state(Conn::StateUnknown), type(Conn::TypeUnknown), security(0), strength(0), flags(0) {}
+
+  quint8 state;     // Conn::State
+  quint8 type;      // Conn::Type
+  quint8 security;  // Conn::Security bits
+  quint8 strength;  // 0 - 100
+  quint16 flags;    // Conn::Flag bits
+
+  bool setProperty(const QString&, const QVariant&);
+  void load(const QMap<QString,QVariant>&);
+  inline bool is(Conn::Flag f) const {return (flags & f) != 0;}
+  inline bool isConnected() const {return state == Conn::StateReady || state == Conn::StateOnline;}
+};
+
+//  Two of the connman.Manager query functions will return an array of structures.
+//  This struct provides a receiving element we can use to collect the return data.
+//  rec is kept in step with objmap by ObjectStore, and gen is set by the
+//  store each time objmap changes.  gen starts at 0, which merge() takes
+//  to mean the element has not been in a store yet.
+struct arrayElement
+{
+  arrayElement() : gen(0) {}
+
+  QDBusObjectPath objpath;
+  QMap<QString,QVariant> objmap;
+  objectRecord rec;
+  quint32 gen;
+};
+Q_DECLARE_METATYPE(arrayElement)
+
+//  One step of an edit script made by ObjectStore::editScript().  Steps are
+//  applied in order and row numbers refer to the list as it is when the
+//  step is applied.  A Move has the same meaning as QList::move().
+struct storeEdit
+{
+  enum Op {Remove, Insert, Move};
+  Op op;
+  int from;     // Remove, Move: row the item is taken from
+  int to;       // Insert, Move: row the item ends up in
+  QString key;  // the item, an object path
+};
+
+//  DBus marshalling of an arrayElement, the (oa{sv}) structure connman uses
+QDBusArgument& operator<<(QDBusArgument&, const arrayElement&);
+const QDBusArgument& operator>>(const QDBusArgument&, arrayElement&);
+
+class ObjectStore;
+
+//
+//  Interface for code that wants to be told when an ObjectStore changes,
+//  register with ObjectStore::subscribe().
+class StoreObserver
+{
+  public:
+    virtual ~StoreObserver() {}
+
+    // A property of an object we already had changed.  oldval is invalid
+    // if the property is new, newval if it went away.
+    virtual void propertyChanged(const ObjectStore*, const QString&, const QString&, const QVariant&, const QVariant&) = 0;
+
+    // Objects were added, removed or reordered
+    virtual void listChanged(const ObjectStore*) {}
+};
+
+//
+//  Ordered list of arrayElements with an object path index.  The order of
+//  the list is the order connman gave us, the index maps an object path
+//  to its row in the list.  Nested dictionary properties are stored as
+//  QVariantMap, never as a raw QDBusArgument.
+//
+//  Every change to an element gives it a new generation number, taken
+//  from a counter shared by the whole store, so a consumer can cache what
+//  it drew for an object and redraw only when the generation moves on.
+//
+//  A copy of a store shares the objects but not the observers, they
+//  subscribed to the store they were given.
+class ObjectStore
+{
+  public:
+    ObjectStore();
+    ObjectStore(const ObjectStore&);
+    ObjectStore& operator=(const ObjectStore&);
+    static void registerMetaTypes();
+    static QList<storeEdit> editScript(const QStringList&, const QStringList&);
+
+  // functions
+    inline int size() const {return elements.size();}
+    inline int count() const {return elements.size();}
+    inline bool isEmpty() const {return elements.isEmpty();}
+    inline const arrayElement& at(int i) const {return elements.at(i);}
+    inline const QList<arrayElement>& list() const {return elements;}
+    inline bool contains(const QDBusObjectPath& path) const {return index.contains(path.path());}
+    inline bool contains(const QString& path) const {return index.contains(path);}
+    inline int indexOf(const QDBusObjectPath& path) const {return index.value(path.path(), -1);}
+    inline int indexOf(const QString& path) const {return index.value(path, -1);}
+    const arrayElement* find(const QString&) const;
+    inline const arrayElement* find(const QDBusObjectPath& path) const {return find(path.path());}
+    inline quint32 generation() const {return store_gen;}
+    quint32 generation(const QString&) const;
+    void subscribe(StoreObserver*, const QString& path = QString(), const QString& property = QString() );
+    void unsubscribe(StoreObserver*);
+
+    void clear();
+    void setList(const QList<arrayElement>&);
+    void append(const arrayElement&);
+    void replace(int, const arrayElement&);
+    void removeAt(int);
+    bool remove(const QDBusObjectPath&);
+    int remove(const QList<QDBusObjectPath>&);
+    bool setProperty(const QString&, const QString&, const QVariant&);
+    bool merge(const QVariant&, bool b_full = false);
+    QList<QDBusObjectPath> adopt(const ObjectStore&);
+    qint64 memoryUsage(qint64&) const;
+
+  private:
+  // members
+    QList<arrayElement> elements;
+    QHash<QString,int> index;
+    quint32 store_gen;
+
+    // an observer and the object path and property it wants, empty for all
+    struct subscription
+    {
+      StoreObserver* observer;
+      QString path;
+      QString property;
+    };
+    QList<subscription> observers;
+
+  // functions
+    void reindex(int from = 0, int to = -1);
+    void applyScript(const QList<storeEdit>&);
+    void touch(int);
+    void notify(const QString&, const QString&, const QVariant&, const QVariant&);
+    void notifyList();
+    void notifyMap(const QString&, const QMap<QString,QVariant>&, const QMap<QString,QVariant>&);
+};
+
+# endif
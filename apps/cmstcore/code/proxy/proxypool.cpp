@@ -0,0 +1,92 @@
+/**************************** proxypool.cpp ****************************
+
+Class to hold the DBus proxies for the connman service and technology
+objects.  One proxy is kept for each object path for as long as connman
+reports the object.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include "./proxypool.h"
+
+# define DBUS_CON_SERVICE "net.connman"
+
+// Constructor
+ProxyPool::ProxyPool(const QDBusConnection& connection, QObject* parent) : QObject(parent),
+  bus(connection)
+{
+  services.clear();
+  technologies.clear();
+}
+
+////////////////////////////// Public Functions ////////////////////////////
+//
+// Function to return the proxy for the service at path.  The proxy is
+// created the first time it is asked for.
+NetConnmanServiceInterface* ProxyPool::service(const QString& path)
+{
+  NetConnmanServiceInterface* proxy = services.value(path, 0);
+  if (proxy == 0) {
+    proxy = new NetConnmanServiceInterface(DBUS_CON_SERVICE, path, bus, this);
+    services.insert(path, proxy);
+  } // if new
+
+  return proxy;
+}
+
+//
+// Function to return the proxy for the technology at path.  The proxy is
+// created the first time it is asked for.
+NetConnmanTechnologyInterface* ProxyPool::technology(const QString& path)
+{
+  NetConnmanTechnologyInterface* proxy = technologies.value(path, 0);
+  if (proxy == 0) {
+    proxy = new NetConnmanTechnologyInterface(DBUS_CON_SERVICE, path, bus, this);
+    technologies.insert(path, proxy);
+  } // if new
+
+  return proxy;
+}
+
+//
+// Function to drop the proxy for an object connman has removed.  Calls in
+// flight on the proxy still deliver their reply, the reply belongs to the
+// pending call and not to the proxy.
+void ProxyPool::remove(const QString& path)
+{
+  if (services.contains(path) ) services.take(path)->deleteLater();
+  if (technologies.contains(path) ) technologies.take(path)->deleteLater();
+
+  return;
+}
+
+//
+// Function to drop the proxies for a list of removed objects
+void ProxyPool::remove(const QList<QDBusObjectPath>& paths)
+{
+  for (int i = 0; i < paths.size(); ++i) {
+    remove(paths.at(i).path() );
+  } // for
+
+  return;
+}
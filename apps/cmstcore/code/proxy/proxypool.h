@@ -0,0 +1,68 @@
+/**************************** proxypool.h *****************************
+
+Class to hold the DBus proxies for the connman service and technology
+objects.  One proxy is kept for each object path for as long as connman
+reports the object.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef PROXY_POOL
+# define PROXY_POOL
+
+# include <QObject>
+# include <QString>
+# include <QHash>
+# include <QList>
+# include <QtDBus/QDBusConnection>
+# include <QtDBus/QDBusObjectPath>
+
+# include "service_interface.h"
+# include "technology_interface.h"
+
+//
+//  The proxies are generated from the XML files in this directory.  Unlike
+//  QDBusInterface they never introspect the remote object, so a method call
+//  is a single round trip to connman.
+class ProxyPool : public QObject
+{
+  Q_OBJECT
+
+  public:
+    ProxyPool(const QDBusConnection&, QObject* parent = 0);
+
+  // functions
+    NetConnmanServiceInterface* service(const QString&);
+    NetConnmanTechnologyInterface* technology(const QString&);
+    void remove(const QString&);
+    void remove(const QList<QDBusObjectPath>&);
+    inline int count() const {return services.size() + technologies.size();}
+
+  private:
+  // members
+    QDBusConnection bus;
+    QHash<QString, NetConnmanServiceInterface*> services;
+    QHash<QString, NetConnmanTechnologyInterface*> technologies;
+};
+
+# endif
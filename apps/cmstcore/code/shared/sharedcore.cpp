@@ -0,0 +1,165 @@
+/**************************** sharedcore.cpp ***************************
+Functions shared across various classes that need neither widgets nor
+a running GUI.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QCoreApplication>
+
+# include "./sharedcore.h"
+# include "./code/trstring/tr_strings.h"
+
+//  Address of the bus connman is on, empty for the system bus
+static QString bus_address;
+
+//  Name of the connection opened by connmanBus() when the address is set
+# define CONNMAN_BUS_CONNECTION "cmst_connman"
+
+//
+//  Function to extract the data from a QDBusArgument that contains a map.
+//  Some of the arrayElements can contain a QDBusArgument as the object
+//  instead of a primitive (string, bool, int, etc.). This function
+//  will extract the data from the QDBusArgument and write it into a map.
+//
+//  Return value a bool, true on success, false otherwise.
+//  The map is sent by reference (called r_map here) and is modified by this function.
+//  r_var is a constant reference to the QDBusArgument.
+//
+bool shared::extractMapData(QMap<QString,QVariant>& r_map, const QVariant& r_var)
+{
+  // values from an ObjectStore have already been demarshalled into a map
+  if (r_var.type() == QVariant::Map) {
+    r_map = r_var.toMap();
+    return true;
+  }
+
+  //  make sure we can convert the QVariant into a QDBusArgument
+  if (! r_var.canConvert<QDBusArgument>() ) return false;
+  const QDBusArgument qdba =  r_var.value<QDBusArgument>();
+
+  // make sure the QDBusArgument holds a map
+  if (qdba.currentType() != QDBusArgument::MapType ) return false;
+
+  // iterate over the QDBusArgument pulling map keys and values out
+    r_map.clear();
+    qdba.beginMap();
+
+    while ( ! qdba.atEnd() ) {
+      QString key;
+      QVariant value;
+      qdba.beginMapEntry();
+      qdba >> key >> value;
+      qdba.endMapEntry();
+      r_map.insert(key, value);
+    } // while
+
+    qdba.endMap();
+    return true;
+}
+
+//
+//  Function to extract a QMap from a DBus reply message (that contains a map).
+//  This data type is returned by GetProperties
+//
+//  Return value a bool, true on success, false otherwise.
+//  The map is sent by reference (called r_map here) and is modified by this function.
+//  r_msg is a constant reference to the DBus reply message.
+bool shared::getMap(QMap<QString,QVariant>& r_map, const QDBusMessage& r_msg )
+{
+  // make sure r_msg is a QDBusArgument
+  if ( ! r_msg.arguments().at(0).canConvert<QDBusArgument>() ) return false;
+
+  // make sure the QDBusArgument holds a map
+  const QDBusArgument &qdb_arg = r_msg.arguments().at(0).value<QDBusArgument>();
+  if (qdb_arg.currentType() != QDBusArgument::MapType ) return false;
+
+  // iterate over the QDBusArgument pulling map keys and values out
+  qdb_arg.beginMap();
+  r_map.clear();
+
+  while ( ! qdb_arg.atEnd() ) {
+    QString key;
+    QVariant value;
+    qdb_arg.beginMapEntry();
+    qdb_arg >> key >> value;
+    qdb_arg.endMapEntry();
+    r_map.insert(key, value);
+  }
+  qdb_arg.endMap();
+
+  return true;
+}
+
+//
+//  Function to return the name to display for a service.  Ethernet services
+//  get their interface name appended, WiFi services without a name are
+//  hidden networks.
+QString shared::nickName(const arrayElement& ae)
+{
+  if (ae.rec.type == Conn::TypeEthernet) {
+    const QMap<QString,QVariant> submap = ae.objmap.value("Ethernet").toMap();
+    if (submap.value("Interface").toString().isEmpty() )
+      return ae.objmap.value("Name").toString();
+    else
+      return QString(TranslateStrings::cmtr(ae.objmap.value("Name").toString()) + " [%1]").arg(submap.value("Interface").toString() );
+  } // if type ethernet
+
+  else if (ae.rec.type == Conn::TypeWifi && ae.objmap.value("Name").toString().isEmpty() )
+    return QCoreApplication::translate("ControlBox", "[Hidden Wifi]");
+
+  return ae.objmap.value("Name").toString();
+}
+
+//
+//  Function to set the address of the bus to find connman on, for instance
+//  a private dbus-daemon running a stand-in for connman.  Must be called
+//  before the first call to connmanBus().  An empty address selects the
+//  system bus.
+void shared::setBusAddress(const QString& address)
+{
+  bus_address = address;
+
+  return;
+}
+
+//
+//  Function to return the connection to the bus connman is on.  Interfaces,
+//  signal subscriptions and the objects connman calls back (agents, counter)
+//  must all use this connection.
+QDBusConnection shared::connmanBus()
+{
+  if (bus_address.isEmpty() ) return QDBusConnection::systemBus();
+
+  return QDBusConnection::connectToBus(bus_address, CONNMAN_BUS_CONNECTION);
+}
+
+//
+//  Function to open a second, private, connection named name to the bus
+//  connman is on.  Used by threads that need a connection of their own.
+QDBusConnection shared::connectConnmanBus(const QString& name)
+{
+  if (bus_address.isEmpty() ) return QDBusConnection::connectToBus(QDBusConnection::SystemBus, name);
+
+  return QDBusConnection::connectToBus(bus_address, name);
+}
@@ -0,0 +1,50 @@
+/**************************** sharedcore.h ***************************
+Functions shared across various classes that need neither widgets nor
+a running GUI.  shared.h includes this file.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef CMST_SHARED_CORE
+# define CMST_SHARED_CORE
+
+# include <QtDBus/QDBusConnection>
+# include <QtDBus/QDBusMessage>
+# include <QtDBus/QDBusArgument>
+# include <QString>
+# include <QMap>
+# include <QVariant>
+
+# include "../objstore/objstore.h"
+
+namespace shared {
+
+bool extractMapData(QMap<QString,QVariant>&,const QVariant&);
+bool getMap(QMap<QString,QVariant>&, const QDBusMessage&);
+QString nickName(const arrayElement&);
+void setBusAddress(const QString&);
+QDBusConnection connmanBus();
+QDBusConnection connectConnmanBus(const QString&);
+
+}
+#endif
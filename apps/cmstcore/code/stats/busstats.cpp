@@ -0,0 +1,345 @@
+/**************************** busstats.cpp ****************************
+
+Counters for the D-Bus traffic we see.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QHash>
+# include <QByteArray>
+
+# include <atomic>
+# include <cstring>
+
+# include "./busstats.h"
+# include "../trace/trace.h"
+
+//  Table sizes, power of 2.  A signal or method that does not fit is only
+//  counted in dropped().
+# define STATS_SIGNAL_SLOTS 512
+# define STATS_CALL_SLOTS 64
+
+//  Longest object path or method name kept, longer ones are cut
+# define STATS_KEY_LEN 96
+
+//  Seconds of history for the rates
+# define STATS_SECONDS 60
+
+//  Latency histogram bins: 4 bins per power of 2 microseconds, enough
+//  for calls of over an hour.
+# define STATS_HIST_BINS 128
+
+namespace
+{
+  // per second counts, a bucket is reused when its second comes round again
+  struct secondBuckets
+  {
+    std::atomic<quint32> second[STATS_SECONDS];
+    std::atomic<quint32> count[STATS_SECONDS];
+  };
+
+  // A slot is claimed by setting hash from 0, the key is written next and
+  // ready is set last.  Slots are never given back.
+  struct signalSlot
+  {
+    std::atomic<quint32> hash;
+    std::atomic<bool> ready;
+    quint8 sig;
+    char key[STATS_KEY_LEN];
+    std::atomic<quint32> total;
+    std::atomic<qint64> busy_us;
+    secondBuckets buckets;
+  };
+
+  struct callSlot
+  {
+    std::atomic<quint32> hash;
+    std::atomic<bool> ready;
+    char key[STATS_KEY_LEN];
+    std::atomic<quint32> total;
+    std::atomic<qint64> max_us;
+    std::atomic<quint32> hist[STATS_HIST_BINS];
+  };
+
+  // static storage is zero initialized, which is the empty state
+  signalSlot signal_table[STATS_SIGNAL_SLOTS];
+  callSlot call_table[STATS_CALL_SLOTS];
+  std::atomic<quint32> dropped_count(0);
+
+  const char* const signal_names[] = {
+    "Manager.PropertyChanged",
+    "Manager.ServicesChanged",
+    "Manager.PeersChanged",
+    "Manager.TechnologyAdded",
+    "Manager.TechnologyRemoved",
+    "Service.PropertyChanged",
+    "Technology.PropertyChanged",
+    "Counter.Usage"
+  };
+  static_assert(sizeof(signal_names) / sizeof(signal_names[0]) == BusStats::SignalCount, "signal_names does not match BusStats::Signal");
+
+  inline quint32 currentSecond()
+  {
+    return quint32(Trace::now() / 1000000);
+  }
+
+  // copy a key into a slot, cut to fit
+  void setKey(char* dest, const QByteArray& key)
+  {
+    const int len = qMin(key.size(), STATS_KEY_LEN - 1);
+    std::memcpy(dest, key.constData(), len);
+    dest[len] = '\0';
+  }
+
+  bool sameKey(const char* slotkey, const QByteArray& key)
+  {
+    const int len = qMin(key.size(), STATS_KEY_LEN - 1);
+    return std::strncmp(slotkey, key.constData(), len) == 0 && slotkey[len] == '\0';
+  }
+
+  // Find or claim the slot for key in table.  sig is only stored in signal
+  // slots, extra is mixed into the hash so the same path under two signals
+  // gets two slots.  Returns 0 if the table is full.
+  template <class T>
+  T* findSlot(T* table, int size, const QByteArray& key, int extra, bool (*match)(const T&, const QByteArray&, int), void (*init)(T&, const QByteArray&, int))
+  {
+    quint32 h = qHash(key) ^ (quint32(extra) * 0x9e3779b9u);
+    if (h == 0) h = 1;
+
+    for (int n = 0; n < size; ++n) {
+      T& slot = table[(h + n) & (size - 1)];
+      quint32 cur = slot.hash.load(std::memory_order_acquire);
+      if (cur == 0) {
+        if (slot.hash.compare_exchange_strong(cur, h, std::memory_order_acq_rel) ) {
+          init(slot, key, extra);
+          slot.ready.store(true, std::memory_order_release);
+          return &slot;
+        } // if we claimed the slot
+        // cur now holds the hash of whoever beat us to it
+      } // if free
+      if (cur != h) continue;
+      while (! slot.ready.load(std::memory_order_acquire) ) {}
+      if (match(slot, key, extra) ) return &slot;
+    } // for
+
+    dropped_count.fetch_add(1, std::memory_order_relaxed);
+    return 0;
+  }
+
+  bool matchSignal(const signalSlot& slot, const QByteArray& key, int sig)
+  {
+    return slot.sig == sig && sameKey(slot.key, key);
+  }
+
+  void initSignal(signalSlot& slot, const QByteArray& key, int sig)
+  {
+    slot.sig = quint8(sig);
+    setKey(slot.key, key);
+  }
+
+  bool matchCall(const callSlot& slot, const QByteArray& key, int)
+  {
+    return sameKey(slot.key, key);
+  }
+
+  void initCall(callSlot& slot, const QByteArray& key, int)
+  {
+    setKey(slot.key, key);
+  }
+
+  // count one event in the bucket for this second.  Reusing a bucket may
+  // lose an event counted by another thread at the same moment, the rates
+  // are for display and that is good enough.
+  void countSecond(secondBuckets& b, quint32 sec)
+  {
+    const int i = sec % STATS_SECONDS;
+    if (b.second[i].load(std::memory_order_relaxed) != sec) {
+      if (b.second[i].exchange(sec, std::memory_order_relaxed) != sec)
+        b.count[i].store(0, std::memory_order_relaxed);
+    } // if bucket is from an earlier minute
+    b.count[i].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // events per second over the window seconds before the current one
+  double rate(const secondBuckets& b, quint32 now, quint32 window)
+  {
+    quint32 sum = 0;
+    for (int i = 0; i < STATS_SECONDS; ++i) {
+      const quint32 age = now - b.second[i].load(std::memory_order_relaxed);
+      if (age >= 1 && age <= window) sum += b.count[i].load(std::memory_order_relaxed);
+    } // for
+
+    return double(sum) / window;
+  }
+
+  // histogram bin for a latency, 4 bins per power of 2
+  int histBin(qint64 us)
+  {
+    if (us < 4) return us < 0 ? 0 : int(us);
+
+    int e = 63 - __builtin_clzll(quint64(us) );
+    int bin = 4 * (e - 1) + int((us >> (e - 2)) & 3);
+
+    return qMin(bin, STATS_HIST_BINS - 1);
+  }
+
+  // upper bound of a histogram bin
+  qint64 binLimit(int bin)
+  {
+    if (bin < 4) return bin;
+    const int e = bin / 4 + 1;
+    const int sub = bin % 4;
+
+    return (qint64(4 + sub + 1) << (e - 2)) - 1;
+  }
+} // namespace
+
+//
+//  Function to return the name of a BusStats::Signal
+QString BusStats::signalName(int sig)
+{
+  return (sig >= 0 && sig < SignalCount) ? QString(signal_names[sig]) : QString();
+}
+
+//
+//  Function to count one signal sig for the object at path, busy_us is
+//  the time spent handling it.
+void BusStats::signal(Signal sig, const QString& path, qint64 busy_us)
+{
+  signalSlot* slot = findSlot<signalSlot>(signal_table, STATS_SIGNAL_SLOTS, path.toUtf8(), sig, matchSignal, initSignal);
+  if (slot == 0) return;
+
+  slot->total.fetch_add(1, std::memory_order_relaxed);
+  slot->busy_us.fetch_add(busy_us, std::memory_order_relaxed);
+  countSecond(slot->buckets, currentSecond() );
+
+  return;
+}
+
+//
+//  Function to record a call of method that took us microseconds from
+//  sending it to the reply.
+void BusStats::call(const QString& method, qint64 us)
+{
+  callSlot* slot = findSlot<callSlot>(call_table, STATS_CALL_SLOTS, method.toUtf8(), 0, matchCall, initCall);
+  if (slot == 0) return;
+
+  slot->total.fetch_add(1, std::memory_order_relaxed);
+  slot->hist[histBin(us)].fetch_add(1, std::memory_order_relaxed);
+  qint64 cur = slot->max_us.load(std::memory_order_relaxed);
+  while (us > cur && ! slot->max_us.compare_exchange_weak(cur, us, std::memory_order_relaxed) ) {}
+
+  return;
+}
+
+//
+//  Function to read the signal table, one row per signal and object path.
+QList<BusStats::signalRow> BusStats::signalRows()
+{
+  QList<signalRow> rows;
+  const quint32 now = currentSecond();
+
+  for (int i = 0; i < STATS_SIGNAL_SLOTS; ++i) {
+    const signalSlot& slot = signal_table[i];
+    if (! slot.ready.load(std::memory_order_acquire) ) continue;
+
+    signalRow row;
+    row.signal = slot.sig;
+    row.path = QString::fromUtf8(slot.key);
+    row.count = slot.total.load(std::memory_order_relaxed);
+    row.rate1 = rate(slot.buckets, now, 1);
+    row.rate10 = rate(slot.buckets, now, 10);
+    row.rate60 = rate(slot.buckets, now, 60);
+    row.busy_us = slot.busy_us.load(std::memory_order_relaxed);
+    rows.append(row);
+  } // for
+
+  return rows;
+}
+
+//
+//  Function to read the method call table.  Percentiles are read from the
+//  histogram and are the upper bound of their bin, within 25%.
+QList<BusStats::callRow> BusStats::callRows()
+{
+  QList<callRow> rows;
+
+  for (int i = 0; i < STATS_CALL_SLOTS; ++i) {
+    const callSlot& slot = call_table[i];
+    if (! slot.ready.load(std::memory_order_acquire) ) continue;
+
+    quint32 hist[STATS_HIST_BINS];
+    quint32 total = 0;
+    for (int b = 0; b < STATS_HIST_BINS; ++b) {
+      hist[b] = slot.hist[b].load(std::memory_order_relaxed);
+      total += hist[b];
+    } // for
+
+    callRow row;
+    row.method = QString::fromUtf8(slot.key);
+    row.count = total;
+    row.p50_us = 0;
+    row.p99_us = 0;
+    row.max_us = slot.max_us.load(std::memory_order_relaxed);
+
+    // rank of the 50th and 99th percentile, counting from 1
+    const quint64 r50 = (quint64(total) * 50 + 99) / 100;
+    const quint64 r99 = (quint64(total) * 99 + 99) / 100;
+    quint64 seen = 0;
+    for (int b = 0; b < STATS_HIST_BINS && total > 0; ++b) {
+      const quint64 before = seen;
+      seen += hist[b];
+      if (before < r50 && seen >= r50) row.p50_us = qMin(binLimit(b), row.max_us);
+      if (before < r99 && seen >= r99) {
+        row.p99_us = qMin(binLimit(b), row.max_us);
+        break;
+      } // if
+    } // for
+
+    rows.append(row);
+  } // for
+
+  return rows;
+}
+
+//
+//  Function to return the number of events not counted because a table
+//  was full.
+quint32 BusStats::dropped()
+{
+  return dropped_count.load(std::memory_order_relaxed);
+}
+
+//
+//  Constructor, starts the clock
+BusStatsTimer::BusStatsTimer(BusStats::Signal s, const QString& p) : sig(s), path(p)
+{
+  ts = Trace::now();
+}
+
+//
+//  Destructor, counts the signal
+BusStatsTimer::~BusStatsTimer()
+{
+  BusStats::signal(sig, path, Trace::now() - ts);
+}
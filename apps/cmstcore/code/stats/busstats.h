@@ -0,0 +1,102 @@
+/**************************** busstats.h ******************************
+
+Counters for the D-Bus traffic we see: signals per signal type and
+object path, the time spent handling them, and the latency of the
+method calls we make.  All counters live in fixed size tables and are
+updated with atomic operations only, so they are cheap enough to leave
+on and may be updated from any thread.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef CMST_BUSSTATS
+# define CMST_BUSSTATS
+
+# include <QString>
+# include <QList>
+# include <QtGlobal>
+
+namespace BusStats
+{
+  // the signals (and calls connman makes to us) we count
+  enum Signal {
+    ManagerPropertyChanged = 0,
+    ServicesChanged,
+    PeersChanged,
+    TechnologyAdded,
+    TechnologyRemoved,
+    ServicePropertyChanged,
+    TechnologyPropertyChanged,
+    CounterUsage,
+    SignalCount
+  };
+
+  // one row of the signal table, as read by signalRows()
+  struct signalRow
+  {
+    int signal;           // BusStats::Signal
+    QString path;
+    quint32 count;        // since start
+    double rate1;         // per second over the last 1, 10 and 60 seconds
+    double rate10;
+    double rate60;
+    qint64 busy_us;       // total time spent in the handler
+  };
+
+  // one row of the method call table, as read by callRows()
+  struct callRow
+  {
+    QString method;
+    quint32 count;
+    qint64 p50_us;
+    qint64 p99_us;
+    qint64 max_us;
+  };
+
+  QString signalName(int);
+  void signal(Signal, const QString&, qint64);
+  void call(const QString&, qint64);
+  QList<signalRow> signalRows();
+  QList<callRow> callRows();
+  quint32 dropped();
+} // namespace BusStats
+
+//
+//  Counts one signal and the time from construction to destruction as the
+//  time spent handling it.
+class BusStatsTimer
+{
+  public:
+    BusStatsTimer(BusStats::Signal, const QString&);
+    ~BusStatsTimer();
+
+  private:
+    BusStats::Signal sig;
+    QString path;
+    qint64 ts;
+
+    BusStatsTimer(const BusStatsTimer&);
+    BusStatsTimer& operator=(const BusStatsTimer&);
+};
+
+# endif
@@ -0,0 +1,194 @@
+/**************************** trace.cpp *******************************
+
+Span tracing for finding where the time goes.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QCoreApplication>
+# include <QFile>
+# include <QTextStream>
+
+# include <chrono>
+# include <vector>
+
+# include "./trace.h"
+
+//  Number of spans the ring buffer holds, must be a power of 2.  When it
+//  is full the oldest spans are overwritten.
+# define TRACE_CAPACITY (1u << 16)
+
+namespace
+{
+  struct traceEvent
+  {
+    const char* name;   // 0 if the slot was never written
+    const char* cat;
+    qint64 ts;          // microseconds since the trace clock started
+    qint64 dur;
+    quint32 tid;
+  };
+
+  struct threadName
+  {
+    quint32 tid;
+    const char* name;
+  };
+
+  std::vector<traceEvent> ring;
+  std::atomic<quint32> next_slot(0);
+  std::atomic<quint32> next_tid(1);
+  QString trace_file;
+
+  // thread names are few and set at thread start, guard them with a flag
+  std::vector<threadName> thread_names;
+  std::atomic_flag names_lock = ATOMIC_FLAG_INIT;
+
+  const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+  // small sequential thread ids read better in the viewer than pthread ids
+  quint32 threadId()
+  {
+    static thread_local quint32 tid = next_tid.fetch_add(1, std::memory_order_relaxed);
+    return tid;
+  }
+
+  // write a string as a JSON string, the names we record are plain ASCII
+  // but escape quotes and backslashes anyway
+  QString jsonString(const char* s)
+  {
+    QString rtn = QString::fromUtf8(s);
+    rtn.replace('\\', "\\\\");
+    rtn.replace('"', "\\\"");
+    return QString("\"%1\"").arg(rtn);
+  }
+} // namespace
+
+std::atomic<bool> Trace::enabled(false);
+std::atomic<const char*> Trace::gui_site(nullptr);
+thread_local bool Trace::gui_thread = false;
+
+//
+//  Function to start tracing, the trace is written to file by stop().
+//  Return false if the file can't be written.
+bool Trace::start(const QString& file)
+{
+  QFile f(file);
+  if (! f.open(QIODevice::WriteOnly | QIODevice::Truncate) ) return false;
+  f.close();
+
+  trace_file = file;
+  ring.assign(TRACE_CAPACITY, traceEvent() );
+  next_slot.store(0, std::memory_order_relaxed);
+  enabled.store(true, std::memory_order_release);
+
+  return true;
+}
+
+//
+//  Function to stop tracing and write the ring buffer to the trace file.
+//  Threads that may still be recording must have finished before this is
+//  called.  Return false if nothing was written.
+bool Trace::stop()
+{
+  if (! enabled.exchange(false) ) return false;
+
+  QFile f(trace_file);
+  if (! f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text) ) return false;
+  QTextStream out(&f);
+
+  const qint64 pid = QCoreApplication::applicationPid();
+  out << "{\"traceEvents\":[";
+  bool b_first = true;
+
+  // metadata naming the threads
+  while (names_lock.test_and_set(std::memory_order_acquire) ) {}
+  for (size_t i = 0; i < thread_names.size(); ++i) {
+    out << (b_first ? "\n" : ",\n");
+    b_first = false;
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << thread_names.at(i).tid
+        << ",\"args\":{\"name\":" << jsonString(thread_names.at(i).name) << "}}";
+  } // for
+  names_lock.clear(std::memory_order_release);
+
+  // oldest span first
+  const quint32 end = next_slot.load(std::memory_order_acquire);
+  const quint32 begin = end > TRACE_CAPACITY ? end - TRACE_CAPACITY : 0;
+  for (quint32 i = begin; i != end; ++i) {
+    const traceEvent& ev = ring.at(i & (TRACE_CAPACITY - 1) );
+    if (ev.name == 0) continue;
+    out << (b_first ? "\n" : ",\n");
+    b_first = false;
+    out << "{\"name\":" << jsonString(ev.name) << ",\"cat\":" << jsonString(ev.cat)
+        << ",\"ph\":\"X\",\"ts\":" << ev.ts << ",\"dur\":" << ev.dur
+        << ",\"pid\":" << pid << ",\"tid\":" << ev.tid << "}";
+  } // for
+
+  // the steady clock at ts 0, so other processes can line their own
+  // clock readings up with the spans
+  const qint64 base = std::chrono::duration_cast<std::chrono::microseconds>(epoch.time_since_epoch() ).count();
+  out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"steady_clock_epoch_us\":" << base << "}}\n";
+  std::vector<traceEvent>().swap(ring);
+
+  return out.status() == QTextStream::Ok;
+}
+
+//
+//  Function to return the trace clock, in microseconds.
+qint64 Trace::now()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+//
+//  Function to record a span that started at ts and ended at end (now if
+//  end is negative), both read from now().  Does nothing when tracing is
+//  off, so callers can time a phase without testing isEnabled() first.
+void Trace::complete(const char* name, const char* cat, qint64 ts, qint64 end)
+{
+  if (! isEnabled() ) return;
+  if (end < 0) end = now();
+
+  traceEvent& ev = ring[next_slot.fetch_add(1, std::memory_order_relaxed) & (TRACE_CAPACITY - 1)];
+  ev.cat = cat;
+  ev.ts = ts;
+  ev.dur = end - ts;
+  ev.tid = threadId();
+  ev.name = name;
+
+  return;
+}
+
+//
+//  Function to name the calling thread in the trace.  name must be a
+//  string literal.
+void Trace::setThreadName(const char* name)
+{
+  threadName tn = {threadId(), name};
+
+  while (names_lock.test_and_set(std::memory_order_acquire) ) {}
+  thread_names.push_back(tn);
+  names_lock.clear(std::memory_order_release);
+
+  return;
+}
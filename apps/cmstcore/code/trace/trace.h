@@ -0,0 +1,88 @@
+/**************************** trace.h *********************************
+
+Span tracing for finding where the time goes.  Spans are kept in a ring
+buffer in memory and written out as Chrome trace-event JSON (readable by
+chrome://tracing and Perfetto) when tracing stops.  Tracing is compiled
+in but does nothing until start() is called.
+
+Whether or not tracing is on, the innermost open span of the GUI thread
+is kept as the current site so the stall watchdog can say where the GUI
+thread was when it stopped responding.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef CMST_TRACE_H
+# define CMST_TRACE_H
+
+# include <QString>
+# include <QtGlobal>
+
+# include <atomic>
+
+namespace Trace
+{
+  extern std::atomic<bool> enabled;
+  extern std::atomic<const char*> gui_site;
+  extern thread_local bool gui_thread;
+
+  bool start(const QString&);
+  bool stop();
+  qint64 now();
+  void complete(const char*, const char*, qint64, qint64 end = -1);
+  void setThreadName(const char*);
+  inline bool isEnabled() {return enabled.load(std::memory_order_relaxed);}
+
+  // call once from the GUI thread, sites are only kept for that thread
+  inline void markGuiThread() {gui_thread = true;}
+  inline const char* currentSite() {return gui_site.load(std::memory_order_relaxed);}
+  inline const char* enterSite(const char* site) {return gui_thread ? gui_site.exchange(site, std::memory_order_relaxed) : 0;}
+  inline void leaveSite(const char* prev) {if (gui_thread) gui_site.store(prev, std::memory_order_relaxed);}
+} // namespace Trace
+
+//
+//  Records the time from construction to destruction as one span.  name
+//  and category must be string literals (or otherwise outlive the trace),
+//  only the pointers are stored.
+class TraceSpan
+{
+  public:
+    inline TraceSpan(const char* n, const char* c) : name(n), cat(c), prev_site(Trace::enterSite(n)), ts(Trace::isEnabled() ? Trace::now() : -1) {}
+    inline ~TraceSpan() {if (ts >= 0) Trace::complete(name, cat, ts); Trace::leaveSite(prev_site);}
+
+  private:
+    const char* name;
+    const char* cat;
+    const char* prev_site;
+    qint64 ts;
+
+    TraceSpan(const TraceSpan&);
+    TraceSpan& operator=(const TraceSpan&);
+};
+
+//  Trace the rest of the enclosing scope
+# define CMST_TRACE_CAT2(a,b) a##b
+# define CMST_TRACE_CAT(a,b) CMST_TRACE_CAT2(a,b)
+# define CMST_TRACE(name, cat) TraceSpan CMST_TRACE_CAT(trace_span_, __LINE__)(name, cat)
+
+# endif
@@ -0,0 +1,130 @@
+/**************************** watchdog.cpp ****************************
+
+Thread to notice when the GUI thread stops processing events.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QCoreApplication>
+
+# include <syslog.h>
+
+# include "./watchdog.h"
+# include "../resource.h"
+# include "../trace/trace.h"
+
+//  Constructor, must be called from the GUI thread.  A stall is reported
+//  when the GUI thread has not processed events for threshold milliseconds.
+Watchdog::Watchdog(int threshold, QObject* parent) : QThread(parent)
+{
+  threshold_us = qint64(threshold) * 1000;
+  beat_ms = qMax(threshold / 4, 10);
+  heartbeat.store(Trace::now() );
+
+  // the timer lives in the GUI thread, the thread we watch
+  Trace::markGuiThread();
+  beat_timer = new QTimer(this);
+  beat_timer->setInterval(beat_ms);
+  connect(beat_timer, SIGNAL(timeout()), this, SLOT(beat()));
+  beat_timer->start();
+}
+
+////////////////////////////// Public Functions ////////////////////////////
+//
+//  Function to stop the watchdog thread and wait for it to finish
+void Watchdog::stop()
+{
+  beat_timer->stop();
+  this->requestInterruption();
+  this->wait();
+
+  return;
+}
+
+////////////////////////////// Protected Functions /////////////////////////
+//
+//  The watchdog thread.  Polls the heartbeat a few times per threshold,
+//  a stall is logged when it starts and again when the GUI thread
+//  responds, then stalled() is emitted with its length.
+void Watchdog::run()
+{
+  bool b_stalled = false;
+  qint64 stall_start = 0;
+  const char* stall_site = 0;
+
+  while (! this->isInterruptionRequested() ) {
+    QThread::msleep(beat_ms);
+    const qint64 last = heartbeat.load();
+
+    if (! b_stalled) {
+      const qint64 late = Trace::now() - last;
+      if (late < threshold_us) continue;
+      b_stalled = true;
+      stall_start = last;
+      stall_site = Trace::currentSite();
+      logStall(tr("The GUI has not responded for %1 ms, it is busy in %2").arg(late / 1000).arg(siteName(stall_site)) );
+    } // if not stalled
+
+    else {
+      // the site may only be entered after the stall was noticed
+      if (stall_site == 0) stall_site = Trace::currentSite();
+      if (last == stall_start) continue;
+      b_stalled = false;
+      const int ms = qMax(int((last - stall_start) / 1000) - beat_ms, 0);
+      logStall(tr("The GUI responded again after %1 ms in %2").arg(ms).arg(siteName(stall_site)) );
+      emit stalled(siteName(stall_site), ms);
+    } // else stalled
+  } // while
+
+  return;
+}
+
+////////////////////////////// Private Functions ///////////////////////////
+//
+//  Function to return a printable name for a call site
+QString Watchdog::siteName(const char* site)
+{
+  return site == 0 ? tr("the event loop") : QString::fromLatin1(site);
+}
+
+//
+//  Function to write a stall message to the system log, see
+//  ControlBox::logErrors() for the options.
+void Watchdog::logStall(const QString& msg)
+{
+  openlog(qPrintable(LOG_NAME), LOG_PID|LOG_CONS, LOG_USER);
+  syslog(LOG_WARNING, "%s", msg.toUtf8().constData() );
+  closelog();
+
+  return;
+}
+
+////////////////////////////// Private Slots ///////////////////////////////
+//
+//  Slot called from beat_timer in the GUI thread
+void Watchdog::beat()
+{
+  heartbeat.store(Trace::now() );
+
+  return;
+}
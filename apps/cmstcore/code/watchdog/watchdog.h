@@ -0,0 +1,69 @@
+/**************************** watchdog.h ******************************
+
+Thread to notice when the GUI thread stops processing events.  The GUI
+thread sets a heartbeat from a timer, the watchdog thread checks it and
+reports a stall, and the traced call site the GUI thread was in, when
+the heartbeat is late.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef CMST_WATCHDOG
+# define CMST_WATCHDOG
+
+# include <QThread>
+# include <QTimer>
+# include <QString>
+
+# include <atomic>
+
+class Watchdog : public QThread
+{
+  Q_OBJECT
+
+  public:
+    Watchdog(int, QObject* parent = 0);
+    void stop();
+
+  signals:
+    void stalled(const QString&, int);
+
+  protected:
+    void run();
+
+  private:
+  // members
+    qint64 threshold_us;
+    int beat_ms;
+    QTimer* beat_timer;
+    std::atomic<qint64> heartbeat;
+
+  // functions
+    QString siteName(const char*);
+    void logStall(const QString&);
+
+  private slots:
+    void beat();
+};
+
+# endif
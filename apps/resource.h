@@ -74,6 +74,16 @@ namespace CMST
     Manager_Technologies  = (1 << 2), // scan for technologies  
     Manager_Services      = (1 << 3), // scan for services
     Manager_All           = (CMST::Manager_Properties | CMST::Manager_Technologies | CMST::Manager_Services),
+
+    // display widgets (dirty flags, what needs to be rebuilt)
+    Widget_None           = 0x00,
+    Widget_Status         = (1 << 0), // status tab
+    Widget_Details        = (1 << 1), // details tab
+    Widget_Wireless       = (1 << 2), // wireless tab
+    Widget_VPN            = (1 << 3), // vpn tab
+    Widget_Counters       = (1 << 4), // counters tab
+    Widget_TrayIcon       = (1 << 5), // tray icon and tooltip
+    Widget_All            = (CMST::Widget_Status | CMST::Widget_Details | CMST::Widget_Wireless | CMST::Widget_VPN | CMST::Widget_Counters | CMST::Widget_TrayIcon),
     
     // provisioning editor
     ProvEd_No_Selection = 0x00,
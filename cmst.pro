@@ -1,10 +1,16 @@
 #  Need a make file to make other make files
 TEMPLATE = subdirs
-SUBDIRS = ./apps/cmstapp ./apps/rootapp
+CONFIG += ordered
+SUBDIRS = ./apps/cmstcore ./apps/cmstapp ./apps/rootapp
 
 # cmst build variables
 include(cmst.pri)
 
+# performance tests, only built when asked for with: qmake CONFIG+=tests
+CONFIG(tests) {
+	SUBDIRS += ./tests
+}
+
 # translations
 TRANSLATIONS += ./translations/cmst_en_US.ts
 TRANSLATIONS += ./translations/cmst_ru_RU.ts
@@ -0,0 +1,47 @@
+#  We need the qt libraries, we want compiler warnings on, and this is a release version of the program
+CONFIG += qt
+CONFIG += warn_on
+CONFIG += release
+CONFIG += nostrip
+CONFIG += c++11
+CONFIG += console
+
+#  QtTest benchmarks of the core and the icon code
+QT += testlib
+QT += widgets
+QT += dbus
+QT += core
+
+TEMPLATE = app
+TARGET = cmstbench
+
+#  The core library, and the icon manager from cmstapp which we build here
+INCLUDEPATH += ../../apps/cmstcore
+INCLUDEPATH += ../../apps/cmstapp
+INCLUDEPATH += $$OUT_PWD/../../apps/cmstcore
+LIBS += -L$$OUT_PWD/../../apps/cmstcore -lcmstcore
+PRE_TARGETDEPS += $$OUT_PWD/../../apps/cmstcore/libcmstcore.a
+
+#	header files
+HEADERS		+= ./code/echo.h
+HEADERS		+= ../../apps/cmstapp/code/iconman/iconman.h
+HEADERS		+= ../../apps/cmstapp/code/iconman/iconindex.h
+
+#	sources
+SOURCES += ./code/benchcore.cpp
+SOURCES += ./code/echo.cpp
+SOURCES	+= ../../apps/cmstapp/code/iconman/iconman.cpp
+SOURCES	+= ../../apps/cmstapp/code/iconman/iconindex.cpp
+
+#	resources, the icons and icon_def.txt
+RESOURCES 	+= ../../cmst.qrc
+
+#  make bench runs the benchmarks and keeps the results in results.xml
+bench.commands = QT_QPA_PLATFORM=offscreen ./cmstbench -o results.xml,xml -o -,txt
+bench.depends = $(TARGET)
+QMAKE_EXTRA_TARGETS += bench
+
+##  Place all object files in their own directory and moc files in their own directory
+##  This is not necessary but keeps things cleaner.
+OBJECTS_DIR = ./object_files
+MOC_DIR = ./moc_files
@@ -0,0 +1,450 @@
+/**************************** benchcore.cpp ***************************
+
+Benchmarks of the code cmst runs for every connman signal and repaint:
+merging GetServices and ServicesChanged payloads into an ObjectStore,
+reading maps out of messages, display names, counter labels, string
+translation and icons, built through getIcon() with the cache cleared.
+
+Run with -o results.xml,xml (or results.csv,csv) to keep the numbers.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QtTest/QtTest>
+# include <QTemporaryDir>
+# include <QColor>
+# include <QtDBus/QDBusConnection>
+# include <QtDBus/QDBusMessage>
+# include <QtDBus/QDBusArgument>
+
+# include "./echo.h"
+# include "./code/objstore/objstore.h"
+# include "./code/shared/shared.h"
+# include "./code/counter/counter.h"
+# include "./code/trstring/tr_strings.h"
+# include "./code/iconman/iconman.h"
+
+class CmstBench : public QObject
+{
+  Q_OBJECT
+
+  public:
+    CmstBench();
+
+  private:
+  // members
+    EchoServer echo;
+    QDBusConnection peer;
+    QTemporaryDir config;
+    IconManager* icons;
+
+  // functions
+    QDBusMessage roundTrip(const QVariant&);
+    static QMap<QString,QVariant> serviceProperties(int);
+    static QList<arrayElement> servicePayload(int, bool, int);
+
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void merge_data();
+    void merge();
+    void getMap();
+    void extractMapData_data();
+    void extractMapData();
+    void nickName_data();
+    void nickName();
+    void getLabel_data();
+    void getLabel();
+    void cmtr_data();
+    void cmtr();
+    void getIcon_data();
+    void getIcon();
+};
+
+// Constructor
+CmstBench::CmstBench() : peer(QString() )
+{
+  icons = 0;
+}
+
+////////////////////////////// Private Functions ////////////////////////////
+//
+// Function to send a value through the echo server.  The reply holds it
+// the way a message from connman would.
+QDBusMessage CmstBench::roundTrip(const QVariant& value)
+{
+  QDBusMessage msg = QDBusMessage::createMethodCall(QString(), "/", "org.cmst.Bench", "Echo");
+  msg.setArguments(QList<QVariant>() << value);
+
+  return peer.call(msg);
+}
+
+//
+// Function to return the properties connman sends for wifi service i
+QMap<QString,QVariant> CmstBench::serviceProperties(int i)
+{
+  QVariantMap ipv4;
+  ipv4.insert("Method", "dhcp");
+  ipv4.insert("Address", QString("192.168.1.%1").arg(i % 250 + 2) );
+  ipv4.insert("Netmask", "255.255.255.0");
+  ipv4.insert("Gateway", "192.168.1.1");
+  QVariantMap ethernet;
+  ethernet.insert("Method", "auto");
+  ethernet.insert("Interface", "wlan0");
+  ethernet.insert("Address", "00:11:22:33:44:55");
+  ethernet.insert("MTU", QVariant::fromValue(quint16(1500)) );
+  QVariantMap proxy;
+  proxy.insert("Method", "direct");
+
+  QMap<QString,QVariant> props;
+  props.insert("Type", "wifi");
+  props.insert("Name", QString("Network %1").arg(i) );
+  props.insert("State", i == 0 ? "online" : "idle");
+  props.insert("Error", QString() );
+  props.insert("Strength", QVariant::fromValue(uchar(40 + i % 50)) );
+  props.insert("Favorite", i == 0);
+  props.insert("Immutable", false);
+  props.insert("AutoConnect", i == 0);
+  props.insert("Security", QStringList() << "psk");
+  props.insert("IPv4", ipv4);
+  props.insert("IPv4.Configuration", ipv4);
+  props.insert("IPv6", QVariantMap() );
+  props.insert("Nameservers", QStringList() << "192.168.1.1");
+  props.insert("Domains", QStringList() );
+  props.insert("Proxy", proxy);
+  props.insert("Ethernet", ethernet);
+  props.insert("Provider", QVariantMap() );
+
+  return props;
+}
+
+//
+// Function to make the array of a GetServices reply (b_full true) or a
+// ServicesChanged signal for n services.  In a ServicesChanged every
+// tenth service has a new Strength, which differs with pass, and the rest
+// are sent with no properties as connman does.
+QList<arrayElement> CmstBench::servicePayload(int n, bool b_full, int pass)
+{
+  QList<arrayElement> list;
+  for (int i = 0; i < n; ++i) {
+    arrayElement ae;
+    ae.objpath = QDBusObjectPath(QString("/net/connman/service/wifi_%1_managed_psk").arg(i, 12, 16, QChar('0')) );
+    if (b_full) ae.objmap = serviceProperties(i);
+    else if (i % 10 == 0) ae.objmap.insert("Strength", QVariant::fromValue(uchar(30 + pass * 10 + i % 50)) );
+    list.append(ae);
+  } // for
+
+  return list;
+}
+
+////////////////////////////// Private Slots ////////////////////////////
+//
+// Slot to set up the peer connection and an IconManager with its own
+// config directory
+void CmstBench::initTestCase()
+{
+  ObjectStore::registerMetaTypes();
+
+  const QString address = echo.address();
+  QVERIFY2(! address.isEmpty(), "the echo server could not listen");
+  peer = QDBusConnection::connectToPeer(address, "bench");
+  QVERIFY2(peer.isConnected(), qPrintable(peer.lastError().message()) );
+
+  QVERIFY(config.isValid() );
+  qputenv("XDG_CONFIG_HOME", config.path().toLocal8Bit() );
+  icons = new IconManager(this);
+  icons->setIconColor(QColor("#2080c0") );
+
+  // build icons from our own art so getIcon() goes through processArt()
+  QIcon::setThemeName(INTERNAL_THEME);
+
+  return;
+}
+
+//
+// Slot to close the peer connection
+void CmstBench::cleanupTestCase()
+{
+  QDBusConnection::disconnectFromPeer("bench");
+
+  return;
+}
+
+//
+// Rows for merge
+void CmstBench::merge_data()
+{
+  QTest::addColumn<bool>("full");
+  QTest::addColumn<int>("count");
+
+  QList<int> counts;
+  counts << 10 << 100 << 1000;
+  for (int i = 0; i < counts.size(); ++i) {
+    QTest::newRow(qPrintable(QString("GetServices %1").arg(counts.at(i))) ) << true << counts.at(i);
+  } // for
+  for (int i = 0; i < counts.size(); ++i) {
+    QTest::newRow(qPrintable(QString("ServicesChanged %1").arg(counts.at(i))) ) << false << counts.at(i);
+  } // for
+
+  return;
+}
+
+//
+// ObjectStore::merge.  A GetServices reply is merged into an empty store.
+// Two ServicesChanged signals, so each merge has something to change,
+// are merged in turn into a store that already holds the services.
+void CmstBench::merge()
+{
+  QFETCH(bool, full);
+  QFETCH(int, count);
+
+  const QVariant services = roundTrip(QVariant::fromValue(servicePayload(count, true, 0)) ).arguments().value(0);
+  QVERIFY(services.canConvert<QDBusArgument>() );
+
+  if (full) {
+    QBENCHMARK {
+      ObjectStore store;
+      QVERIFY(store.merge(services, true) );
+    } // QBENCHMARK
+  } // if GetServices
+
+  else {
+    ObjectStore store;
+    QVERIFY(store.merge(services, true) );
+    QCOMPARE(store.size(), count);
+    const QVariant first = roundTrip(QVariant::fromValue(servicePayload(count, false, 0)) ).arguments().value(0);
+    const QVariant second = roundTrip(QVariant::fromValue(servicePayload(count, false, 1)) ).arguments().value(0);
+    QBENCHMARK {
+      QVERIFY(store.merge(first) );
+      QVERIFY(store.merge(second) );
+    } // QBENCHMARK
+  } // else ServicesChanged
+
+  return;
+}
+
+//
+// shared::getMap on a service GetProperties reply
+void CmstBench::getMap()
+{
+  const QDBusMessage reply = roundTrip(QVariant(serviceProperties(1)) );
+  QMap<QString,QVariant> map;
+
+  QBENCHMARK {
+    QVERIFY(shared::getMap(map, reply) );
+  } // QBENCHMARK
+  QCOMPARE(map.size(), serviceProperties(1).size() );
+
+  return;
+}
+
+//
+// Rows for extractMapData, a nested dictionary as it comes off the bus
+// and as it is once an ObjectStore has demarshalled it
+void CmstBench::extractMapData_data()
+{
+  QTest::addColumn<bool>("demarshalled");
+
+  QTest::newRow("QDBusArgument") << false;
+  QTest::newRow("QVariantMap") << true;
+
+  return;
+}
+
+//
+// shared::extractMapData on the Ethernet property of a service
+void CmstBench::extractMapData()
+{
+  QFETCH(bool, demarshalled);
+
+  QMap<QString,QVariant> props;
+  QVERIFY(shared::getMap(props, roundTrip(QVariant(serviceProperties(1)))) );
+  const QVariant value = demarshalled ? serviceProperties(1).value("Ethernet") : props.value("Ethernet");
+  QMap<QString,QVariant> map;
+
+  QBENCHMARK {
+    QVERIFY(shared::extractMapData(map, value) );
+  } // QBENCHMARK
+  QCOMPARE(map.value("Interface").toString(), QString("wlan0") );
+
+  return;
+}
+
+//
+// Rows for nickName
+void CmstBench::nickName_data()
+{
+  QTest::addColumn<arrayElement>("service");
+
+  arrayElement wired;
+  wired.objmap = serviceProperties(0);
+  wired.objmap.insert("Type", "ethernet");
+  wired.objmap.insert("Name", "Wired");
+  wired.rec.load(wired.objmap);
+  QTest::newRow("ethernet") << wired;
+
+  arrayElement wifi;
+  wifi.objmap = serviceProperties(1);
+  wifi.rec.load(wifi.objmap);
+  QTest::newRow("wifi") << wifi;
+
+  arrayElement hidden;
+  hidden.objmap = serviceProperties(2);
+  hidden.objmap.remove("Name");
+  hidden.rec.load(hidden.objmap);
+  QTest::newRow("hidden wifi") << hidden;
+
+  return;
+}
+
+//
+// shared::nickName
+void CmstBench::nickName()
+{
+  QFETCH(arrayElement, service);
+
+  QString name;
+  QBENCHMARK {
+    name = shared::nickName(service);
+  } // QBENCHMARK
+  QVERIFY(! name.isEmpty() );
+
+  return;
+}
+
+//
+// Rows for getLabel, one for each unit the byte counts are shown in
+void CmstBench::getLabel_data()
+{
+  QTest::addColumn<qlonglong>("bytes");
+
+  QTest::newRow("bytes") << Q_INT64_C(1000);
+  QTest::newRow("KB") << Q_INT64_C(100000);
+  QTest::newRow("MB") << Q_INT64_C(100000000);
+  QTest::newRow("GB") << Q_INT64_C(10000000000);
+
+  return;
+}
+
+//
+// ConnmanCounter::getLabel
+void CmstBench::getLabel()
+{
+  QFETCH(qlonglong, bytes);
+
+  QVariantMap map;
+  map.insert("RX.Bytes", bytes);
+  map.insert("RX.Packets", bytes / 1000);
+  map.insert("RX.Errors", 3);
+  map.insert("RX.Dropped", 1);
+  map.insert("TX.Bytes", bytes / 4);
+  map.insert("TX.Packets", bytes / 4000);
+  map.insert("TX.Errors", 0);
+  map.insert("TX.Dropped", 0);
+  map.insert("Time", 93784u);
+  ConnmanCounter counter(this);
+
+  QString label;
+  QBENCHMARK {
+    label = counter.getLabel(map);
+  } // QBENCHMARK
+  QVERIFY(! label.isEmpty() );
+
+  return;
+}
+
+//
+// Rows for cmtr, connman values we translate and one we do not
+void CmstBench::cmtr_data()
+{
+  QTest::addColumn<QString>("text");
+
+  QTest::newRow("state") << QString("online");
+  QTest::newRow("type") << QString("wifi");
+  QTest::newRow("name") << QString("Network 1");
+
+  return;
+}
+
+//
+// TranslateStrings::cmtr
+void CmstBench::cmtr()
+{
+  QFETCH(QString, text);
+
+  QString s;
+  QBENCHMARK {
+    s = TranslateStrings::cmtr(text);
+  } // QBENCHMARK
+  QVERIFY(! s.isEmpty() );
+
+  return;
+}
+
+//
+// Rows for getIcon.  An icon served from the cache, and icons built from
+// our art: plain, colorized, and colorized with an overlay.
+void CmstBench::getIcon_data()
+{
+  QTest::addColumn<QString>("name");
+  QTest::addColumn<bool>("cached");
+
+  QTest::newRow("cached") << QString("state_online") << true;
+  QTest::newRow("plain") << QString("state_error") << false;
+  QTest::newRow("colorized") << QString("state_online") << false;
+  QTest::newRow("overlay") << QString("state_not_ready") << false;
+
+  return;
+}
+
+//
+// IconManager::getIcon.  The uncached rows clear the cache first so each
+// call builds the icon and runs processArt() on it.
+void CmstBench::getIcon()
+{
+  QFETCH(QString, name);
+  QFETCH(bool, cached);
+
+  QIcon icon = icons->getIcon(name);
+  QVERIFY(! icon.isNull() );
+
+  if (cached) {
+    QBENCHMARK {
+      icon = icons->getIcon(name);
+    } // QBENCHMARK
+  } // if cached
+
+  else {
+    QBENCHMARK {
+      icons->clearCache();
+      icon = icons->getIcon(name);
+    } // QBENCHMARK
+  } // else uncached
+
+  QVERIFY(! icon.isNull() );
+
+  return;
+}
+
+QTEST_MAIN(CmstBench)
+# include "benchcore.moc"
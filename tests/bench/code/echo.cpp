@@ -0,0 +1,106 @@
+/**************************** echo.cpp ********************************
+
+A D-Bus peer that answers every call with the arguments it was sent.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QDir>
+# include <QtDBus/QDBusServer>
+
+# include "./echo.h"
+
+// Constructor
+EchoObject::EchoObject(QObject* parent) : QDBusVirtualObject(parent)
+{
+}
+
+//
+// Function to return the introspection data, there is nothing to describe
+QString EchoObject::introspect(const QString& path) const
+{
+  (void) path;
+
+  return QString();
+}
+
+//
+// Function to send the arguments of a call back as its reply
+bool EchoObject::handleMessage(const QDBusMessage& msg, const QDBusConnection& connection)
+{
+  if (msg.type() != QDBusMessage::MethodCallMessage) return false;
+
+  connection.send(msg.createReply(msg.arguments()) );
+
+  return true;
+}
+
+//
+// Slot to answer calls on every object path of a new peer connection
+void EchoObject::newConnection(const QDBusConnection& connection)
+{
+  QDBusConnection(connection).registerVirtualObject("/", this, QDBusConnection::SubPath);
+
+  return;
+}
+
+// Constructor
+EchoServer::EchoServer(QObject* parent) : QThread(parent)
+{
+  server_address.clear();
+}
+
+// Destructor
+EchoServer::~EchoServer()
+{
+  this->quit();
+  this->wait();
+}
+
+//
+// Function to start the server and return the address to connect to,
+// empty if the server could not listen
+QString EchoServer::address()
+{
+  if (! this->isRunning() ) {
+    this->start();
+    ready.acquire();
+  } // if
+
+  return server_address;
+}
+
+//
+// Function run in the server thread
+void EchoServer::run()
+{
+  EchoObject echo;
+  QDBusServer server(QString("unix:tmpdir=%1").arg(QDir::tempPath()) );
+  connect(&server, SIGNAL(newConnection(QDBusConnection)), &echo, SLOT(newConnection(QDBusConnection)), Qt::DirectConnection);
+  server_address = server.isConnected() ? server.address() : QString();
+  ready.release();
+
+  this->exec();
+
+  return;
+}
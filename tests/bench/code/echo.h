@@ -0,0 +1,73 @@
+/**************************** echo.h **********************************
+
+A D-Bus peer that answers every call with the arguments it was sent.
+A payload sent through it comes back as a demarshalling QDBusArgument,
+the same as one from connman, so the benchmarks read real messages
+without a bus or connman.  The server runs in its own thread so a
+blocking call from the benchmark thread gets its reply.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef CMST_BENCH_ECHO
+# define CMST_BENCH_ECHO
+
+# include <QObject>
+# include <QString>
+# include <QThread>
+# include <QSemaphore>
+# include <QtDBus/QDBusConnection>
+# include <QtDBus/QDBusMessage>
+# include <QtDBus/QDBusVirtualObject>
+
+class EchoObject : public QDBusVirtualObject
+{
+  Q_OBJECT
+
+  public:
+    EchoObject(QObject* parent = 0);
+    QString introspect(const QString&) const;
+    bool handleMessage(const QDBusMessage&, const QDBusConnection&);
+
+  public slots:
+    void newConnection(const QDBusConnection&);
+};
+
+class EchoServer : public QThread
+{
+  Q_OBJECT
+
+  public:
+    EchoServer(QObject* parent = 0);
+    ~EchoServer();
+    QString address();
+
+  protected:
+    void run();
+
+  private:
+    QString server_address;
+    QSemaphore ready;
+};
+
+# endif
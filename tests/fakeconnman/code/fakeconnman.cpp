@@ -0,0 +1,453 @@
+/**************************** fakeconnman.cpp *************************
+
+A stand-in for connmand, to run on a private dbus-daemon.  It answers the
+net.connman.Manager, Service and Technology calls cmst makes, and the
+net.connman.vpn.Manager ones, from state kept in memory.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QtDBus/QDBusError>
+# include <QtDBus/QDBusMetaType>
+# include <QtDBus/QDBusVariant>
+
+# include <cstdlib>
+
+# include "./fakeconnman.h"
+
+# define CONNMAN_SERVICE "net.connman"
+# define CONNMAN_VPN_SERVICE "net.connman.vpn"
+# define CONNMAN_MANAGER "net.connman.Manager"
+# define CONNMAN_SERVICE_IFACE "net.connman.Service"
+# define CONNMAN_TECHNOLOGY "net.connman.Technology"
+# define CONNMAN_VPN_MANAGER "net.connman.vpn.Manager"
+# define SERVICE_PATH "/net/connman/service/"
+# define TECHNOLOGY_PATH "/net/connman/technology/"
+
+//
+//  DBus marshalling of a fakeObject
+QDBusArgument& operator<<(QDBusArgument& argument, const fakeObject& obj)
+{
+  argument.beginStructure();
+  argument << obj.path << obj.props;
+  argument.endStructure();
+
+  return argument;
+}
+
+const QDBusArgument& operator>>(const QDBusArgument& argument, fakeObject& obj)
+{
+  argument.beginStructure();
+  argument >> obj.path >> obj.props;
+  argument.endStructure();
+
+  return argument;
+}
+
+// Constructor.  Starts with wired and wifi technologies and one wired
+// service that is online.
+FakeConnman::FakeConnman(const QDBusConnection& connection, QObject* parent) : QDBusVirtualObject(parent),
+  bus(connection)
+{
+  next_service = 0;
+  b_agent = false;
+
+  manager.clear();
+  manager.insert("State", "online");
+  manager.insert("OfflineMode", false);
+  manager.insert("SessionMode", false);
+
+  technologies.clear();
+  const char* techs[][2] = {{"ethernet", "Wired"}, {"wifi", "WiFi"}};
+  for (int i = 0; i < 2; ++i) {
+    fakeObject fo;
+    fo.path = QDBusObjectPath(QString(TECHNOLOGY_PATH) + techs[i][0]);
+    fo.props.insert("Name", techs[i][1]);
+    fo.props.insert("Type", techs[i][0]);
+    fo.props.insert("Powered", true);
+    fo.props.insert("Connected", true);
+    fo.props.insert("Tethering", false);
+    technologies.append(fo);
+  } // for
+
+  services.clear();
+  fakeObject wired = newService("ethernet", "Wired", 0);
+  wired.props.insert("State", "online");
+  wired.props.insert("Favorite", true);
+  wired.props.insert("AutoConnect", true);
+  wired.props.remove("Strength");
+  wired.props.insert("Security", QStringList() );
+  services.append(wired);
+}
+
+////////////////////////////// Public Functions ////////////////////////////
+//
+// Function to register the DBus types we send
+void FakeConnman::registerMetaTypes()
+{
+  qDBusRegisterMetaType<fakeObject>();
+  qDBusRegisterMetaType<QList<fakeObject> >();
+
+  return;
+}
+
+//
+// Function to take every object path on the bus and the connman service
+// names.  Return false if any of it is already taken.
+bool FakeConnman::registerOnBus()
+{
+  if (! bus.registerVirtualObject("/", this, QDBusConnection::SubPath) ) return false;
+
+  return bus.registerService(CONNMAN_SERVICE) && bus.registerService(CONNMAN_VPN_SERVICE);
+}
+
+//
+// Function to return the introspection data for path.  Nothing is
+// described, cmst calls the methods through its generated proxies.
+QString FakeConnman::introspect(const QString& path) const
+{
+  (void) path;
+
+  return QString();
+}
+
+//
+// Function called for every message sent to one of our object paths.
+// Return false for messages we do not handle.
+bool FakeConnman::handleMessage(const QDBusMessage& msg, const QDBusConnection& connection)
+{
+  if (msg.type() != QDBusMessage::MethodCallMessage) return false;
+
+  QDBusMessage reply;
+  const QString iface = msg.interface();
+  if (iface == CONNMAN_MANAGER) reply = managerCall(msg);
+  else if (iface == CONNMAN_SERVICE_IFACE) reply = serviceCall(msg);
+  else if (iface == CONNMAN_TECHNOLOGY) reply = technologyCall(msg);
+  else if (iface == CONNMAN_VPN_MANAGER) reply = vpnCall(msg);
+  else return false;
+
+  connection.send(reply);
+
+  return true;
+}
+
+//
+// Function to replace the wifi services with n new ones.  The wired
+// service stays first in the list.
+void FakeConnman::setServices(int n)
+{
+  QList<QDBusObjectPath> removed;
+  while (services.size() > 1) {
+    removed.append(services.takeLast().path);
+  } // while
+
+  QList<int> full;
+  for (int i = 0; i < n; ++i) {
+    services.append(newService("wifi", QString("Network %1").arg(next_service), 20 + std::rand() % 71) );
+    full.append(services.size() - 1);
+  } // for
+
+  this->servicesChanged(full, removed);
+
+  return;
+}
+
+//
+// Function to change one property of service i and send PropertyChanged
+void FakeConnman::setServiceProperty(int i, const QString& prop, const QVariant& value)
+{
+  if (i < 0 || i >= services.size() ) return;
+
+  services[i].props.insert(prop, value);
+  this->sendSignal(services.at(i).path.path(), CONNMAN_SERVICE_IFACE, "PropertyChanged",
+    QList<QVariant>() << prop << QVariant::fromValue(QDBusVariant(value)) );
+
+  return;
+}
+
+//
+// Function to change a manager property and send PropertyChanged
+void FakeConnman::setManagerProperty(const QString& prop, const QVariant& value)
+{
+  manager.insert(prop, value);
+  this->sendSignal("/", CONNMAN_MANAGER, "PropertyChanged",
+    QList<QVariant>() << prop << QVariant::fromValue(QDBusVariant(value)) );
+
+  return;
+}
+
+//
+// Function to send ServicesChanged.  Every service is listed in order,
+// the ones in full with all their properties and the others with an
+// empty dictionary as connman does for services that did not change.
+void FakeConnman::servicesChanged(const QList<int>& full, const QList<QDBusObjectPath>& removed)
+{
+  QList<fakeObject> changed;
+  for (int i = 0; i < services.size(); ++i) {
+    fakeObject fo;
+    fo.path = services.at(i).path;
+    if (full.contains(i) ) fo.props = services.at(i).props;
+    changed.append(fo);
+  } // for
+
+  this->sendSignal("/", CONNMAN_MANAGER, "ServicesChanged",
+    QList<QVariant>() << QVariant::fromValue(changed) << QVariant::fromValue(removed) );
+
+  return;
+}
+
+//
+// Function to act out the result of a wifi scan: changes services drop
+// out, the same number of new ones appear at random places and about a
+// third of the rest get a new Strength.  One ServicesChanged is sent.
+void FakeConnman::scan(int changes)
+{
+  QList<QDBusObjectPath> removed;
+  for (int i = 0; i < changes && services.size() > 1; ++i) {
+    removed.append(services.takeAt(1 + std::rand() % (services.size() - 1)).path);
+  } // for
+  QList<QDBusObjectPath> added;
+  for (int i = 0; i < changes; ++i) {
+    const fakeObject fo = newService("wifi", QString("Network %1").arg(next_service), 20 + std::rand() % 71);
+    added.append(fo.path);
+    services.insert(1 + std::rand() % services.size(), fo);
+  } // for
+
+  QList<int> full;
+  for (int i = 1; i < services.size(); ++i) {
+    if (added.contains(services.at(i).path) ) full.append(i);
+    else if (std::rand() % 3 == 0) {
+      services[i].props.insert("Strength", QVariant::fromValue(uchar(20 + std::rand() % 71)) );
+      full.append(i);
+    } // else if
+  } // for
+
+  this->servicesChanged(full, removed);
+
+  return;
+}
+
+//
+// Function to shuffle the wifi services and send ServicesChanged with
+// nothing but the new order
+void FakeConnman::reorder()
+{
+  for (int i = services.size() - 1; i > 1; --i) {
+    services.swap(i, 1 + std::rand() % i);
+  } // for
+
+  this->servicesChanged(QList<int>(), QList<QDBusObjectPath>() );
+
+  return;
+}
+
+////////////////////////////// Private Functions ////////////////////////////
+//
+// Function to make a service with the properties connman sends for a
+// wifi or wired service
+fakeObject FakeConnman::newService(const QString& type, const QString& name, int strength)
+{
+  fakeObject fo;
+  fo.path = QDBusObjectPath(QString(SERVICE_PATH "%1_%2_managed_psk").arg(type).arg(next_service, 12, 16, QChar('0')) );
+  ++next_service;
+
+  QVariantMap ipv4;
+  ipv4.insert("Method", "dhcp");
+  QVariantMap ethernet;
+  ethernet.insert("Method", "auto");
+  ethernet.insert("Interface", type == "wifi" ? "wlan0" : "eth0");
+  ethernet.insert("Address", "00:11:22:33:44:55");
+  ethernet.insert("MTU", QVariant::fromValue(quint16(1500)) );
+  QVariantMap proxy;
+  proxy.insert("Method", "direct");
+
+  fo.props.insert("Type", type);
+  fo.props.insert("Name", name);
+  fo.props.insert("State", "idle");
+  fo.props.insert("Error", QString() );
+  fo.props.insert("Strength", QVariant::fromValue(uchar(strength)) );
+  fo.props.insert("Favorite", false);
+  fo.props.insert("Immutable", false);
+  fo.props.insert("AutoConnect", false);
+  fo.props.insert("Security", QStringList() << "psk");
+  fo.props.insert("IPv4", ipv4);
+  fo.props.insert("IPv4.Configuration", ipv4);
+  fo.props.insert("IPv6", QVariantMap() );
+  fo.props.insert("IPv6.Configuration", QVariantMap() );
+  fo.props.insert("Nameservers", QStringList() );
+  fo.props.insert("Nameservers.Configuration", QStringList() );
+  fo.props.insert("Timeservers", QStringList() );
+  fo.props.insert("Domains", QStringList() );
+  fo.props.insert("Proxy", proxy);
+  fo.props.insert("Proxy.Configuration", QVariantMap() );
+  fo.props.insert("Ethernet", ethernet);
+  fo.props.insert("Provider", QVariantMap() );
+
+  return fo;
+}
+
+//
+// Function to return the row of the service at path, -1 if there is none
+int FakeConnman::serviceIndex(const QString& path) const
+{
+  for (int i = 0; i < services.size(); ++i) {
+    if (services.at(i).path.path() == path) return i;
+  } // for
+
+  return -1;
+}
+
+//
+// Function to send a signal from one of our objects
+void FakeConnman::sendSignal(const QString& path, const QString& iface, const QString& name, const QList<QVariant>& args)
+{
+  QDBusMessage msg = QDBusMessage::createSignal(path, iface, name);
+  msg.setArguments(args);
+  bus.send(msg);
+  emit signalSent(name);
+
+  return;
+}
+
+//
+// Function to take service i through the states of a connection
+void FakeConnman::connectService(int i)
+{
+  const char* states[] = {"association", "configuration", "ready", "online"};
+  for (int s = 0; s < 4; ++s) {
+    this->setServiceProperty(i, "State", states[s]);
+  } // for
+
+  return;
+}
+
+//
+// Function to answer a call to net.connman.Manager
+QDBusMessage FakeConnman::managerCall(const QDBusMessage& msg)
+{
+  const QString method = msg.member();
+  const QList<QVariant> args = msg.arguments();
+
+  if (method == "GetProperties") return msg.createReply(QVariant::fromValue(manager) );
+  if (method == "GetTechnologies") return msg.createReply(QVariant::fromValue(technologies) );
+  if (method == "GetServices") return msg.createReply(QVariant::fromValue(services) );
+  if (method == "GetPeers") return msg.createReply(QVariant::fromValue(QList<fakeObject>()) );
+  if (method == "SetProperty" && args.size() == 2) {
+    this->setManagerProperty(args.at(0).toString(), args.at(1).value<QDBusVariant>().variant() );
+    return msg.createReply();
+  } // if SetProperty
+  if (method == "RegisterAgent") {
+    b_agent = true;
+    emit agentReady();
+    return msg.createReply();
+  } // if RegisterAgent
+  if (method == "UnregisterAgent") {
+    b_agent = false;
+    return msg.createReply();
+  } // if UnregisterAgent
+  if (method == "RegisterCounter" || method == "UnregisterCounter") return msg.createReply();
+
+  return msg.createErrorReply(QDBusError::UnknownMethod, method);
+}
+
+//
+// Function to answer a call to net.connman.Service
+QDBusMessage FakeConnman::serviceCall(const QDBusMessage& msg)
+{
+  const QString method = msg.member();
+  const QList<QVariant> args = msg.arguments();
+  const int i = serviceIndex(msg.path() );
+  if (i < 0) return msg.createErrorReply("net.connman.Error.NotFound", msg.path() );
+
+  if (method == "GetProperties") return msg.createReply(QVariant::fromValue(services.at(i).props) );
+  if (method == "Connect") {
+    this->connectService(i);
+    return msg.createReply();
+  } // if Connect
+  if (method == "Disconnect") {
+    this->setServiceProperty(i, "State", "idle");
+    return msg.createReply();
+  } // if Disconnect
+  if (method == "Remove") {
+    const QDBusObjectPath path = services.takeAt(i).path;
+    this->servicesChanged(QList<int>(), QList<QDBusObjectPath>() << path);
+    return msg.createReply();
+  } // if Remove
+  if (method == "SetProperty" && args.size() == 2) {
+    this->setServiceProperty(i, args.at(0).toString(), args.at(1).value<QDBusVariant>().variant() );
+    return msg.createReply();
+  } // if SetProperty
+  if (method == "ClearProperty") return msg.createReply();
+  if ((method == "MoveBefore" || method == "MoveAfter") && args.size() == 1) {
+    int target = serviceIndex(args.at(0).value<QDBusObjectPath>().path() );
+    if (target < 0) return msg.createErrorReply("net.connman.Error.NotFound", method);
+    const fakeObject fo = services.takeAt(i);
+    if (target > i) --target;
+    services.insert(method == "MoveBefore" ? target : target + 1, fo);
+    this->servicesChanged(QList<int>(), QList<QDBusObjectPath>() );
+    return msg.createReply();
+  } // if Move
+
+  return msg.createErrorReply(QDBusError::UnknownMethod, method);
+}
+
+//
+// Function to answer a call to net.connman.Technology
+QDBusMessage FakeConnman::technologyCall(const QDBusMessage& msg)
+{
+  const QString method = msg.member();
+  const QList<QVariant> args = msg.arguments();
+  int t = -1;
+  for (int i = 0; i < technologies.size(); ++i) {
+    if (technologies.at(i).path.path() == msg.path() ) t = i;
+  } // for
+  if (t < 0) return msg.createErrorReply("net.connman.Error.NotFound", msg.path() );
+
+  if (method == "GetProperties") return msg.createReply(QVariant::fromValue(technologies.at(t).props) );
+  if (method == "SetProperty" && args.size() == 2) {
+    const QVariant value = args.at(1).value<QDBusVariant>().variant();
+    technologies[t].props.insert(args.at(0).toString(), value);
+    this->sendSignal(msg.path(), CONNMAN_TECHNOLOGY, "PropertyChanged",
+      QList<QVariant>() << args.at(0) << QVariant::fromValue(QDBusVariant(value)) );
+    return msg.createReply();
+  } // if SetProperty
+  if (method == "Scan") {
+    this->scan(qMax(1, services.size() / 20) );
+    return msg.createReply();
+  } // if Scan
+
+  return msg.createErrorReply(QDBusError::UnknownMethod, method);
+}
+
+//
+// Function to answer a call to net.connman.vpn.Manager.  There are never
+// any VPN connections.
+QDBusMessage FakeConnman::vpnCall(const QDBusMessage& msg)
+{
+  const QString method = msg.member();
+
+  if (method == "GetConnections") return msg.createReply(QVariant::fromValue(QList<fakeObject>()) );
+  if (method == "RegisterAgent" || method == "UnregisterAgent") return msg.createReply();
+
+  return msg.createErrorReply(QDBusError::UnknownMethod, method);
+}
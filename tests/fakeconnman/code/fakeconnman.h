@@ -0,0 +1,108 @@
+/**************************** fakeconnman.h ***************************
+
+A stand-in for connmand, to run on a private dbus-daemon.  It answers the
+net.connman.Manager, Service and Technology calls cmst makes, and the
+net.connman.vpn.Manager ones, from state kept in memory.  Storm (see
+storm.h) changes the state and has the signals sent.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef FAKE_CONNMAN
+# define FAKE_CONNMAN
+
+# include <QObject>
+# include <QString>
+# include <QStringList>
+# include <QList>
+# include <QVariantMap>
+# include <QMetaType>
+# include <QtDBus/QDBusConnection>
+# include <QtDBus/QDBusMessage>
+# include <QtDBus/QDBusObjectPath>
+# include <QtDBus/QDBusArgument>
+# include <QtDBus/QDBusVirtualObject>
+
+//
+//  An object path and its properties, the (oa{sv}) structure connman
+//  uses in GetServices, GetTechnologies and ServicesChanged
+struct fakeObject
+{
+  QDBusObjectPath path;
+  QVariantMap props;
+};
+Q_DECLARE_METATYPE(fakeObject)
+Q_DECLARE_METATYPE(QList<fakeObject>)
+
+QDBusArgument& operator<<(QDBusArgument&, const fakeObject&);
+const QDBusArgument& operator>>(const QDBusArgument&, fakeObject&);
+
+class FakeConnman : public QDBusVirtualObject
+{
+  Q_OBJECT
+
+  public:
+    FakeConnman(const QDBusConnection&, QObject* parent = 0);
+    static void registerMetaTypes();
+    bool registerOnBus();
+
+  // QDBusVirtualObject
+    QString introspect(const QString&) const;
+    bool handleMessage(const QDBusMessage&, const QDBusConnection&);
+
+  // state, each change sends its signal
+    void setServices(int);
+    void setServiceProperty(int, const QString&, const QVariant&);
+    void setManagerProperty(const QString&, const QVariant&);
+    void servicesChanged(const QList<int>&, const QList<QDBusObjectPath>&);
+    void scan(int);
+    void reorder();
+    inline int serviceCount() const {return services.size();}
+    inline QVariant serviceProperty(int i, const QString& prop) const {return services.at(i).props.value(prop);}
+    inline bool hasAgent() const {return b_agent;}
+
+  signals:
+    void signalSent(const QString&);
+    void agentReady();
+
+  private:
+  // members
+    QDBusConnection bus;
+    QVariantMap manager;
+    QList<fakeObject> technologies;
+    QList<fakeObject> services;
+    int next_service;
+    bool b_agent;
+
+  // functions
+    fakeObject newService(const QString&, const QString&, int);
+    int serviceIndex(const QString&) const;
+    void sendSignal(const QString&, const QString&, const QString&, const QList<QVariant>&);
+    void connectService(int);
+    QDBusMessage managerCall(const QDBusMessage&);
+    QDBusMessage serviceCall(const QDBusMessage&);
+    QDBusMessage technologyCall(const QDBusMessage&);
+    QDBusMessage vpnCall(const QDBusMessage&);
+};
+
+# endif
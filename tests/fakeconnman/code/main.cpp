@@ -0,0 +1,115 @@
+/**************************** main.cpp ********************************
+
+fakeconnman, a stand-in for connmand used to drive cmst in the
+performance tests.  Prints "ready" once it owns the connman names, a
+"mark <label>" line as each section of the storm script starts, and
+"done" when the script has finished.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QCoreApplication>
+# include <QCommandLineOption>
+# include <QCommandLineParser>
+# include <QStringList>
+# include <QTimer>
+# include <QtDBus/QDBusConnection>
+# include <QtDBus/QDBusError>
+
+# include <cstdio>
+# include <cstdlib>
+
+# include "./fakeconnman.h"
+# include "./storm.h"
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("fakeconnman");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(QCoreApplication::translate("main.cpp", "A fake connman for the cmst performance tests.") );
+  parser.addHelpOption();
+
+  QCommandLineOption busAddress (QStringList() << "bus-address",
+    QCoreApplication::translate("main.cpp", "Connect to the D-Bus bus at this address instead of the session bus."),
+    QCoreApplication::translate("main.cpp", "address"),
+    QString("") );
+  parser.addOption(busAddress);
+
+  QCommandLineOption scriptFile (QStringList() << "script",
+    QCoreApplication::translate("main.cpp", "Storm script to run. Without one fakeconnman answers calls until it is killed."),
+    QCoreApplication::translate("main.cpp", "file"),
+    QString("") );
+  parser.addOption(scriptFile);
+
+  QCommandLineOption logFile (QStringList() << "log",
+    QCoreApplication::translate("main.cpp", "Write the time each signal was sent to this file."),
+    QCoreApplication::translate("main.cpp", "file"),
+    QString("") );
+  parser.addOption(logFile);
+
+  parser.process(app);
+
+  // same storm every run
+  std::srand(1);
+
+  FakeConnman::registerMetaTypes();
+  QDBusConnection bus = parser.value(busAddress).isEmpty()
+    ? QDBusConnection::sessionBus()
+    : QDBusConnection::connectToBus(parser.value(busAddress), "fakeconnman");
+  if (! bus.isConnected() ) {
+    std::fprintf(stderr, "fakeconnman: can't connect to the bus: %s\n", qPrintable(bus.lastError().message()) );
+    return 1;
+  } // if
+
+  FakeConnman fake(bus);
+  Storm storm(&fake);
+  if (parser.isSet(scriptFile) && ! storm.load(parser.value(scriptFile)) ) {
+    std::fprintf(stderr, "fakeconnman: %s\n", qPrintable(storm.errorString()) );
+    return 1;
+  } // if
+  if (parser.isSet(logFile) && ! storm.openLog(parser.value(logFile)) ) {
+    std::fprintf(stderr, "fakeconnman: %s\n", qPrintable(storm.errorString()) );
+    return 1;
+  } // if
+  if (! fake.registerOnBus() ) {
+    std::fprintf(stderr, "fakeconnman: can't take the connman names, is connman running on this bus?\n");
+    return 1;
+  } // if
+
+  std::printf("ready\n");
+  std::fflush(stdout);
+
+  if (parser.isSet(scriptFile) ) {
+    QObject::connect(&storm, SIGNAL(finished()), &app, SLOT(quit()));
+    QTimer::singleShot(0, &storm, SLOT(start()));
+  } // if
+
+  int rtn = app.exec();
+
+  std::printf("done\n");
+  std::fflush(stdout);
+
+  return rtn;
+}
@@ -0,0 +1,232 @@
+/**************************** storm.cpp *******************************
+
+Runs a storm script against a FakeConnman.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QMap>
+# include <QTimer>
+
+# include <chrono>
+# include <cstdlib>
+# include <cstdio>
+
+# include "./storm.h"
+
+// states a service goes through in state-cycle
+# define STATE_COUNT 6
+static const char* cycle_states[STATE_COUNT] = {"association", "configuration", "ready", "online", "disconnect", "idle"};
+
+// Constructor
+Storm::Storm(FakeConnman* fc, QObject* parent) : QObject(parent)
+{
+  fake = fc;
+  pc = 0;
+  repeat_left = -1;
+  state_step = 0;
+  section.clear();
+  error.clear();
+
+  connect(fake, SIGNAL(signalSent(QString)), this, SLOT(logSignal(QString)));
+}
+
+////////////////////////////// Public Functions ////////////////////////////
+//
+// Function to read and check a script.  Return false and set the error
+// string if the file can't be read or has a line we don't understand.
+bool Storm::load(const QString& file)
+{
+  QFile f(file);
+  if (! f.open(QIODevice::ReadOnly | QIODevice::Text) ) {
+    error = QString("%1: %2").arg(file).arg(f.errorString() );
+    return false;
+  } // if
+
+  // number of arguments each command takes
+  QMap<QString, int> argc;
+  argc.insert("services", 1);
+  argc.insert("wait", 1);
+  argc.insert("wait-agent", 0);
+  argc.insert("mark", 1);
+  argc.insert("scan-burst", 2);
+  argc.insert("strength-flap", 2);
+  argc.insert("state-cycle", 2);
+  argc.insert("reorder", 2);
+  argc.insert("quit", 0);
+
+  script.clear();
+  int line = 0;
+  while (! f.atEnd() ) {
+    ++line;
+    QString s = QString::fromUtf8(f.readLine() );
+    s = s.left(s.indexOf('#') ).simplified();
+    if (s.isEmpty() ) continue;
+
+    command cmd;
+    cmd.args = s.split(' ');
+    cmd.op = cmd.args.takeFirst();
+    cmd.line = line;
+    if (! argc.contains(cmd.op) || argc.value(cmd.op) != cmd.args.size() ) {
+      error = QString("%1:%2: bad command \"%3\"").arg(file).arg(line).arg(s);
+      return false;
+    } // if
+    for (int i = 0; i < cmd.args.size(); ++i) {
+      bool ok = cmd.op == "mark";
+      if (! ok) cmd.args.at(i).toInt(&ok);
+      if (! ok) {
+        error = QString("%1:%2: \"%3\" is not a number").arg(file).arg(line).arg(cmd.args.at(i) );
+        return false;
+      } // if
+    } // for
+    script.append(cmd);
+  } // while
+
+  return true;
+}
+
+//
+// Function to open the signal log.  Return false if it can't be written.
+bool Storm::openLog(const QString& file)
+{
+  log_file.setFileName(file);
+  if (! log_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text) ) {
+    error = QString("%1: %2").arg(file).arg(log_file.errorString() );
+    return false;
+  } // if
+  log.setDevice(&log_file);
+
+  return true;
+}
+
+////////////////////////////// Public Slots ////////////////////////////
+//
+// Slot to run the script from the top
+void Storm::start()
+{
+  pc = 0;
+  repeat_left = -1;
+  this->step();
+
+  return;
+}
+
+////////////////////////////// Private Functions ////////////////////////////
+//
+// Function to do one step of a repeated command
+void Storm::action(const QString& op)
+{
+  const int n = fake->serviceCount();
+
+  if (op == "scan-burst") fake->scan(qMax(1, n / 20) );
+
+  else if (op == "strength-flap") {
+    if (n < 2) return;
+    const int i = 1 + std::rand() % (n - 1);
+    const int s = fake->serviceProperty(i, "Strength").toInt();
+    fake->setServiceProperty(i, "Strength", QVariant::fromValue(uchar(s > 55 ? s - 25 : s + 25)) );
+  } // else if strength-flap
+
+  else if (op == "state-cycle") {
+    if (n < 2) return;
+    fake->setServiceProperty(1, "State", cycle_states[state_step]);
+    state_step = (state_step + 1) % STATE_COUNT;
+  } // else if state-cycle
+
+  else if (op == "reorder") fake->reorder();
+
+  return;
+}
+
+////////////////////////////// Private Slots ////////////////////////////
+//
+// Slot to run commands until one has to wait
+void Storm::step()
+{
+  while (pc < script.size() ) {
+    const command& cmd = script.at(pc);
+
+    if (cmd.op == "services") {
+      fake->setServices(cmd.args.at(0).toInt() );
+    } // if services
+
+    else if (cmd.op == "wait") {
+      ++pc;
+      QTimer::singleShot(cmd.args.at(0).toInt(), this, SLOT(step()));
+      return;
+    } // else if wait
+
+    else if (cmd.op == "wait-agent") {
+      if (! fake->hasAgent() ) {
+        connect(fake, SIGNAL(agentReady()), this, SLOT(step()), Qt::UniqueConnection);
+        return;
+      } // if
+      disconnect(fake, SIGNAL(agentReady()), this, SLOT(step()));
+    } // else if wait-agent
+
+    else if (cmd.op == "mark") {
+      section = cmd.args.at(0);
+      std::printf("mark %s\n", qPrintable(section) );
+      std::fflush(stdout);
+    } // else if mark
+
+    else if (cmd.op == "quit") {
+      break;
+    } // else if quit
+
+    else {
+      if (repeat_left < 0) repeat_left = cmd.args.at(0).toInt();
+      if (repeat_left > 0) {
+        this->action(cmd.op);
+        --repeat_left;
+      } // if
+      if (repeat_left == 0) {
+        repeat_left = -1;
+        ++pc;
+      } // if
+      QTimer::singleShot(cmd.args.at(1).toInt(), this, SLOT(step()));
+      return;
+    } // else repeated commands
+
+    ++pc;
+  } // while
+
+  pc = script.size();
+  log.flush();
+  emit finished();
+
+  return;
+}
+
+//
+// Slot to log a signal FakeConnman sent.  Signals sent before the first
+// mark are setup and not logged.
+void Storm::logSignal(const QString& name)
+{
+  if (section.isEmpty() || log.device() == 0) return;
+
+  const qint64 us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch() ).count();
+  log << us << '\t' << section << '\t' << name << '\n';
+
+  return;
+}
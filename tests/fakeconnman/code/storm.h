@@ -0,0 +1,96 @@
+/**************************** storm.h *********************************
+
+Runs a storm script against a FakeConnman.  A script is one command per
+line, # starts a comment:
+
+  services <n>                      replace the wifi services with n new ones
+  wait <ms>                         pause
+  wait-agent                        wait until cmst has registered its agent
+  mark <label>                      start a section of the report
+  scan-burst <count> <ms>           count scans, ms apart
+  strength-flap <count> <ms>        count Strength changes, ms apart
+  state-cycle <count> <ms>          count State changes, ms apart
+  reorder <count> <ms>              count ServicesChanged reorders, ms apart
+  quit                              end the script
+
+Each signal sent after the first mark is logged as a line holding the
+steady clock in microseconds, the section label and the signal name.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef FAKE_CONNMAN_STORM
+# define FAKE_CONNMAN_STORM
+
+# include <QObject>
+# include <QString>
+# include <QStringList>
+# include <QList>
+# include <QFile>
+# include <QTextStream>
+
+# include "./fakeconnman.h"
+
+class Storm : public QObject
+{
+  Q_OBJECT
+
+  public:
+    Storm(FakeConnman*, QObject* parent = 0);
+    bool load(const QString&);
+    bool openLog(const QString&);
+    inline QString errorString() const {return error;}
+
+  public slots:
+    void start();
+
+  signals:
+    void finished();
+
+  private:
+  // members
+    struct command
+    {
+      QString op;
+      QStringList args;
+      int line;
+    };
+    FakeConnman* fake;
+    QList<command> script;
+    int pc;
+    int repeat_left;
+    int state_step;
+    QString section;
+    QString error;
+    QFile log_file;
+    QTextStream log;
+
+  // functions
+    void action(const QString&);
+
+  private slots:
+    void step();
+    void logSignal(const QString&);
+};
+
+# endif
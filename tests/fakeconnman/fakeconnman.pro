@@ -0,0 +1,29 @@
+#  We need the qt libraries, we want compiler warnings on, and this is a release version of the program
+CONFIG += qt
+CONFIG += warn_on
+CONFIG += release
+CONFIG += nostrip
+CONFIG += c++11
+CONFIG += console
+
+#  A fake connman for the performance tests, no gui
+QT -= gui
+QT += dbus
+QT += core
+
+TEMPLATE = app
+TARGET = fakeconnman
+
+#	header files
+HEADERS		+= ./code/fakeconnman.h
+HEADERS		+= ./code/storm.h
+
+#	sources
+SOURCES += ./code/main.cpp
+SOURCES += ./code/fakeconnman.cpp
+SOURCES += ./code/storm.cpp
+
+##  Place all object files in their own directory and moc files in their own directory
+##  This is not necessary but keeps things cleaner.
+OBJECTS_DIR = ./object_files
+MOC_DIR = ./moc_files
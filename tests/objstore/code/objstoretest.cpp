@@ -0,0 +1,175 @@
+/**************************** objstoretest.cpp ************************
+
+Unit tests of the object store.  The edit scripts made by
+ObjectStore::editScript() are applied to the list they start from and
+must leave exactly the list they were made for.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QtTest/QtTest>
+# include <QStringList>
+
+# include "./code/objstore/objstore.h"
+
+class ObjStoreTest : public QObject
+{
+  Q_OBJECT
+
+  private:
+  // functions
+    static bool apply(QStringList&, const QList<storeEdit>&);
+    static int moves(const QList<storeEdit>&);
+
+  private slots:
+    void editScript_data();
+    void editScript();
+    void editScriptRandom();
+};
+
+////////////////////////////// Private Functions ////////////////////////////
+//
+// Function to apply an edit script to list.  Return false if a step does
+// not fit the list it is applied to.
+bool ObjStoreTest::apply(QStringList& list, const QList<storeEdit>& script)
+{
+  for (int i = 0; i < script.size(); ++i) {
+    const storeEdit& edit = script.at(i);
+    switch (edit.op) {
+      case storeEdit::Remove:
+        if (edit.from < 0 || edit.from >= list.size() || list.at(edit.from) != edit.key) return false;
+        list.removeAt(edit.from);
+        break;
+      case storeEdit::Insert:
+        if (edit.to < 0 || edit.to > list.size() ) return false;
+        list.insert(edit.to, edit.key);
+        break;
+      case storeEdit::Move:
+        if (edit.from < 0 || edit.from >= list.size() || list.at(edit.from) != edit.key) return false;
+        if (edit.to < 0 || edit.to >= list.size() || edit.to == edit.from) return false;
+        list.move(edit.from, edit.to);
+        break;
+      default:
+        return false;
+    } // switch
+  } // for
+
+  return true;
+}
+
+//
+// Function to return the number of Move steps in a script
+int ObjStoreTest::moves(const QList<storeEdit>& script)
+{
+  int rtn = 0;
+  for (int i = 0; i < script.size(); ++i) {
+    if (script.at(i).op == storeEdit::Move) ++rtn;
+  } // for
+
+  return rtn;
+}
+
+////////////////////////////// Tests ////////////////////////////
+//
+// Lists to edit, and the most moves a script may use to do it
+void ObjStoreTest::editScript_data()
+{
+  QTest::addColumn<QStringList>("before");
+  QTest::addColumn<QStringList>("after");
+  QTest::addColumn<int>("maxmoves");
+
+  const QStringList abcde = QStringList() << "a" << "b" << "c" << "d" << "e";
+
+  QTest::newRow("empty") << QStringList() << QStringList() << 0;
+  QTest::newRow("unchanged") << abcde << abcde << 0;
+  QTest::newRow("all new") << QStringList() << abcde << 0;
+  QTest::newRow("all gone") << abcde << QStringList() << 0;
+  QTest::newRow("insert front") << abcde << (QStringList() << "x" << abcde) << 0;
+  QTest::newRow("insert middle") << abcde << (QStringList() << "a" << "b" << "x" << "c" << "d" << "e") << 0;
+  QTest::newRow("insert back") << abcde << (QStringList() << abcde << "x") << 0;
+  QTest::newRow("remove middle") << abcde << (QStringList() << "a" << "b" << "d" << "e") << 0;
+  QTest::newRow("replace all") << abcde << (QStringList() << "v" << "w" << "x" << "y" << "z") << 0;
+  QTest::newRow("swap") << (QStringList() << "a" << "b") << (QStringList() << "b" << "a") << 1;
+  QTest::newRow("last to front") << abcde << (QStringList() << "e" << "a" << "b" << "c" << "d") << 1;
+  QTest::newRow("first to back") << abcde << (QStringList() << "b" << "c" << "d" << "e" << "a") << 1;
+  QTest::newRow("one up") << abcde << (QStringList() << "a" << "c" << "b" << "d" << "e") << 1;
+  QTest::newRow("reverse") << abcde << (QStringList() << "e" << "d" << "c" << "b" << "a") << 4;
+  QTest::newRow("mixed") << abcde << (QStringList() << "e" << "x" << "c" << "a" << "y") << 2;
+  QTest::newRow("duplicates") << (QStringList() << "a" << "b" << "a" << "c" << "b") << (QStringList() << "c" << "a" << "b") << 1;
+  QTest::newRow("duplicates only") << (QStringList() << "a" << "a" << "a") << (QStringList() << "a") << 0;
+  QTest::newRow("duplicates gone") << (QStringList() << "a" << "b" << "a") << (QStringList() << "b") << 0;
+
+  return;
+}
+
+//
+// The script turns before into after, with no more moves than needed
+void ObjStoreTest::editScript()
+{
+  QFETCH(QStringList, before);
+  QFETCH(QStringList, after);
+  QFETCH(int, maxmoves);
+
+  const QList<storeEdit> script = ObjectStore::editScript(before, after);
+  QStringList list = before;
+  QVERIFY(apply(list, script) );
+  QCOMPARE(list, after);
+  QVERIFY(moves(script) <= maxmoves);
+
+  return;
+}
+
+//
+// Random lists drawn from a small set of keys so there are plenty of
+// keys that stay, move, go and come, and of duplicates in before
+void ObjStoreTest::editScriptRandom()
+{
+  qsrand(1);
+  for (int round = 0; round < 2000; ++round) {
+    QStringList keys;
+    for (int i = 0; i < 16; ++i) {
+      keys << QString("/net/connman/service/s%1").arg(i);
+    } // for
+
+    QStringList before;
+    const int nbefore = qrand() % 14;
+    for (int i = 0; i < nbefore; ++i) {
+      before << keys.at(qrand() % keys.size() );
+    } // for
+
+    QStringList after;
+    const int nafter = qrand() % 14;
+    for (int i = 0; i < nafter; ++i) {
+      after << keys.takeAt(qrand() % keys.size() );
+    } // for
+
+    QStringList list = before;
+    QVERIFY2(apply(list, ObjectStore::editScript(before, after)), qPrintable(before.join(' ')) );
+    QCOMPARE(list, after);
+  } // for
+
+  return;
+}
+
+QTEST_APPLESS_MAIN(ObjStoreTest)
+# include "objstoretest.moc"
@@ -0,0 +1,31 @@
+#  We need the qt libraries, we want compiler warnings on, and this is a release version of the program
+CONFIG += qt
+CONFIG += warn_on
+CONFIG += release
+CONFIG += nostrip
+CONFIG += c++11
+CONFIG += console
+CONFIG += testcase
+
+#  QtTest unit tests of the object store, make check runs them
+QT -= gui
+QT += testlib
+QT += dbus
+QT += core
+
+TEMPLATE = app
+TARGET = cmstobjstoretest
+
+#  The core library
+INCLUDEPATH += ../../apps/cmstcore
+INCLUDEPATH += $$OUT_PWD/../../apps/cmstcore
+LIBS += -L$$OUT_PWD/../../apps/cmstcore -lcmstcore
+PRE_TARGETDEPS += $$OUT_PWD/../../apps/cmstcore/libcmstcore.a
+
+#	sources
+SOURCES += ./code/objstoretest.cpp
+
+##  Place all object files in their own directory and moc files in their own directory
+##  This is not necessary but keeps things cleaner.
+OBJECTS_DIR = ./object_files
+MOC_DIR = ./moc_files
@@ -0,0 +1,110 @@
+/**************************** main.cpp ********************************
+
+cmstperf, runs cmst under storm scripts on a private dbus-daemon and
+writes a report of its CPU time, peak RSS and signal to repaint latency.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QCoreApplication>
+# include <QCommandLineOption>
+# include <QCommandLineParser>
+# include <QStringList>
+# include <QDir>
+# include <QFile>
+# include <QTextStream>
+
+# include <cstdio>
+
+# include "./perfrun.h"
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("cmstperf");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(QCoreApplication::translate("main.cpp", "Run cmst against a fake connman and report its CPU time, peak RSS and signal to repaint latency.") );
+  parser.addHelpOption();
+  parser.addPositionalArgument("scripts", QCoreApplication::translate("main.cpp", "Storm scripts to run, all of the ones in the storms directory if none are given."), "[scripts...]");
+
+  QCommandLineOption cmstBinary (QStringList() << "cmst",
+    QCoreApplication::translate("main.cpp", "The cmst binary to test."),
+    QCoreApplication::translate("main.cpp", "file"),
+    QCoreApplication::applicationDirPath() + "/../../apps/cmstapp/cmst");
+  parser.addOption(cmstBinary);
+
+  QCommandLineOption fakeBinary (QStringList() << "fakeconnman",
+    QCoreApplication::translate("main.cpp", "The fakeconnman binary."),
+    QCoreApplication::translate("main.cpp", "file"),
+    QCoreApplication::applicationDirPath() + "/../fakeconnman/fakeconnman");
+  parser.addOption(fakeBinary);
+
+  QCommandLineOption reportFile (QStringList() << "report",
+    QCoreApplication::translate("main.cpp", "Write the report to this file as well as to stdout."),
+    QCoreApplication::translate("main.cpp", "file"),
+    QString("perf-report.txt") );
+  parser.addOption(reportFile);
+
+  parser.process(app);
+
+  QStringList scripts = parser.positionalArguments();
+  if (scripts.isEmpty() ) {
+    QDir dir(STORM_DIR);
+    const QStringList files = dir.entryList(QStringList() << "*.storm", QDir::Files, QDir::Name);
+    for (int i = 0; i < files.size(); ++i) {
+      scripts.append(dir.filePath(files.at(i)) );
+    } // for
+  } // if
+  if (scripts.isEmpty() ) {
+    std::fprintf(stderr, "cmstperf: no storm scripts to run\n");
+    return 1;
+  } // if
+
+  PerfRun perf(parser.value(cmstBinary), parser.value(fakeBinary) );
+  if (! perf.startBus() ) {
+    std::fprintf(stderr, "cmstperf: %s\n", qPrintable(perf.errorString()) );
+    return 1;
+  } // if
+
+  QList<perfResult> results;
+  bool b_failed = false;
+  for (int i = 0; i < scripts.size(); ++i) {
+    std::fprintf(stderr, "cmstperf: running %s\n", qPrintable(scripts.at(i)) );
+    results.append(perf.run(scripts.at(i)) );
+    if (! results.last().error.isEmpty() ) b_failed = true;
+  } // for
+
+  QTextStream out(stdout);
+  PerfRun::report(results, out);
+
+  QFile f(parser.value(reportFile) );
+  if (! f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text) ) {
+    std::fprintf(stderr, "cmstperf: %s: %s\n", qPrintable(f.fileName()), qPrintable(f.errorString()) );
+    return 1;
+  } // if
+  QTextStream fout(&f);
+  PerfRun::report(results, fout);
+
+  return b_failed ? 1 : 0;
+}
@@ -0,0 +1,422 @@
+/**************************** perfrun.cpp *****************************
+
+Runs cmst against fakeconnman on a private dbus-daemon and measures it.
+
+The latency of a signal is found from the cmst trace.  fakeconnman logs
+the steady clock when it sends each signal, and the trace records the
+steady clock its timestamps count from.  From the send time we follow
+the first signal handler (a span named dbs...) that started after it,
+then the first adoptSnapshot after that handler ended, then the first
+flushDisplayWidgets after that.
+The latency is the time from the send to the end of that flush.  Under
+a storm a handler may be busy with an earlier signal, so the chain is
+an approximation, but it is the one a user sees.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QCoreApplication>
+# include <QDir>
+# include <QFile>
+# include <QFileInfo>
+# include <QDateTime>
+# include <QProcessEnvironment>
+# include <QElapsedTimer>
+# include <QJsonDocument>
+# include <QJsonObject>
+# include <QJsonArray>
+
+# include <algorithm>
+# include <cmath>
+
+# include <signal.h>
+# include <unistd.h>
+
+# include "./perfrun.h"
+
+// how long to wait for a line from fakeconnman before giving up (ms)
+# define LINE_TIMEOUT 120000
+
+namespace
+{
+  struct span
+  {
+    qint64 ts;
+    qint64 end;
+  };
+
+  bool earlier(const span& a, const span& b)
+  {
+    return a.ts < b.ts;
+  }
+
+  // first span in a sorted list starting at or after ts, 0 if none
+  const span* firstAfter(const QVector<span>& list, qint64 ts)
+  {
+    span key = {ts, ts, false};
+    QVector<span>::const_iterator it = std::lower_bound(list.constBegin(), list.constEnd(), key, earlier);
+    return it == list.constEnd() ? 0 : &(*it);
+  }
+
+  // the q quantile of a sorted list, in milliseconds
+  double quantile(const QVector<qint64>& sorted, double q)
+  {
+    if (sorted.isEmpty() ) return 0.0;
+    int i = static_cast<int>(std::ceil(q * sorted.size()) ) - 1;
+    i = qBound(0, i, sorted.size() - 1);
+    return sorted.at(i) / 1000.0;
+  }
+} // namespace
+
+// Constructor
+PerfRun::PerfRun(const QString& cmst_path, const QString& fake_path)
+{
+  cmst = cmst_path;
+  fakeconnman = fake_path;
+  bus_address.clear();
+  error.clear();
+}
+
+// Destructor
+PerfRun::~PerfRun()
+{
+  this->stopProcess(bus);
+}
+
+////////////////////////////// Public Functions ////////////////////////////
+//
+// Function to start a private dbus-daemon.  Return false and set the
+// error string if it does not start.
+bool PerfRun::startBus()
+{
+  if (! tmp.isValid() ) {
+    error = QString("can't create a temporary directory");
+    return false;
+  } // if
+
+  const QString config = tmp.path() + "/bus.conf";
+  QFile f(config);
+  if (! f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text) ) {
+    error = QString("%1: %2").arg(config).arg(f.errorString() );
+    return false;
+  } // if
+  QTextStream out(&f);
+  out << "<!DOCTYPE busconfig PUBLIC \"-//freedesktop//DTD D-Bus Bus Configuration 1.0//EN\"\n"
+      << " \"http://www.freedesktop.org/standards/dbus/1.0/busconfig.dtd\">\n"
+      << "<busconfig>\n"
+      << "  <type>session</type>\n"
+      << "  <listen>unix:tmpdir=" << tmp.path() << "</listen>\n"
+      << "  <auth>EXTERNAL</auth>\n"
+      << "  <policy context=\"default\">\n"
+      << "    <allow send_destination=\"*\" eavesdrop=\"true\"/>\n"
+      << "    <allow eavesdrop=\"true\"/>\n"
+      << "    <allow own=\"*\"/>\n"
+      << "  </policy>\n"
+      << "</busconfig>\n";
+  f.close();
+
+  bus.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+  bus.start("dbus-daemon", QStringList() << QString("--config-file=%1").arg(config) << "--nofork" << "--print-address");
+  if (! bus.waitForStarted() ) {
+    error = QString("can't start dbus-daemon: %1").arg(bus.errorString() );
+    return false;
+  } // if
+
+  if (! this->readLine(bus, bus_address, 0) || bus_address.isEmpty() ) {
+    error = QString("dbus-daemon did not print its address");
+    return false;
+  } // if
+
+  return true;
+}
+
+//
+// Function to run one storm script
+perfResult PerfRun::run(const QString& script)
+{
+  perfResult res;
+  res.script = script;
+  res.error.clear();
+  res.startup_cpu = 0.0;
+  res.peak_rss = 0;
+
+  QFile::remove(tmp.path() + "/signals.log");
+  QFile::remove(tmp.path() + "/trace.json");
+
+  // fakeconnman first, cmst expects connman to be there
+  QProcess fake;
+  fake.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+  fake.start(fakeconnman, QStringList() << "--bus-address" << bus_address << "--script" << script
+    << "--log" << tmp.path() + "/signals.log");
+  QString line;
+  if (! this->readLine(fake, line, 0) || line != "ready") {
+    res.error = QString("fakeconnman did not start");
+    this->stopProcess(fake);
+    return res;
+  } // if
+
+  // cmst with its settings, cache and single instance socket in our
+  // directory, and no display
+  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+  env.insert("QT_QPA_PLATFORM", "offscreen");
+  env.insert("XDG_CONFIG_HOME", tmp.path() + "/config");
+  env.insert("XDG_CACHE_HOME", tmp.path() + "/cache");
+  env.insert("TMPDIR", tmp.path() );
+  env.insert("DBUS_SESSION_BUS_ADDRESS", bus_address);
+  QProcess app;
+  app.setProcessEnvironment(env);
+  app.setStandardOutputFile(QProcess::nullDevice() );
+  app.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+  app.start(cmst, QStringList() << "--bus-address" << bus_address << "--trace" << tmp.path() + "/trace.json" << "-B");
+  if (! app.waitForStarted() ) {
+    res.error = QString("can't start %1: %2").arg(cmst).arg(app.errorString() );
+    this->stopProcess(fake);
+    return res;
+  } // if
+  const qint64 pid = app.processId();
+
+  // CPU time is sampled at each mark and at the end
+  double cpu = 0.0;
+  bool b_done = false;
+  while (this->readLine(fake, line, &app) ) {
+    if (line.startsWith("mark ") ) {
+      const double now = cpuTime(pid);
+      if (res.sections.isEmpty() ) res.startup_cpu = now;
+      else res.sections.last().cpu = now - cpu;
+      cpu = now;
+      perfSection sec;
+      sec.name = line.mid(5);
+      sec.cpu = 0.0;
+      sec.signals_sent = 0;
+      sec.unmatched = 0;
+      res.sections.append(sec);
+    } // if mark
+    else if (line == "done") {
+      const double now = cpuTime(pid);
+      if (res.sections.isEmpty() ) res.startup_cpu = now;
+      else res.sections.last().cpu = now - cpu;
+      res.peak_rss = peakRss(pid);
+      b_done = true;
+      break;
+    } // else if done
+  } // while
+
+  if (! b_done) {
+    res.error = app.state() == QProcess::NotRunning
+      ? QString("cmst exited during the run, exit code %1").arg(app.exitCode() )
+      : QString("fakeconnman stopped before the end of the script");
+  } // if
+
+  // SIGINT has cmst quit cleanly and write its trace
+  if (app.state() != QProcess::NotRunning) {
+    ::kill(static_cast<pid_t>(pid), SIGINT);
+    if (! app.waitForFinished(15000) ) {
+      if (res.error.isEmpty() ) res.error = QString("cmst did not quit on SIGINT");
+      this->stopProcess(app);
+    } // if
+  } // if
+  this->stopProcess(fake);
+
+  if (res.error.isEmpty() ) this->analyse(res);
+
+  return res;
+}
+
+//
+// Function to write the report
+void PerfRun::report(const QList<perfResult>& results, QTextStream& out)
+{
+  out << "cmst performance report, " << QDateTime::currentDateTime().toString(Qt::ISODate) << "\n";
+  out << "latency is from fakeconnman sending a signal to the end of the repaint, in ms\n";
+
+  for (int i = 0; i < results.size(); ++i) {
+    const perfResult& res = results.at(i);
+    out << "\nscript: " << QFileInfo(res.script).fileName() << "\n";
+    if (! res.error.isEmpty() ) {
+      out << "  FAILED: " << res.error << "\n";
+      continue;
+    } // if
+
+    out << QString("  startup cpu %1 s, peak rss %2 kB\n").arg(res.startup_cpu, 0, 'f', 3).arg(res.peak_rss);
+    out << QString("  %1 %2 %3 %4 %5 %6 %7 %8\n")
+      .arg("section", -16).arg("signals", 8).arg("cpu s", 8).arg("p50", 8).arg("p90", 8).arg("p99", 8).arg("max", 8).arg("lost", 6);
+
+    for (int j = 0; j < res.sections.size(); ++j) {
+      const perfSection& sec = res.sections.at(j);
+      out << QString("  %1 %2 %3 %4 %5 %6 %7 %8\n")
+        .arg(sec.name, -16)
+        .arg(sec.signals_sent, 8)
+        .arg(sec.cpu, 8, 'f', 3)
+        .arg(quantile(sec.latency, 0.50), 8, 'f', 2)
+        .arg(quantile(sec.latency, 0.90), 8, 'f', 2)
+        .arg(quantile(sec.latency, 0.99), 8, 'f', 2)
+        .arg(quantile(sec.latency, 1.00), 8, 'f', 2)
+        .arg(sec.unmatched, 6);
+    } // for sections
+  } // for results
+
+  out.flush();
+
+  return;
+}
+
+////////////////////////////// Private Functions ////////////////////////////
+//
+// Function to read a line from a process.  Return false on a timeout,
+// when the process ends, or when the watched process (if any) ends.
+bool PerfRun::readLine(QProcess& proc, QString& line, const QProcess* watch)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  while (! proc.canReadLine() ) {
+    if (proc.state() == QProcess::NotRunning) return false;
+    if (watch != 0 && watch->state() == QProcess::NotRunning) return false;
+    if (timer.elapsed() > LINE_TIMEOUT) return false;
+    proc.waitForReadyRead(200);
+  } // while
+
+  line = QString::fromUtf8(proc.readLine() ).trimmed();
+
+  return true;
+}
+
+//
+// Function to stop a process, asking first
+void PerfRun::stopProcess(QProcess& proc)
+{
+  if (proc.state() == QProcess::NotRunning) return;
+
+  proc.terminate();
+  if (! proc.waitForFinished(5000) ) {
+    proc.kill();
+    proc.waitForFinished(5000);
+  } // if
+
+  return;
+}
+
+//
+// Function to match the signal log against the trace and fill in the
+// latency of each section
+void PerfRun::analyse(perfResult& res)
+{
+  QFile tf(tmp.path() + "/trace.json");
+  if (! tf.open(QIODevice::ReadOnly) ) {
+    res.error = QString("cmst did not write a trace");
+    return;
+  } // if
+  const QJsonObject trace = QJsonDocument::fromJson(tf.readAll() ).object();
+  const qint64 epoch = static_cast<qint64>(trace.value("otherData").toObject().value("steady_clock_epoch_us").toDouble() );
+  if (epoch == 0) {
+    res.error = QString("the trace has no steady_clock_epoch_us, is cmst built with tracing?");
+    return;
+  } // if
+
+  // the spans in a latency chain
+  QVector<span> handlers;
+  QVector<span> adopts;
+  QVector<span> flushes;
+  qint64 first_ts = -1;
+  const QJsonArray events = trace.value("traceEvents").toArray();
+  for (int i = 0; i < events.size(); ++i) {
+    const QJsonObject ev = events.at(i).toObject();
+    if (ev.value("ph").toString() != "X") continue;
+    const QString name = ev.value("name").toString();
+    span s;
+    s.ts = static_cast<qint64>(ev.value("ts").toDouble() );
+    s.end = s.ts + static_cast<qint64>(ev.value("dur").toDouble() );
+    if (first_ts < 0 || s.ts < first_ts) first_ts = s.ts;
+    if (name.startsWith("dbs") ) handlers.append(s);
+    else if (name == "adoptSnapshot") adopts.append(s);
+    else if (name == "flushDisplayWidgets") flushes.append(s);
+  } // for
+  std::sort(handlers.begin(), handlers.end(), earlier);
+  std::sort(adopts.begin(), adopts.end(), earlier);
+  std::sort(flushes.begin(), flushes.end(), earlier);
+
+  // follow each logged signal
+  QFile lf(tmp.path() + "/signals.log");
+  if (! lf.open(QIODevice::ReadOnly | QIODevice::Text) ) {
+    res.error = QString("fakeconnman did not write its signal log");
+    return;
+  } // if
+  while (! lf.atEnd() ) {
+    const QStringList fields = QString::fromUtf8(lf.readLine() ).trimmed().split('\t');
+    if (fields.size() != 3) continue;
+    perfSection* sec = 0;
+    for (int i = 0; i < res.sections.size(); ++i) {
+      if (res.sections.at(i).name == fields.at(1) ) sec = &res.sections[i];
+    } // for
+    if (sec == 0) continue;
+    ++sec->signals_sent;
+
+    // the trace ring buffer may have lost the oldest spans
+    const qint64 sent = fields.at(0).toLongLong() - epoch;
+    if (sent < first_ts) {
+      ++sec->unmatched;
+      continue;
+    } // if
+    const span* handler = firstAfter(handlers, sent);
+    const span* adopt = handler == 0 ? 0 : firstAfter(adopts, handler->end);
+    const span* flush = adopt == 0 ? 0 : firstAfter(flushes, adopt->ts);
+    if (flush == 0) ++sec->unmatched;
+    else sec->latency.append(flush->end - sent);
+  } // while
+
+  for (int i = 0; i < res.sections.size(); ++i) {
+    std::sort(res.sections[i].latency.begin(), res.sections[i].latency.end() );
+  } // for
+
+  return;
+}
+
+//
+// Function to return the CPU time (user and system) of a process in seconds
+double PerfRun::cpuTime(qint64 pid)
+{
+  QFile f(QString("/proc/%1/stat").arg(pid) );
+  if (! f.open(QIODevice::ReadOnly) ) return 0.0;
+
+  // the command name may hold spaces, the fields we want follow it
+  const QByteArray stat = f.readAll();
+  const QList<QByteArray> fields = stat.mid(stat.lastIndexOf(')') + 2).split(' ');
+  if (fields.size() < 13) return 0.0;
+
+  return (fields.at(11).toDouble() + fields.at(12).toDouble() ) / ::sysconf(_SC_CLK_TCK);
+}
+
+//
+// Function to return the peak resident set size of a process in kB
+qint64 PerfRun::peakRss(qint64 pid)
+{
+  QFile f(QString("/proc/%1/status").arg(pid) );
+  if (! f.open(QIODevice::ReadOnly | QIODevice::Text) ) return 0;
+
+  while (! f.atEnd() ) {
+    const QString line = QString::fromUtf8(f.readLine() );
+    if (line.startsWith("VmHWM:") ) return line.mid(6).simplified().section(' ', 0, 0).toLongLong();
+  } // while
+
+  return 0;
+}
@@ -0,0 +1,90 @@
+/**************************** perfrun.h *******************************
+
+Runs cmst against fakeconnman on a private dbus-daemon, one storm script
+at a time, and measures cmst's CPU time, peak RSS and how long each
+signal takes to reach the screen.
+
+Copyright (C) 2013-2017
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef CMST_PERFRUN
+# define CMST_PERFRUN
+
+# include <QString>
+# include <QStringList>
+# include <QList>
+# include <QVector>
+# include <QProcess>
+# include <QTemporaryDir>
+# include <QTextStream>
+
+//
+//  One section of a storm script, from its mark to the next one
+struct perfSection
+{
+  QString name;
+  double cpu;                 // seconds of cmst CPU time
+  QVector<qint64> latency;    // microseconds from signal to repaint
+  int signals_sent;
+  int unmatched;              // signals with no repaint after them
+};
+
+//
+//  The result of running one storm script
+struct perfResult
+{
+  QString script;
+  QString error;
+  double startup_cpu;
+  qint64 peak_rss;            // kB
+  QList<perfSection> sections;
+};
+
+class PerfRun
+{
+  public:
+    PerfRun(const QString&, const QString&);
+    ~PerfRun();
+    bool startBus();
+    inline QString errorString() const {return error;}
+    perfResult run(const QString&);
+    static void report(const QList<perfResult>&, QTextStream&);
+
+  private:
+  // members
+    QString cmst;
+    QString fakeconnman;
+    QTemporaryDir tmp;
+    QProcess bus;
+    QString bus_address;
+    QString error;
+
+  // functions
+    bool readLine(QProcess&, QString&, const QProcess*);
+    void stopProcess(QProcess&);
+    void analyse(perfResult&);
+    static double cpuTime(qint64);
+    static qint64 peakRss(qint64);
+};
+
+# endif
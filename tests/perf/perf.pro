@@ -0,0 +1,34 @@
+#  We need the qt libraries, we want compiler warnings on, and this is a release version of the program
+CONFIG += qt
+CONFIG += warn_on
+CONFIG += release
+CONFIG += nostrip
+CONFIG += c++11
+CONFIG += console
+
+#  The performance test driver, no gui and no dbus of its own
+QT -= gui
+QT += core
+
+TEMPLATE = app
+TARGET = cmstperf
+
+#  Where the storm scripts are found when none are named
+DEFINES += STORM_DIR=\\\"$$PWD/storms\\\"
+
+#	header files
+HEADERS		+= ./code/perfrun.h
+
+#	sources
+SOURCES += ./code/main.cpp
+SOURCES += ./code/perfrun.cpp
+
+#  make perf runs every storm script and writes perf-report.txt
+perf.commands = ./cmstperf --report perf-report.txt
+perf.depends = $(TARGET)
+QMAKE_EXTRA_TARGETS += perf
+
+##  Place all object files in their own directory and moc files in their own directory
+##  This is not necessary but keeps things cleaner.
+OBJECTS_DIR = ./object_files
+MOC_DIR = ./moc_files
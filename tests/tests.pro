@@ -0,0 +1,5 @@
+#  Performance tests: a fake connman, the driver that runs cmst against it
+#  and the QtTest benchmarks, and the unit tests
+TEMPLATE = subdirs
+CONFIG += ordered
+SUBDIRS = ./fakeconnman ./perf ./bench ./objstore